@@ -59,6 +59,7 @@ from ctypes import c_char_p
 from ctypes import c_wchar_p
 from ctypes import c_size_t
 from ctypes import c_void_p
+from ctypes import create_string_buffer
 from ctypes import pointer
 from ctypes import POINTER
 from ctypes import string_at
@@ -83,6 +84,31 @@ MAX_WORD_CHARS = 255
 """Maximum number of analyses that can be produced for a word"""
 MAX_ANALYSIS_COUNT = 31
 
+"""Flags of the analysis attributes that can be requested from analyze"""
+ANALYSIS_ATTRIBUTES = {
+	"BASEFORM": 0x1,
+	"CLASS": 0x2,
+	"COMPARISON": 0x4,
+	"FOCUS": 0x8,
+	"FSTOUTPUT": 0x10,
+	"KYSYMYSLIITE": 0x20,
+	"MALAGA_VAPAA_JALKIOSA": 0x40,
+	"MOOD": 0x80,
+	"NEGATIVE": 0x100,
+	"NUMBER": 0x200,
+	"PARTICIPLE": 0x400,
+	"PERSON": 0x800,
+	"POSSESSIVE": 0x1000,
+	"POSSIBLE_GEOGRAPHICAL_NAME": 0x2000,
+	"REQUIRE_FOLLOWING_VERB": 0x4000,
+	"SIJAMUOTO": 0x8000,
+	"STRUCTURE": 0x10000,
+	"TENSE": 0x20000,
+	"WEIGHT": 0x40000,
+	"WORDBASES": 0x80000,
+	"WORDIDS": 0x100000
+}
+
 class Dictionary:
 	"""Represents a morphological dictionary."""
 	def __init__(self, language, script, variant, description):
@@ -158,6 +184,20 @@ class SuggestionStrategy:
 	"""Suggestion strategy for correcting errors in text produced by
 	optical character recognition software."""
 
+class TransducerResidency:
+	"""Flags for controlling how the transducer files of the dictionaries are
+	kept in memory. The flags may be combined with bitwise or."""
+	WILLNEED = 1
+	"""Start reading the transducers into memory in the background."""
+	PREFAULT = 2
+	"""Read every page of the transducers into memory before returning."""
+	RANDOM = 4
+	"""Do not read ahead when a page is missing."""
+	HUGEPAGE = 8
+	"""Ask the operating system to use huge pages if it can."""
+	LOCK = 16
+	"""Lock the transducers in memory."""
+
 class GrammarError:
 	"""Grammar error from grammar checker."""
 	
@@ -176,6 +216,86 @@ class GrammarError:
 		s = s + "}]"
 		return s
 
+class IncrementalSpeller(object):
+	"""Word that is being typed in an editor, created with Voikko.incrementalSpeller.
+	Results are kept for each prefix of the word, so checking the word again after
+	characters have been removed from its end is free. The incremental speller must
+	be terminated before the Voikko instance that created it.
+	"""
+	def __init__(self, lib, speller):
+		self.__lib = lib
+		self.__speller = speller
+	
+	def __del__(self):
+		self.terminate()
+	
+	def terminate(self):
+		"""Releases the resources allocated by libvoikko for this incremental speller."""
+		if self.__speller:
+			self.__lib.voikkoDeleteIncrementalSpeller(self.__speller)
+			self.__speller = None
+	
+	def append(self, chars):
+		"""Append characters to the end of the word. Return false if the word
+		would become too long.
+		"""
+		return self.__lib.voikkoIncrementalAppendUcs4(self.__speller, chars) == 1
+	
+	def remove(self, count = 1):
+		"""Remove given number of characters from the end of the word."""
+		self.__lib.voikkoIncrementalRemove(self.__speller, count)
+	
+	def spell(self):
+		"""Check the spelling of the current word like Voikko.spell."""
+		result = self.__lib.voikkoIncrementalSpell(self.__speller)
+		if result == 0:
+			return False
+		elif result == 1:
+			return True
+		else:
+			raise VoikkoException("Internal error returned from libvoikko")
+	
+	def canContinue(self):
+		"""Return true if the current word is correct or some correct word begins with it."""
+		return self.__lib.voikkoIncrementalCanContinue(self.__speller) == 1
+	
+	def completions(self, maxCount = 5):
+		"""Return a list of at most maxCount words that begin with the current word."""
+		cCompletions = self.__lib.voikkoIncrementalCompletionsUcs4(self.__speller, maxCount)
+		pCompletions = []
+		if not bool(cCompletions):
+			return pCompletions
+		i = 0
+		while bool(cCompletions[i]):
+			pCompletions.append(cCompletions[i])
+			i = i + 1
+		self.__lib.voikko_free_suggest_ucs4(cCompletions)
+		return pCompletions
+
+class SharedDictionary(object):
+	"""Dictionary loaded with Voikko.initShared. Voikko instances created from it
+	with createSession share the transducers of the dictionary but have their own
+	settings and caches, so each session may be used from a different thread.
+	Sessions remain usable after the shared dictionary has been terminated.
+	"""
+	def __init__(self, lib, shared):
+		self.__lib = lib
+		self._handle = shared
+	
+	def __del__(self):
+		self.terminate()
+	
+	def terminate(self):
+		"""Releases the shared dictionary. Sessions that have already been created
+		are not affected."""
+		if self._handle:
+			self.__lib.voikkoTerminateShared(self._handle)
+			self._handle = None
+	
+	def createSession(self):
+		"""Create a new Voikko instance that uses this dictionary."""
+		return Voikko(self)
+
 class VoikkoException(Exception):
 	"""Thrown when someting exceptional happens within libvoikko."""
 	pass
@@ -202,6 +322,9 @@ def _anyStringToPath(anyString):
 	else:
 		return anyString
 
+class _SpellingError(Structure):
+	_fields_ = [("startpos", c_size_t), ("wordlen", c_size_t), ("result", c_int)]
+
 class Voikko(object):
 	def __getLib():
 		if os.name == 'nt':
@@ -230,7 +353,8 @@ class Voikko(object):
 	"""
 	def __init__(self, language, path = None):
 		"""Creates a new Voikko instance with the following optional parameters:
-		   language  BCP 47 language tag to be used.
+		   language  BCP 47 language tag to be used, or a SharedDictionary (see
+		             Voikko.initShared) when creating a session of it.
 		   path      Extra path that will be checked first when looking for linguistic
 		             resources."""
 		self.__lib = Voikko.__getLib()
@@ -238,12 +362,45 @@ class Voikko(object):
 		self.__lib.voikkoInit.argtypes = [POINTER(c_char_p), c_char_p, c_char_p]
 		self.__lib.voikkoInit.restype = c_void_p
 		
+		self.__lib.voikkoCreateSession.argtypes = [c_void_p, POINTER(c_char_p)]
+		self.__lib.voikkoCreateSession.restype = c_void_p
+		
 		self.__lib.voikkoTerminate.argtypes = [c_void_p]
 		self.__lib.voikkoTerminate.restype = None
 		
 		self.__lib.voikkoSpellUcs4.argtypes = [c_void_p, c_wchar_p]
 		self.__lib.voikkoSpellUcs4.restype = c_int
 		
+		self.__lib.voikkoSpellBatchUcs4.argtypes = [c_void_p, POINTER(c_wchar_p), c_size_t, POINTER(c_int)]
+		self.__lib.voikkoSpellBatchUcs4.restype = None
+		
+		self.__lib.voikkoCheckTextUcs4.argtypes = [c_void_p, c_wchar_p, c_size_t, POINTER(c_size_t)]
+		self.__lib.voikkoCheckTextUcs4.restype = POINTER(_SpellingError)
+		
+		self.__lib.voikkoFreeSpellingErrors.argtypes = [POINTER(_SpellingError)]
+		self.__lib.voikkoFreeSpellingErrors.restype = None
+		
+		self.__lib.voikkoCreateIncrementalSpeller.argtypes = [c_void_p]
+		self.__lib.voikkoCreateIncrementalSpeller.restype = c_void_p
+		
+		self.__lib.voikkoDeleteIncrementalSpeller.argtypes = [c_void_p]
+		self.__lib.voikkoDeleteIncrementalSpeller.restype = None
+		
+		self.__lib.voikkoIncrementalAppendUcs4.argtypes = [c_void_p, c_wchar_p]
+		self.__lib.voikkoIncrementalAppendUcs4.restype = c_int
+		
+		self.__lib.voikkoIncrementalRemove.argtypes = [c_void_p, c_size_t]
+		self.__lib.voikkoIncrementalRemove.restype = None
+		
+		self.__lib.voikkoIncrementalSpell.argtypes = [c_void_p]
+		self.__lib.voikkoIncrementalSpell.restype = c_int
+		
+		self.__lib.voikkoIncrementalCanContinue.argtypes = [c_void_p]
+		self.__lib.voikkoIncrementalCanContinue.restype = c_int
+		
+		self.__lib.voikkoIncrementalCompletionsUcs4.argtypes = [c_void_p, c_size_t]
+		self.__lib.voikkoIncrementalCompletionsUcs4.restype = POINTER(c_wchar_p)
+		
 		self.__lib.voikkoSuggestUcs4.argtypes = [c_void_p, c_wchar_p]
 		self.__lib.voikkoSuggestUcs4.restype = POINTER(c_wchar_p)
 		
@@ -281,6 +438,12 @@ class Voikko(object):
 		self.__lib.voikkoAnalyzeWordUcs4.argtypes = [c_void_p, c_wchar_p]
 		self.__lib.voikkoAnalyzeWordUcs4.restype = POINTER(c_void_p)
 		
+		self.__lib.voikkoAnalyzeWordMaskUcs4.argtypes = [c_void_p, c_wchar_p, c_int]
+		self.__lib.voikkoAnalyzeWordMaskUcs4.restype = POINTER(c_void_p)
+		
+		self.__lib.voikkoAnalyzeWordBatchUcs4.argtypes = [c_void_p, POINTER(c_wchar_p), c_size_t, POINTER(POINTER(c_void_p))]
+		self.__lib.voikkoAnalyzeWordBatchUcs4.restype = None
+		
 		self.__lib.voikkoFreeErrorMessageCstr.argtypes = [POINTER(c_char)]
 		self.__lib.voikkoFreeErrorMessageCstr.restype = None
 		
@@ -306,8 +469,27 @@ class Voikko(object):
 		self.__lib.voikkoSetIntegerOption.argtypes = [c_void_p, c_int, c_int]
 		self.__lib.voikkoSetIntegerOption.restype = c_int
 		
+		self.__lib.voikkoGetSpellerCacheStatistics.argtypes = [c_void_p, POINTER(c_size_t), POINTER(c_size_t)]
+		self.__lib.voikkoGetSpellerCacheStatistics.restype = None
+		
+		self.__lib.voikkoSaveCacheSnapshot.argtypes = [c_void_p, c_char_p]
+		self.__lib.voikkoSaveCacheSnapshot.restype = c_int
+		
+		self.__lib.voikkoLoadCacheSnapshot.argtypes = [c_void_p, c_char_p]
+		self.__lib.voikkoLoadCacheSnapshot.restype = c_int
+		
+		self.__lib.voikkoGetTransducerMemoryUsage.argtypes = [c_void_p, c_size_t, c_char_p, c_size_t,
+		                                                     POINTER(c_size_t), POINTER(c_size_t)]
+		self.__lib.voikkoGetTransducerMemoryUsage.restype = c_int
+		
 		error = c_char_p()
-		self.__handle = self.__lib.voikkoInit(byref(error), _anyStringToUtf8(language), _anyStringToPath(path))
+		if isinstance(language, SharedDictionary):
+			if not language._handle:
+				self.__handle = 0
+				raise VoikkoException("Shared dictionary has been terminated")
+			self.__handle = self.__lib.voikkoCreateSession(language._handle, byref(error))
+		else:
+			self.__handle = self.__lib.voikkoInit(byref(error), _anyStringToUtf8(language), _anyStringToPath(path))
 		if error.value != None:
 			self.__handle = 0
 			raise VoikkoException("Initialization of Voikko failed: " + unicode_str(error.value, "UTF-8"))
@@ -448,6 +630,24 @@ class Voikko(object):
 		return Voikko.__listSupportedLanguagesForOperation(path, lib, listOperation)
 	listSupportedGrammarCheckingLanguages = staticmethod(listSupportedGrammarCheckingLanguages)
 
+	def initShared(language, path = None):
+		"""Load a dictionary once so that it can be used from several threads through
+		sessions created with SharedDictionary.createSession. The parameters are the
+		same as for creating a Voikko instance. Only dictionaries that use VFST based
+		backends can be shared.
+		"""
+		lib = Voikko.__getLib()
+		lib.voikkoInitShared.argtypes = [POINTER(c_char_p), c_char_p, c_char_p]
+		lib.voikkoInitShared.restype = c_void_p
+		lib.voikkoTerminateShared.argtypes = [c_void_p]
+		lib.voikkoTerminateShared.restype = None
+		error = c_char_p()
+		shared = lib.voikkoInitShared(byref(error), _anyStringToUtf8(language), _anyStringToPath(path))
+		if error.value != None:
+			raise VoikkoException("Initialization of Voikko failed: " + unicode_str(error.value, "UTF-8"))
+		return SharedDictionary(lib, shared)
+	initShared = staticmethod(initShared)
+	
 	def getVersion():
 		"""Return the version number of the Voikko library."""
 		lib = Voikko.__getLib()
@@ -472,6 +672,54 @@ class Voikko(object):
 		else:
 			raise VoikkoException("Internal error returned from libvoikko")
 	
+	def spellBatch(self, words):
+		"""Check the spelling of given list of words. Return a list of booleans
+		telling for each word whether it is correct. This is faster than calling
+		spell for each word separately, especially when the list contains repeated words.
+		"""
+		validIndexes = [i for i in range(len(words)) if self.__isValidInput(words[i])]
+		wordArray = (c_wchar_p * len(validIndexes))(*[words[i] for i in validIndexes])
+		resultArray = (c_int * len(validIndexes))()
+		self.__lib.voikkoSpellBatchUcs4(self.__handle, wordArray, len(validIndexes), resultArray)
+		results = [False] * len(words)
+		for i in range(len(validIndexes)):
+			if resultArray[i] == 1:
+				results[validIndexes[i]] = True
+			elif resultArray[i] != 0:
+				raise VoikkoException("Internal error returned from libvoikko")
+		return results
+	
+	def checkText(self, text):
+		"""Check the spelling of all words in given natural language text. Return a list of
+		(start position, length) pairs of the misspelled words. This is faster than checking
+		the words returned by tokens one by one, especially when the text contains repeated words.
+		"""
+		errors = []
+		startIndex = 0
+		for part in text.split("\0"):
+			errors = errors + self.__checkTextPart(part, startIndex)
+			startIndex = startIndex + len(part) + 1
+		return errors
+	
+	def __checkTextPart(self, text, startIndex):
+		uniText = unicode_str(text)
+		errorCount = c_size_t()
+		cErrors = self.__lib.voikkoCheckTextUcs4(self.__handle, uniText, len(uniText), byref(errorCount))
+		errors = []
+		internalError = False
+		for i in range(errorCount.value):
+			if cErrors[i].result != 0:
+				internalError = True
+			errors.append((startIndex + cErrors[i].startpos, cErrors[i].wordlen))
+		self.__lib.voikkoFreeSpellingErrors(cErrors)
+		if internalError:
+			raise VoikkoException("Internal error returned from libvoikko")
+		return errors
+	
+	def incrementalSpeller(self):
+		"""Create an IncrementalSpeller for checking a word while it is being typed."""
+		return IncrementalSpeller(self.__lib, self.__lib.voikkoCreateIncrementalSpeller(self.__handle))
+	
 	def suggest(self, word):
 		"""Generate a list of suggested spellings for given (misspelled) word.
 		If the given word is correct, the list contains only the word itself.
@@ -542,15 +790,7 @@ class Voikko(object):
 			offset = offset + len(paragraph) + 1
 		return errorList
 	
-	def analyze(self, word):
-		"""Analyze the morphology of given word and return the list of
-		analysis results. The results are represented as maps having property
-		names as keys and property values as values.
-		"""
-		if not self.__isValidInput(word):
-			return []
-		
-		cAnalysisList = self.__lib.voikkoAnalyzeWordUcs4(self.__handle, word)
+	def __analysisList(self, cAnalysisList):
 		pAnalysisList = []
 		
 		if not bool(cAnalysisList):
@@ -573,6 +813,38 @@ class Voikko(object):
 		self.__lib.voikko_free_mor_analysis(cAnalysisList)
 		return pAnalysisList
 	
+	def analyze(self, word, attributes = None):
+		"""Analyze the morphology of given word and return the list of
+		analysis results. The results are represented as maps having property
+		names as keys and property values as values. If attributes is given,
+		it is a list of property names (see ANALYSIS_ATTRIBUTES) and only
+		those properties are computed and included in the results.
+		"""
+		if not self.__isValidInput(word):
+			return []
+		
+		if attributes is None:
+			return self.__analysisList(self.__lib.voikkoAnalyzeWordUcs4(self.__handle, word))
+		mask = 0
+		for attribute in attributes:
+			mask = mask | ANALYSIS_ATTRIBUTES[attribute]
+		return self.__analysisList(self.__lib.voikkoAnalyzeWordMaskUcs4(self.__handle, word, mask))
+	
+	def analyzeBatch(self, words):
+		"""Analyze the morphology of given list of words. Return a list containing
+		the list of analysis results for each word, as returned by analyze. This
+		is faster than calling analyze for each word separately when the list is
+		sorted.
+		"""
+		validIndexes = [i for i in range(len(words)) if self.__isValidInput(words[i])]
+		wordArray = (c_wchar_p * len(validIndexes))(*[words[i] for i in validIndexes])
+		resultArray = (POINTER(c_void_p) * len(validIndexes))()
+		self.__lib.voikkoAnalyzeWordBatchUcs4(self.__handle, wordArray, len(validIndexes), resultArray)
+		results = [[] for word in words]
+		for i in range(len(validIndexes)):
+			results[validIndexes[i]] = self.__analysisList(resultArray[i])
+		return results
+	
 	def tokens(self, text):
 		"""Split the given natural language text into a list of Token objects."""
 		startIndex = 0
@@ -763,6 +1035,51 @@ class Voikko(object):
 		"""Controls the size of in memory cache for spell checking results. 0 is the default size,
 		1 is twice as large as 0 etc. -1 disables the spell checking cache entirely."""
 		self.setIntegerOption(17, value)
+	
+	def setSpellerCacheBytes(self, value):
+		"""Sets the size of in memory cache for spell checking results in bytes.
+		0 disables the spell checking cache entirely."""
+		self.setIntegerOption(18, value)
+	
+	def getSpellerCacheStatistics(self):
+		"""Returns a tuple (hits, misses) telling how many spelling results have been
+		found from the spell checking cache and how many have not."""
+		hits = c_size_t()
+		misses = c_size_t()
+		self.__lib.voikkoGetSpellerCacheStatistics(self.__handle, byref(hits), byref(misses))
+		return (hits.value, misses.value)
+	
+	def saveCacheSnapshot(self, fileName):
+		"""Saves the spelling results in the spell checking cache to given file.
+		VoikkoException is raised if the file could not be written, the cache
+		is disabled or the dictionary does not use VFST transducers."""
+		if not self.__lib.voikkoSaveCacheSnapshot(self.__handle, _anyStringToPath(fileName)):
+			raise VoikkoException("Could not save cache snapshot to " + unicode_str(fileName))
+	
+	def loadCacheSnapshot(self, fileName):
+		"""Adds the spelling results saved with saveCacheSnapshot to the spell checking
+		cache. Returns False if the file could not be read, if it was saved with
+		another dictionary or with different spelling options or if the dictionary
+		does not use VFST transducers."""
+		return self.__lib.voikkoLoadCacheSnapshot(self.__handle, _anyStringToPath(fileName)) == 1
+	
+	def setTransducerResidency(self, flags):
+		"""Controls how the transducer files loaded in this process are kept in memory.
+		flags is a combination of TransducerResidency flags. The setting affects all
+		Voikko instances. VoikkoException is raised if some of the operations failed."""
+		self.setIntegerOption(19, flags)
+	
+	def getTransducerMemoryUsage(self):
+		"""Returns a list of tuples (file name, mapped bytes, resident bytes) for each
+		transducer file loaded in this process."""
+		result = []
+		fileName = create_string_buffer(4096)
+		mapped = c_size_t()
+		resident = c_size_t()
+		while self.__lib.voikkoGetTransducerMemoryUsage(self.__handle, len(result), fileName, 4096,
+		                                                byref(mapped), byref(resident)):
+			result.append((unicode_str(fileName.value, "UTF-8"), mapped.value, resident.value))
+		return result
 	             
 	def setSuggestionStrategy(self, value):
 		"""Set the suggestion strategy to be used when generating spelling suggestions.
@@ -184,6 +184,11 @@ const wchar_t * CONV_1TO3 =
 wchar_t * voikko_normalise(const wchar_t * word, size_t len) {
 	/* Worst case for space usage is a string with only three character ligatures in it. */
 	wchar_t * buffer = new wchar_t[len * 3 + 1];
+	voikko_normalise(word, len, buffer);
+	return buffer;
+}
+
+size_t voikko_normalise(const wchar_t * word, size_t len, wchar_t * buffer) {
 	wchar_t * ptr = buffer;
 	for (size_t i = 0; i < len;) {
 		int offset = 0;
@@ -238,7 +243,7 @@ wchar_t * voikko_normalise(const wchar_t * word, size_t len) {
 		i += offset;
 	}
 	*ptr = L'\0';
-	return buffer;
+	return ptr - buffer;
 }
 
 void voikko_cset_reformat(const wchar_t * orig, size_t orig_len, wchar_t ** modified, size_t modified_len) {
@@ -55,6 +55,16 @@ bool isFinnishQuotationMark(wchar_t c);
  */
 wchar_t * voikko_normalise(const wchar_t * word, size_t len);
 
+/** Normalises an unicode string according to our conventions, writing
+ * the result into an existing buffer.
+ * @param word string to normalise
+ * @param len length of the string
+ * @param buffer target buffer that must have space for at least len * 3 + 1
+ *        characters. The result will be null terminated.
+ * @return length of the normalised string
+ */
+size_t voikko_normalise(const wchar_t * word, size_t len, wchar_t * buffer);
+
 /** Formats modified string to more closely match the original
  * @param orig original string
  * @param orig_len length of the original string
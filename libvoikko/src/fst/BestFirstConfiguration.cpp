@@ -0,0 +1,88 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "fst/BestFirstConfiguration.hpp"
+#include <cstring>
+
+namespace libvoikko { namespace fst {
+	
+	const uint32_t BestFirstConfiguration::FINAL_PATH;
+	
+	BestFirstConfiguration::BestFirstConfiguration(uint32_t flagDiacriticFeatureCount, int bufferSize) :
+		bufferSize(bufferSize),
+		flagDiacriticFeatureCount(flagDiacriticFeatureCount),
+		acceptor(0),
+		flagsPerNode(flagDiacriticFeatureCount),
+		hasNextEntry(false),
+		inputSymbolStack(new uint32_t[bufferSize]),
+		outputSymbolStack(new uint32_t[bufferSize]),
+		inputLength(0),
+		completeInput(false),
+		distinctOutputs(false),
+		outputText(),
+		outputStarts(1, 0),
+		outputIndex()
+		{
+		}
+	
+	BestFirstConfiguration::~BestFirstConfiguration() {
+		delete[] inputSymbolStack;
+		delete[] outputSymbolStack;
+	}
+	
+	/**
+	 * Tells whether the output at given index is equal to an output.
+	 */
+	struct BestFirstConfiguration::OutputEquals {
+		const BestFirstConfiguration & configuration;
+		const char * output;
+		size_t length;
+		bool operator()(size_t index) const {
+			size_t start = configuration.outputStarts[index];
+			return configuration.outputStarts[index + 1] - start == length &&
+			       (length == 0 || memcmp(&configuration.outputText[start], output, length) == 0);
+		}
+	};
+	
+	void BestFirstConfiguration::clearOutputs() {
+		outputText.clear();
+		outputStarts.resize(1);
+		outputIndex.clear();
+	}
+	
+	bool BestFirstConfiguration::addOutput(const char * output, size_t length) {
+		OutputEquals equals = { *this, output, length };
+		size_t index = outputStarts.size() - 1;
+		if (outputIndex.findOrInsert(utils::fnvHash(output, length), index, equals) != index) {
+			return false;
+		}
+		outputText.insert(outputText.end(), output, output + length);
+		outputStarts.push_back(outputText.size());
+		return true;
+	}
+} }
@@ -0,0 +1,144 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_BEST_FIRST_CONFIGURATION_H
+#define LIBVOIKKO_FST_BEST_FIRST_CONFIGURATION_H
+
+#include "utils/Hash.hpp"
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace libvoikko { namespace fst {
+	
+	class WeightedTransducer;
+	
+	/**
+	 * Partial path in a best-first traversal. Paths are stored as a tree where
+	 * each node refers to the path it was extended from.
+	 */
+	struct BestFirstNode {
+		/** Offset of the state at the end of this path or FINAL_PATH if the path is complete */
+		uint32_t stateOffset;
+		/** Index of the node this path was extended from */
+		uint32_t parent;
+		/** Output symbol of the last transition, 0 for epsilon */
+		uint32_t symOut;
+		/** Sum of transition weights on this path */
+		int32_t weight;
+		/** Number of input symbols consumed */
+		uint32_t inputDepth;
+		/** Number of transitions on this path */
+		uint32_t depth;
+		/** Offset of the acceptor state at the end of this path when traversing a composition */
+		uint32_t acceptorStateOffset;
+		/**
+		 * Whether the acceptor may take epsilon transitions at the end of this path.
+		 * This is false after an epsilon output of the first transducer so that
+		 * the same composed path is not found in several interleavings.
+		 */
+		bool acceptorMoveAllowed;
+	};
+	
+	struct BestFirstQueueEntry {
+		/** Weight of the path plus the estimated weight of the rest of the path */
+		int32_t priority;
+		uint32_t node;
+		bool operator<(const BestFirstQueueEntry & other) const {
+			// std heap functions put the largest element first, we want the lightest
+			// path and among those the one that was created last. This makes the
+			// search go depth first among equally heavy paths.
+			return priority > other.priority || (priority == other.priority && node < other.node);
+		}
+	};
+	
+	/**
+	 * Configuration for enumerating the paths of a weighted transducer, or of
+	 * its composition with an acceptor, in ascending order of weight (see
+	 * WeightedTransducer::prepare and WeightedTransducer::next).
+	 */
+	struct BestFirstConfiguration {
+		static const uint32_t FINAL_PATH = 0xFFFFFFFF;
+		const int bufferSize;
+		const uint32_t flagDiacriticFeatureCount;
+		/** Transducer that must accept the output or null pointer if there is none */
+		const WeightedTransducer * acceptor;
+		/** Input symbol of the acceptor for each output symbol, 0 if the acceptor does not know it */
+		std::vector<uint32_t> acceptorSymbols;
+		/** Number of flag diacritic values stored for each node */
+		uint32_t flagsPerNode;
+		std::vector<BestFirstNode> nodes;
+		/**
+		 * Flag diacritic values of each node, flagsPerNode values per node. Values
+		 * of the acceptor follow those of the transducer itself.
+		 */
+		std::vector<uint32_t> flagValues;
+		/** Binary heap of paths to be extended */
+		std::vector<BestFirstQueueEntry> queue;
+		/** Path to be extended next before looking at the queue */
+		BestFirstQueueEntry nextEntry;
+		bool hasNextEntry;
+		uint32_t * inputSymbolStack;
+		/** Scratch space for collecting the output symbols of a path */
+		uint32_t * outputSymbolStack;
+		/** Length of entire input string in characters */
+		int inputLength;
+		/** Whether paths may consume more input symbols after the input, see WeightedTransducer::prepareCompletions */
+		bool completeInput;
+		/** Whether outputs that have already been returned are skipped */
+		bool distinctOutputs;
+		BestFirstConfiguration(uint32_t flagDiacriticFeatureCount, int bufferSize);
+		~BestFirstConfiguration();
+		
+		/**
+		 * Forgets the outputs returned so far. Memory used for them is kept
+		 * for the next traversal.
+		 */
+		void clearOutputs();
+		
+		/**
+		 * Remembers given output. Returns false if the output has already been
+		 * added since the last call to clearOutputs.
+		 */
+		bool addOutput(const char * output, size_t length);
+	private:
+		struct OutputEquals;
+		friend struct OutputEquals;
+		/** Outputs returned so far, one after another */
+		std::vector<char> outputText;
+		/** Start of each output in outputText, followed by the end of the last one */
+		std::vector<size_t> outputStarts;
+		/** Hash table of indexes to outputStarts */
+		utils::IndexTable outputIndex;
+		BestFirstConfiguration(const BestFirstConfiguration &);
+		BestFirstConfiguration & operator=(const BestFirstConfiguration &);
+	};
+
+} }
+
+#endif
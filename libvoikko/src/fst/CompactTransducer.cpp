@@ -0,0 +1,403 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "porting.h"
+#include "fst/CompactTransducer.hpp"
+#include "fst/Traversal.hpp"
+#include "setup/DictionaryException.hpp"
+#include "utf8/utf8.hpp"
+#include <cstdio>
+#include <cstring>
+
+#if 0
+#include <iostream>
+#define DEBUG(x) cerr << x << endl;
+#else
+#define DEBUG(x)
+#endif
+
+using namespace std;
+
+namespace libvoikko { namespace fst {
+	
+	static const unsigned char COMPACT_COOKIE[8] = {0x6E, 0x3A, 0x01, 0x00, 0xFB, 0x51, 0x03, 0x00};
+	static const size_t HEADER_SIZE = 24;
+	
+	static inline uint32_t readLittleEndian(const unsigned char * p, uint32_t bytes) {
+		switch (bytes) {
+			case 1:
+				return p[0];
+			case 2:
+				return p[0] | (p[1] << 8);
+			case 3:
+				return p[0] | (p[1] << 8) | (static_cast<uint32_t>(p[2]) << 16);
+			default:
+				return p[0] | (p[1] << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+		}
+	}
+	
+	static size_t alignTo8(size_t position) {
+		return (position + 7) & ~static_cast<size_t>(7);
+	}
+	
+	/**
+	 * Field access for one combination of symbol and target widths. Traversal
+	 * code is instantiated for each layout so that the widths are known at
+	 * compile time in the inner loop.
+	 */
+	template<uint32_t SymbolBytes, uint32_t TargetBytes>
+	struct RecordLayout {
+		static uint32_t symIn(const unsigned char * record) {
+			return readLittleEndian(record, SymbolBytes);
+		}
+		static uint32_t symOut(const unsigned char * record) {
+			return readLittleEndian(record + SymbolBytes, SymbolBytes);
+		}
+		static uint32_t target(const unsigned char * record) {
+			return readLittleEndian(record + 2 * SymbolBytes, TargetBytes);
+		}
+	};
+	
+	bool CompactTransducer::isCompactTransducerFile(const char * filePath) {
+		FILE * file = fopen(filePath, "rb");
+		if (!file) {
+			return false;
+		}
+		unsigned char cookie[8];
+		bool isCompact = fread(cookie, 1, 8, file) == 8 && memcmp(cookie, COMPACT_COOKIE, 8) == 0;
+		fclose(file);
+		return isCompact;
+	}
+	
+	CompactTransducer::CompactTransducer(const char * filePath) : Transducer() {
+		map = vfstMmap(filePath, fileLength);
+		if (!map) {
+			throw setup::DictionaryException("Compact transducer file could not be read");
+		}
+		byteSwapped = false;
+		const unsigned char * file = static_cast<const unsigned char *>(map);
+		if (fileLength < HEADER_SIZE + sizeof(uint16_t) || memcmp(file, COMPACT_COOKIE, 8) != 0) {
+			vfstMunmap(map, fileLength);
+			throw setup::DictionaryException("Not a compact transducer file");
+		}
+		if (file[8] != 0x00) {
+			vfstMunmap(map, fileLength);
+			throw setup::DictionaryException("Weighted compact transducers are not supported");
+		}
+		symbolBytes = file[9];
+		targetBytes = file[10];
+		recordCount = readLittleEndian(file + 16, 4);
+		farTargetCount = readLittleEndian(file + 20, 4);
+		uint16_t symbolCount = readLittleEndian(file + 24, 2);
+		if ((symbolBytes != 1 && symbolBytes != 2) || targetBytes < 2 || targetBytes > 4) {
+			vfstMunmap(map, fileLength);
+			throw setup::DictionaryException("Unsupported compact transducer field widths");
+		}
+		recordSize = 2 * symbolBytes + targetBytes;
+		finalSymbol = (symbolBytes == 1 ? 0xFF : 0xFFFF);
+		farTargetFlag = static_cast<uint32_t>(1) << (8 * targetBytes - 1);
+		
+		const char * filePtr = reinterpret_cast<const char *>(file + HEADER_SIZE + sizeof(uint16_t));
+		const char * fileEnd = reinterpret_cast<const char *>(file + fileLength);
+		firstNormalChar = 0;
+		firstMultiChar = 0;
+		std::map<string, uint16_t> stringToSymbol;
+		std::map<string, uint16_t> features;
+		std::map<string, uint16_t> values;
+		values[""] = FlagValueNeutral;
+		values["@"] = FlagValueAny;
+		symbolToDiacritic.push_back(OpFeatureValue()); // epsilon
+		DEBUG("Reading " << symbolCount << " symbols to symbol table");
+		for (uint16_t i = 0; i < symbolCount; i++) {
+			const char * symbolEnd = static_cast<const char *>(memchr(filePtr, '\0', fileEnd - filePtr));
+			if (!symbolEnd) {
+				vfstMunmap(map, fileLength);
+				throw setup::DictionaryException("Truncated compact transducer file");
+			}
+			string symbol(filePtr, symbolEnd);
+			if (firstNormalChar == 0 && i > 0 && symbol[0] != '@') {
+				firstNormalChar = i;
+			}
+			if (firstNormalChar != 0 && firstMultiChar == 0 && symbol[0] == '[') {
+				firstMultiChar = i;
+			}
+			symbolToString.push_back(filePtr);
+			filePtr = symbolEnd + 1;
+			stringToSymbol.insert(pair<string, uint16_t>(symbol, i));
+			if (firstNormalChar == 0 && i > 0) {
+				symbolToDiacritic.push_back(getDiacriticOperation(symbol, features, values));
+			}
+		}
+		symbolIndex.build(stringToSymbol, symbolToString);
+		unknownSymbolOrdinal = symbolCount;
+		flagDiacriticFeatureCount = features.size();
+		
+		size_t position = alignTo8(reinterpret_cast<const unsigned char *>(filePtr) - file);
+		stateStarts = file + position;
+		position = alignTo8(position + recordCount / 8 + 1);
+		farTargets = file + position;
+		position += static_cast<size_t>(farTargetCount) * sizeof(uint32_t);
+		records = file + position;
+		if (position > fileLength || (fileLength - position) / recordSize < recordCount) {
+			vfstMunmap(map, fileLength);
+			throw setup::DictionaryException("Truncated compact transducer file");
+		}
+		// The first state and the end of the last state must be marked for state lengths to be found
+		if (recordCount == 0 || !isStateStart(0) || !isStateStart(recordCount) || !buildStateIndex()) {
+			vfstMunmap(map, fileLength);
+			throw setup::DictionaryException("Corrupt compact transducer file");
+		}
+	}
+	
+	uint32_t CompactTransducer::symIn(uint32_t transitionIndex) const {
+		const unsigned char * record = records + static_cast<size_t>(transitionIndex) * recordSize;
+		return symbolBytes == 1 ? record[0] : record[0] | (record[1] << 8);
+	}
+	
+	inline uint32_t CompactTransducer::decodeTarget(uint32_t transitionIndex, uint32_t stored) const {
+		if (stored & farTargetFlag) {
+			return readLittleEndian(farTargets + (stored & ~farTargetFlag) * sizeof(uint32_t), 4);
+		}
+		// zigzag coded difference to the index of this transition
+		return transitionIndex + ((stored >> 1) ^ (0 - (stored & 1)));
+	}
+	
+	uint32_t CompactTransducer::targetState(uint32_t transitionIndex) const {
+		const unsigned char * record = records + static_cast<size_t>(transitionIndex) * recordSize + 2 * symbolBytes;
+		return decodeTarget(transitionIndex, readLittleEndian(record, targetBytes));
+	}
+	
+	bool CompactTransducer::buildStateIndex() {
+		stateMaxTc.resize(recordCount);
+		uint32_t stateOffset = 0;
+		while (stateOffset < recordCount) {
+			uint32_t maxTc = scanMaxTc(stateOffset);
+			stateMaxTc[stateOffset] = maxTc < LARGE_STATE ? maxTc : LARGE_STATE;
+			uint64_t ownSummary = 0;
+			bool hasEpsilons = false;
+			for (uint32_t tc = 0; tc <= maxTc; tc++) {
+				uint32_t transitionSymIn = symIn(stateOffset + tc);
+				if (transitionSymIn == finalSymbol) {
+					ownSummary |= InputSymbolSummary::FINAL;
+				}
+				else {
+					const unsigned char * record = records + static_cast<size_t>(stateOffset + tc) * recordSize + 2 * symbolBytes;
+					uint32_t stored = readLittleEndian(record, targetBytes);
+					if ((stored & farTargetFlag) && (stored & ~farTargetFlag) >= farTargetCount) {
+						return false;
+					}
+					uint32_t target = decodeTarget(stateOffset + tc, stored);
+					if (target >= recordCount || !isStateStart(target)) {
+						return false;
+					}
+					if (transitionSymIn < firstNormalChar) {
+						hasEpsilons = true;
+					}
+					else {
+						ownSummary |= InputSymbolSummary::symbolBit(transitionSymIn);
+					}
+				}
+			}
+			inputSummary.addState(stateOffset, ownSummary);
+			for (uint32_t tc = 0; hasEpsilons && tc <= maxTc; tc++) {
+				if (symIn(stateOffset + tc) < firstNormalChar) {
+					inputSummary.addEpsilonTransition(targetState(stateOffset + tc));
+				}
+			}
+			if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS) {
+				vector<uint32_t> inputSymbols(maxTc + 1);
+				for (uint32_t tc = 0; tc <= maxTc; tc++) {
+					uint32_t transitionSymIn = symIn(stateOffset + tc);
+					if (transitionSymIn == finalSymbol || transitionSymIn < firstNormalChar) {
+						inputSymbols[tc] = 0;
+					}
+					else {
+						inputSymbols[tc] = transitionSymIn;
+					}
+				}
+				stateIndex.addState(stateOffset, maxTc, inputSymbols);
+			}
+			stateOffset += maxTc + 1;
+		}
+		inputSummary.build(recordCount);
+		return true;
+	}
+	
+	bool CompactTransducer::prepare(Configuration * configuration, const char * input, size_t inputLen) const {
+		configuration->stackDepth = 0;
+		configuration->baseDepth = 0;
+		configuration->inputDepth = 0;
+		configuration->stateIndexStack[0] = 0;
+		configuration->currentTransitionStack[0] = 0;
+		if (flagDiacriticFeatureCount) {
+			memset(configuration->flagValues, 0, flagDiacriticFeatureCount * sizeof(uint16_t));
+		}
+		configuration->inputLength = 0;
+		const char * ip = input;
+		bool allKnown = true;
+		while (ip < input + inputLen) {
+			uint16_t symbol = symbolIndex.findChar(utf8::unchecked::next(ip));
+			if (symbol == 0) {
+				configuration->inputSymbolStack[configuration->inputLength] = unknownSymbolOrdinal;
+				allKnown = false;
+			}
+			else {
+				configuration->inputSymbolStack[configuration->inputLength] = symbol;
+			}
+			configuration->inputLength++;
+		}
+		return allKnown;
+	}
+	
+	bool CompactTransducer::next(Configuration * configuration, char * outputBuffer, size_t bufferLen) const {
+		return nextPath(configuration, 0, outputBuffer, bufferLen, 0, false);
+	}
+	
+	bool CompactTransducer::nextPrefix(Configuration * configuration, char * outputBuffer, size_t bufferLen, size_t * prefixLength) const {
+		return nextPath(configuration, 0, outputBuffer, bufferLen, prefixLength, false);
+	}
+	
+	bool CompactTransducer::prepare(Configuration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const {
+		if (!prepare(configuration, input, inputLen)) {
+			return false;
+		}
+		frontier->start(configuration);
+		return true;
+	}
+	
+	bool CompactTransducer::next(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen) const {
+		return nextPath(configuration, frontier, outputBuffer, bufferLen, 0, false);
+	}
+	
+	bool CompactTransducer::prepareCompletions(Configuration * configuration, const char * input, size_t inputLen,
+	                                           size_t completionLength) const {
+		configuration->completionLength = completionLength;
+		return prepare(configuration, input, inputLen);
+	}
+	
+	bool CompactTransducer::nextCompletion(Configuration * configuration, char * outputBuffer, size_t bufferLen) const {
+		return nextPath(configuration, 0, outputBuffer, bufferLen, 0, true);
+	}
+	
+	/**
+	 * Access to the transitions of a compact transducer with given record
+	 * layout for traverse.
+	 */
+	template<class Layout>
+	struct CompactCells : public TraversalTables {
+		static const bool OVERFLOW_CELLS = false;
+		const CompactTransducer & compact;
+		CompactCells(const CompactTransducer & compact) :
+			TraversalTables(&compact, compact.stateIndex, compact.inputSummary, compact.symbolToString),
+			compact(compact) {
+		}
+		const unsigned char * record(uint32_t transition) const {
+			return compact.records + static_cast<size_t>(transition) * compact.recordSize;
+		}
+		uint32_t finalSymbol() const {
+			return compact.finalSymbol;
+		}
+		uint32_t maxTc(uint32_t stateOffset) const {
+			return compact.getMaxTc(stateOffset);
+		}
+		uint32_t symIn(uint32_t transition) const {
+			return Layout::symIn(record(transition));
+		}
+		uint32_t symOut(uint32_t transition) const {
+			return Layout::symOut(record(transition));
+		}
+		uint32_t targetState(uint32_t transition) const {
+			return compact.decodeTarget(transition, Layout::target(record(transition)));
+		}
+		int16_t weight(uint32_t) const {
+			// compact transducers are unweighted
+			return 0;
+		}
+	};
+	
+	template<class Layout>
+	static bool traverseLayout(const CompactTransducer & compact, bool flags, bool complete, Configuration * configuration,
+	                           PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen, size_t * prefixLength,
+	                           TraversalResult & result) {
+		CompactCells<Layout> cells(compact);
+		if (frontier) {
+			return flags ?
+				traverseBatch< TraversalPolicy<false, true, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result) :
+				traverseBatch< TraversalPolicy<false, false, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result);
+		}
+		if (complete) {
+			return flags ?
+				traverse< TraversalPolicy<false, true, false, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result) :
+				traverse< TraversalPolicy<false, false, false, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result);
+		}
+		if (prefixLength) {
+			return flags ?
+				traverse< TraversalPolicy<false, true, true> >(cells, configuration, outputBuffer, bufferLen, result) :
+				traverse< TraversalPolicy<false, false, true> >(cells, configuration, outputBuffer, bufferLen, result);
+		}
+		return flags ?
+			traverse< TraversalPolicy<false, true, false> >(cells, configuration, outputBuffer, bufferLen, result) :
+			traverse< TraversalPolicy<false, false, false> >(cells, configuration, outputBuffer, bufferLen, result);
+	}
+	
+	bool CompactTransducer::nextPath(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen,
+	                                 size_t * prefixLength, bool complete) const {
+		bool flags = (firstNormalChar > 1);
+		TraversalResult result;
+		bool found;
+		if (symbolBytes == 1) {
+			switch (targetBytes) {
+				case 2:
+					found = traverseLayout< RecordLayout<1, 2> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+					break;
+				case 3:
+					found = traverseLayout< RecordLayout<1, 3> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+					break;
+				default:
+					found = traverseLayout< RecordLayout<1, 4> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+			}
+		}
+		else {
+			switch (targetBytes) {
+				case 2:
+					found = traverseLayout< RecordLayout<2, 2> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+					break;
+				case 3:
+					found = traverseLayout< RecordLayout<2, 3> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+					break;
+				default:
+					found = traverseLayout< RecordLayout<2, 4> >(*this, flags, complete, configuration, frontier, outputBuffer, bufferLen, prefixLength, result);
+			}
+		}
+		if (found && prefixLength) {
+			*prefixLength = result.prefixLength;
+		}
+		return found;
+	}
+	
+} }
@@ -0,0 +1,171 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_COMPACT_TRANSDUCER_H
+#define LIBVOIKKO_FST_COMPACT_TRANSDUCER_H
+
+#include "fst/Transducer.hpp"
+#include "fst/SymbolIndex.hpp"
+#include "fst/StateIndex.hpp"
+#include "fst/InputSymbolSummary.hpp"
+#include "fst/Configuration.hpp"
+#include "fst/PrefixFrontier.hpp"
+
+namespace libvoikko { namespace fst {
+	
+	template<class Layout> struct CompactCells;
+	
+	/**
+	 * Transducer stored in the compact VFST format (format version 2). The file
+	 * is always little endian and used directly through mmap. All transitions of
+	 * a file are stored in fixed size records whose field widths are chosen when
+	 * the file is written:
+	 * 
+	 * - input and output symbols take 1 byte if there are less than 255 symbols
+	 *   and 2 bytes otherwise. The largest value marks a final state.
+	 * - target state is stored in 2, 3 or 4 bytes as zigzag coded difference to
+	 *   the index of the record itself. If the highest bit is set the remaining
+	 *   bits are an index to a table of 32 bit targets that did not fit.
+	 * 
+	 * Transitions of a state are stored one after another without overflow
+	 * cells. A bit vector with one bit per record marks the first record of
+	 * each state. State offsets are record indexes, so the number of states is
+	 * limited only by the 32 bit offset. Compact transducers have no weights.
+	 */
+	class CompactTransducer : public Transducer {
+		private:
+			const unsigned char * records;
+			const unsigned char * stateStarts;
+			const unsigned char * farTargets;
+			uint32_t recordCount;
+			uint32_t farTargetCount;
+			uint32_t recordSize;
+			uint32_t symbolBytes;
+			uint32_t targetBytes;
+			uint32_t finalSymbol;
+			uint32_t farTargetFlag;
+			std::vector<unsigned char> stateMaxTc;
+			SymbolIndex symbolIndex;
+			StateIndex stateIndex;
+			InputSymbolSummary inputSummary;
+			std::vector<const char *> symbolToString;
+			uint16_t firstMultiChar;
+			uint16_t unknownSymbolOrdinal;
+			
+			/**
+			 * Value of stateMaxTc for states that have more transitions than fit
+			 * in one byte.
+			 */
+			static const unsigned char LARGE_STATE = 0xFF;
+			
+			/**
+			 * Returns the index of the last transition of given state, relative to
+			 * the state head. This is looked up from stateMaxTc because traversal
+			 * needs it on every state visit.
+			 */
+			uint32_t getMaxTc(uint32_t stateOffset) const {
+				uint32_t maxTc = stateMaxTc[stateOffset];
+				return maxTc != LARGE_STATE ? maxTc : scanMaxTc(stateOffset);
+			}
+			
+			/**
+			 * Returns the index of the last transition of given state by finding
+			 * the next set bit in stateStarts.
+			 */
+			uint32_t scanMaxTc(uint32_t stateOffset) const {
+				uint32_t position = stateOffset + 1;
+				const unsigned char * bytePtr = stateStarts + (position >> 3);
+				unsigned int bits = *bytePtr >> (position & 7);
+				while (!bits) {
+					bytePtr++;
+					position = (bytePtr - stateStarts) << 3;
+					bits = *bytePtr;
+				}
+				while (!(bits & 1)) {
+					bits >>= 1;
+					position++;
+				}
+				return position - stateOffset - 1;
+			}
+			bool isStateStart(uint32_t offset) const {
+				return stateStarts[offset >> 3] & (1 << (offset & 7));
+			}
+			uint32_t symIn(uint32_t transitionIndex) const;
+			uint32_t targetState(uint32_t transitionIndex) const;
+			uint32_t decodeTarget(uint32_t transitionIndex, uint32_t stored) const;
+			
+			/**
+			 * Builds the state lengths and indexes. Returns false if a transition
+			 * points outside the transducer or to something else than a state head.
+			 */
+			bool buildStateIndex();
+			bool nextPath(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen,
+			              size_t * prefixLength, bool complete) const;
+			template<class Layout> friend struct CompactCells;
+		public:
+			CompactTransducer(const char * filePath);
+			
+			/**
+			 * Returns true if given file looks like a compact transducer file.
+			 */
+			static bool isCompactTransducerFile(const char * filePath);
+			
+			bool prepare(Configuration * configuration, const char * input, size_t inputLen) const;
+			
+			bool next(Configuration * configuration, char * outputBuffer, size_t bufferLen) const;
+			
+			bool nextPrefix(Configuration * configuration, char * outputBuffer, size_t bufferLen, size_t * prefixLength) const;
+			
+			/**
+			 * Like prepare but the lookup continues from the states that frontier
+			 * has saved for the prefix shared with the previous input. Results must
+			 * then be read with the next method that takes the same frontier.
+			 */
+			bool prepare(Configuration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const;
+			
+			bool next(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen) const;
+			
+			/**
+			 * Prepares the configuration for listing the input sides of paths whose
+			 * input begins with given input and has completionLength symbols in
+			 * total. The input sides are then read with nextCompletion.
+			 * @return false if the input contains unknown symbols
+			 */
+			bool prepareCompletions(Configuration * configuration, const char * input, size_t inputLen,
+			                        size_t completionLength) const;
+			
+			/**
+			 * Writes the input side of the next path found for prepareCompletions
+			 * to outputBuffer. The same input side is returned for each path that
+			 * has it.
+			 */
+			bool nextCompletion(Configuration * configuration, char * outputBuffer, size_t bufferLen) const;
+	};
+} }
+
+#endif
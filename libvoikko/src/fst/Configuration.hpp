@@ -38,14 +38,32 @@ namespace libvoikko { namespace fst {
 	struct Configuration {
 		const int bufferSize;
 		int stackDepth;
+		/** Stack depth where the traversal ends instead of backtracking (see PrefixFrontier) */
+		int baseDepth;
 		int inputDepth;
 		uint32_t * stateIndexStack;
 		uint32_t * currentTransitionStack;
+		/** Next transition matching the input in indexed states (see StateIndex) */
+		uint32_t * matchingTransitionStack;
+		/** Sum of the transition weights on the path up to each stack depth */
+		int32_t * weightStack;
 		uint16_t * inputSymbolStack;
 		uint16_t * outputSymbolStack;
-		uint16_t * flagValueStack;
+		/** Current values of flag diacritic features */
+		uint16_t * flagValues;
+		/**
+		 * Value that the feature changed by the flag diacritic transition taken
+		 * at each stack depth had before the transition
+		 */
+		uint16_t * flagUndoStack;
 		/** Length of entire input string in characters */
 		int inputLength;
+		/** Symbol that may be consumed instead of the first input symbol, 0 if there is none */
+		uint16_t firstInputVariant;
+		/** Whether paths may end before the last input symbol */
+		bool lastInputOptional;
+		/** Number of input symbols consumed by the paths when listing completions */
+		int completionLength;
 		Configuration(uint16_t flagDiacriticFeatureCount, int bufferSize);
 		~Configuration();
 	};
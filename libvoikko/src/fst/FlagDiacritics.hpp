@@ -0,0 +1,117 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_FLAG_DIACRITICS_H
+#define LIBVOIKKO_FST_FLAG_DIACRITICS_H
+
+#include "fst/Transducer.hpp"
+#include "fst/Configuration.hpp"
+#include "fst/WeightedConfiguration.hpp"
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Checks whether flag diacritic operation ofv is allowed when the feature has
+	 * given value and if so, sets value to the value after the operation. This
+	 * is the only implementation of the operations: unweighted and weighted
+	 * traversals only differ in the width of the stored values.
+	 */
+	template <typename ValueT>
+	inline bool flagDiacriticApply(OpFeatureValue ofv, ValueT & value) {
+		switch (ofv.op) {
+			case Operation_P:
+				value = ofv.value;
+				return true;
+			case Operation_C:
+				value = FlagValueNeutral;
+				return true;
+			case Operation_U:
+				if (value) {
+					return value == ofv.value;
+				}
+				value = ofv.value;
+				return true;
+			case Operation_R:
+				if (ofv.value == FlagValueAny) {
+					return value != FlagValueNeutral;
+				}
+				return value == ofv.value;
+			case Operation_D:
+				if (ofv.value == FlagValueAny) {
+					return value == FlagValueNeutral;
+				}
+				return value != ofv.value;
+			default:
+				return false;// this would be an error
+		}
+	}
+	
+	/**
+	 * Applies flag diacritic operation ofv to flagValues and saves the previous
+	 * value of the feature to undoValue if the operation is allowed.
+	 */
+	template <typename ValueT>
+	inline bool flagDiacriticCheck(OpFeatureValue ofv, ValueT * flagValues, ValueT & undoValue) {
+		ValueT previousValue = flagValues[ofv.feature];
+		if (!flagDiacriticApply(ofv, flagValues[ofv.feature])) {
+			return false;
+		}
+		undoValue = previousValue;
+		return true;
+	}
+	
+	/**
+	 * Checks whether a transition with given input symbol is allowed by the current
+	 * flag diacritic values of a depth first traversal and if so, applies the
+	 * operation. The previous value of the feature is saved so that
+	 * flagDiacriticUndo can restore it when the traversal backtracks.
+	 * ConfigurationT is Configuration or WeightedConfiguration.
+	 */
+	template <typename ConfigurationT>
+	inline bool flagDiacriticCheck(ConfigurationT * configuration, const Transducer * transducer, uint16_t symbol) {
+		if (symbol == 0 || symbol >= transducer->firstNormalChar) {
+			return true;
+		}
+		return flagDiacriticCheck(transducer->symbolToDiacritic[symbol], configuration->flagValues,
+		                          configuration->flagUndoStack[configuration->stackDepth]);
+	}
+	
+	/**
+	 * Restores the flag diacritic value changed by the transition with given
+	 * input symbol taken at the current stack depth.
+	 */
+	template <typename ConfigurationT>
+	inline void flagDiacriticUndo(ConfigurationT * configuration, const Transducer * transducer, uint16_t symbol) {
+		if (symbol != 0 && symbol < transducer->firstNormalChar) {
+			configuration->flagValues[transducer->symbolToDiacritic[symbol].feature] =
+				configuration->flagUndoStack[configuration->stackDepth];
+		}
+	}
+} }
+
+#endif
@@ -0,0 +1,119 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "fst/InputSymbolSummary.hpp"
+
+using namespace std;
+
+namespace libvoikko { namespace fst {
+	
+	const uint64_t InputSymbolSummary::FINAL;
+	
+	static uint32_t bitCount(uint64_t bits) {
+		const uint64_t allBits = ~static_cast<uint64_t>(0);
+		bits = bits - ((bits >> 1) & (allBits / 3));
+		bits = (bits & (allBits / 5)) + ((bits >> 2) & (allBits / 5));
+		bits = (bits + (bits >> 4)) & (allBits / 17);
+		return static_cast<uint32_t>((bits * (allBits / 255)) >> 56);
+	}
+	
+	uint32_t InputSymbolSummary::stateNumber(uint32_t stateOffset) const {
+		uint32_t block = stateOffset / 64;
+		uint64_t before = stateStarts[block] & ((static_cast<uint64_t>(1) << (stateOffset % 64)) - 1);
+		return blockRanks[block] + bitCount(before);
+	}
+	
+	void InputSymbolSummary::addState(uint32_t stateOffset, uint64_t ownSummary) {
+		uint32_t block = stateOffset / 64;
+		if (stateStarts.size() <= block) {
+			stateStarts.resize(block + 1, 0);
+		}
+		stateStarts[block] |= static_cast<uint64_t>(1) << (stateOffset % 64);
+		summaries.push_back(ownSummary);
+	}
+	
+	void InputSymbolSummary::addEpsilonTransition(uint32_t targetOffset) {
+		epsilonTransitions.push_back(static_cast<uint32_t>(summaries.size() - 1));
+		epsilonTransitions.push_back(targetOffset);
+	}
+	
+	void InputSymbolSummary::build(uint32_t cellCount) {
+		stateStarts.resize(cellCount / 64 + 1, 0);
+		blockRanks.resize(stateStarts.size());
+		uint32_t rank = 0;
+		for (size_t block = 0; block < stateStarts.size(); block++) {
+			blockRanks[block] = rank;
+			rank += bitCount(stateStarts[block]);
+		}
+		
+		// Epsilon transitions reversed and grouped by target state
+		size_t stateCount = summaries.size();
+		size_t transitionCount = epsilonTransitions.size() / 2;
+		vector<uint32_t> reverseStart(stateCount + 1, 0);
+		vector<uint32_t> targets(transitionCount);
+		for (size_t i = 0; i < transitionCount; i++) {
+			targets[i] = stateNumber(epsilonTransitions[2 * i + 1]);
+			reverseStart[targets[i] + 1]++;
+		}
+		for (size_t i = 0; i < stateCount; i++) {
+			reverseStart[i + 1] += reverseStart[i];
+		}
+		vector<uint32_t> reverseSource(transitionCount);
+		vector<uint32_t> fill(reverseStart.begin(), reverseStart.end() - 1);
+		for (size_t i = 0; i < transitionCount; i++) {
+			reverseSource[fill[targets[i]]++] = epsilonTransitions[2 * i];
+		}
+		vector<uint32_t>().swap(epsilonTransitions);
+		
+		// Propagate summaries backwards along epsilon transitions until nothing changes
+		vector<uint32_t> pending;
+		vector<bool> isPending(stateCount, false);
+		for (size_t i = stateCount; i > 0; i--) {
+			if (reverseStart[i] != reverseStart[i - 1]) {
+				pending.push_back(static_cast<uint32_t>(i - 1));
+				isPending[i - 1] = true;
+			}
+		}
+		while (!pending.empty()) {
+			uint32_t target = pending.back();
+			pending.pop_back();
+			isPending[target] = false;
+			for (uint32_t i = reverseStart[target]; i < reverseStart[target + 1]; i++) {
+				uint32_t source = reverseSource[i];
+				uint64_t combined = summaries[source] | summaries[target];
+				if (combined != summaries[source]) {
+					summaries[source] = combined;
+					if (!isPending[source] && reverseStart[source] != reverseStart[source + 1]) {
+						pending.push_back(source);
+						isPending[source] = true;
+					}
+				}
+			}
+		}
+	}
+} }
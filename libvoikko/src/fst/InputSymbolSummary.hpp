@@ -0,0 +1,101 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_INPUT_SYMBOL_SUMMARY_H
+#define LIBVOIKKO_FST_INPUT_SYMBOL_SUMMARY_H
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * In-memory table built after loading a transducer that tells, for each
+	 * state, which input symbols can be consumed next when starting from that
+	 * state, either directly or after any number of epsilon and flag diacritic
+	 * transitions. Symbols are folded into a 63 bit signature and the remaining
+	 * bit tells whether a final state can be reached without consuming input.
+	 * Flag diacritic conditions are ignored, so the summary may claim that a
+	 * symbol can be consumed when it cannot, but never the opposite. A traversal
+	 * can therefore skip a transition whose target state cannot consume the
+	 * next input symbol without changing the results.
+	 */
+	class InputSymbolSummary {
+		private:
+			/** Bit for each transition table cell telling whether a state starts there */
+			std::vector<uint64_t> stateStarts;
+			/** Number of states starting before each 64 cell block */
+			std::vector<uint32_t> blockRanks;
+			/** Summary of each state in the order of state offsets */
+			std::vector<uint64_t> summaries;
+			/** Pairs of (source state number, target state offset) of epsilon and flag diacritic transitions */
+			std::vector<uint32_t> epsilonTransitions;
+			uint32_t stateNumber(uint32_t stateOffset) const;
+		public:
+			/** Bit that is set in the summary if a final state can be reached */
+			static const uint64_t FINAL = static_cast<uint64_t>(1) << 63;
+			
+			/**
+			 * Returns the bit that is set in the summary if given input symbol
+			 * may be consumed.
+			 */
+			static uint64_t symbolBit(uint32_t symbol) {
+				return static_cast<uint64_t>(1) << (symbol % 63);
+			}
+			
+			/**
+			 * Adds a state. States must be added in ascending order of offset.
+			 * @param stateOffset offset of the state in the transition table
+			 * @param ownSummary bits for the normal input symbols of the transitions of
+			 *        this state, plus FINAL if the state is final
+			 */
+			void addState(uint32_t stateOffset, uint64_t ownSummary);
+			
+			/**
+			 * Adds an epsilon or flag diacritic transition from the state that was
+			 * added last.
+			 */
+			void addEpsilonTransition(uint32_t targetOffset);
+			
+			/**
+			 * Completes the summaries of all states after they have been added.
+			 * @param cellCount number of cells in the transition table
+			 */
+			void build(uint32_t cellCount);
+			
+			/**
+			 * Returns the summary of the state at given offset.
+			 */
+			uint64_t get(uint32_t stateOffset) const {
+				return summaries[stateNumber(stateOffset)];
+			}
+	};
+} }
+
+#endif
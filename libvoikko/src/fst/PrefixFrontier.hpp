@@ -0,0 +1,184 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_PREFIX_FRONTIER_H
+#define LIBVOIKKO_FST_PREFIX_FRONTIER_H
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Traversal states saved for each prefix of the previous input so that the
+	 * next lookup can continue from the longest prefix it shares with the previous
+	 * input instead of the start state. This is useful for sorted word lists where
+	 * consecutive words share long prefixes.
+	 * 
+	 * Once an input symbol has been consumed, the rest of a depth first traversal
+	 * depends only on the target state, the output so far, the path weight and
+	 * the flag diacritic values. These are saved in traversal order for each
+	 * transition that consumes input, so continuing from the saved states of a
+	 * prefix gives the same results in the same order as a traversal from the
+	 * start state.
+	 * 
+	 * The states of a prefix are complete only if the lookup that saved them was
+	 * run until it returned no more results. A lookup may be stopped earlier, but
+	 * then the next lookup can continue at most from the prefix that the stopped
+	 * lookup continued from.
+	 */
+	class PrefixFrontier {
+		private:
+			struct Entry {
+				uint32_t state;
+				int stackDepth;
+				int32_t weight;
+				/** Position of the output symbols and flag values of this entry in Level::symbols */
+				size_t symbolStart;
+			};
+			struct Level {
+				std::vector<Entry> entries;
+				std::vector<uint32_t> symbols;
+			};
+			const uint32_t flagDiacriticFeatureCount;
+			/** Saved states for each prefix length of the previous input */
+			std::vector<Level> levels;
+			std::vector<uint32_t> previousInput;
+			/** Length of the longest prefix of previousInput whose states are complete */
+			int completeDepth;
+			/** Length of the prefix the current lookup continues from */
+			int resumeDepth;
+			/** Next entry of levels[resumeDepth] to continue from */
+			size_t nextEntry;
+			/** Whether the configuration holds a traversal that has not ended yet */
+			bool active;
+			PrefixFrontier(const PrefixFrontier &);
+			PrefixFrontier & operator=(const PrefixFrontier &);
+		public:
+			PrefixFrontier(uint32_t flagDiacriticFeatureCount);
+			
+			/**
+			 * Starts a lookup for the input of a configuration that has just been
+			 * prepared. Saved states of prefixes that the input does not share with
+			 * the previous input are discarded.
+			 */
+			template<class Config>
+			void start(Config * configuration) {
+				int inputLength = configuration->inputLength;
+				int commonLength = 0;
+				int maxCommonLength = std::min(completeDepth, inputLength);
+				while (commonLength < maxCommonLength &&
+				       previousInput[commonLength] == configuration->inputSymbolStack[commonLength]) {
+					commonLength++;
+				}
+				previousInput.assign(configuration->inputSymbolStack, configuration->inputSymbolStack + inputLength);
+				if (levels.size() < static_cast<size_t>(inputLength) + 1) {
+					levels.resize(inputLength + 1);
+				}
+				for (size_t depth = commonLength + 1; depth < levels.size(); depth++) {
+					levels[depth].entries.clear();
+					levels[depth].symbols.clear();
+				}
+				completeDepth = commonLength;
+				resumeDepth = commonLength;
+				nextEntry = 0;
+				if (commonLength == 0) {
+					// continue from the start state set by prepare
+					active = true;
+				}
+				else {
+					resumeNext(configuration);
+				}
+			}
+			
+			/**
+			 * Sets up the configuration to continue from the next saved state of the
+			 * prefix after the traversal from the previous one has ended.
+			 * @return false if there are no more states to continue from
+			 */
+			template<class Config>
+			bool resumeNext(Config * configuration) {
+				if (resumeDepth == 0 || nextEntry >= levels[resumeDepth].entries.size()) {
+					active = false;
+					completeDepth = static_cast<int>(previousInput.size());
+					return false;
+				}
+				const Level & level = levels[resumeDepth];
+				const Entry & entry = level.entries[nextEntry++];
+				int depth = entry.stackDepth;
+				configuration->stackDepth = depth;
+				configuration->baseDepth = depth;
+				configuration->inputDepth = resumeDepth;
+				configuration->stateIndexStack[depth] = entry.state;
+				configuration->currentTransitionStack[depth] = entry.state;
+				configuration->weightStack[depth] = entry.weight;
+				std::vector<uint32_t>::const_iterator symbols = level.symbols.begin() + entry.symbolStart;
+				std::copy(symbols, symbols + depth, configuration->outputSymbolStack);
+				std::copy(symbols + depth, symbols + depth + flagDiacriticFeatureCount, configuration->flagValues);
+				active = true;
+				return true;
+			}
+			
+			/**
+			 * Saves the state of a traversal that has just consumed an input symbol.
+			 */
+			template<bool Weighted, class Config>
+			void record(const Config * configuration) {
+				Level & level = levels[configuration->inputDepth];
+				int depth = configuration->stackDepth;
+				Entry entry;
+				entry.state = configuration->stateIndexStack[depth];
+				entry.stackDepth = depth;
+				entry.weight = (Weighted ? configuration->weightStack[depth] : 0);
+				entry.symbolStart = level.symbols.size();
+				level.symbols.insert(level.symbols.end(), configuration->outputSymbolStack,
+				                     configuration->outputSymbolStack + depth);
+				level.symbols.insert(level.symbols.end(), configuration->flagValues,
+				                     configuration->flagValues + flagDiacriticFeatureCount);
+				level.entries.push_back(entry);
+			}
+			
+			/**
+			 * Returns true if the current lookup may still have results.
+			 */
+			bool isActive() const {
+				return active;
+			}
+			
+			/**
+			 * Ends the current lookup before all of its results have been found.
+			 */
+			void abandon() {
+				active = false;
+			}
+	};
+} }
+
+#endif
@@ -0,0 +1,139 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "fst/StateIndex.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace libvoikko { namespace fst {
+	
+	void StateIndex::addState(uint32_t stateOffset, uint32_t maxTc, const vector<uint32_t> & inputSymbols) {
+		uint32_t specialCount = count(inputSymbols.begin(), inputSymbols.end(), 0u);
+		if (specialCount > (maxTc + 1) / MAX_SPECIAL_FRACTION) {
+			// every special transition must be visited anyway so indexing would not pay off
+			return;
+		}
+		AcceleratedState state;
+		state.maxTc = maxTc;
+		state.tcStart = nextSpecial.size();
+		nextSpecial.resize(nextSpecial.size() + maxTc + 1, NO_TRANSITION);
+		nextSame.resize(nextSame.size() + maxTc + 1, NO_TRANSITION);
+		
+		vector<pair<uint32_t, uint32_t> > normalTransitions;
+		uint32_t followingSpecial = NO_TRANSITION;
+		for (uint32_t tc = maxTc + 1; tc > 0; tc--) {
+			uint32_t symbol = inputSymbols[tc - 1];
+			if (symbol == 0) {
+				followingSpecial = tc - 1;
+			}
+			else if (symbol != NO_TRANSITION) {
+				normalTransitions.push_back(pair<uint32_t, uint32_t>(symbol, tc - 1));
+			}
+			nextSpecial[state.tcStart + tc - 1] = followingSpecial;
+		}
+		
+		// sorting pairs keeps transitions with the same symbol in file order
+		sort(normalTransitions.begin(), normalTransitions.end());
+		state.symbolStart = symbolRuns.size();
+		for (size_t i = 0; i < normalTransitions.size(); i++) {
+			if (i == 0 || normalTransitions[i].first != normalTransitions[i - 1].first) {
+				SymbolRun run;
+				run.symbol = normalTransitions[i].first;
+				run.start = transitionIndexes.size();
+				run.end = run.start;
+				symbolRuns.push_back(run);
+			}
+			else {
+				nextSame[state.tcStart + normalTransitions[i - 1].second] = normalTransitions[i].second;
+			}
+			transitionIndexes.push_back(normalTransitions[i].second);
+			symbolRuns.back().end++;
+		}
+		state.symbolEnd = symbolRuns.size();
+		
+		stateOffsets.push_back(stateOffset);
+		stateStarts.resize(stateOffset + 1, false);
+		stateStarts[stateOffset] = true;
+		states.push_back(state);
+	}
+	
+	const AcceleratedState * StateIndex::findIndexed(uint32_t stateOffset) const {
+		vector<uint32_t>::const_iterator it = lower_bound(stateOffsets.begin(), stateOffsets.end(), stateOffset);
+		return &states[it - stateOffsets.begin()];
+	}
+	
+	static bool symbolRunLess(const SymbolRun & run, uint32_t symbol) {
+		return run.symbol < symbol;
+	}
+	
+	uint32_t StateCursor::firstWithSymbol(const StateIndex & index, const AcceleratedState * state, uint32_t symbol) {
+		if (symbol == 0 || state->symbolStart == state->symbolEnd) {
+			return NO_TRANSITION;
+		}
+		const SymbolRun * runsBegin = &index.symbolRuns[0] + state->symbolStart;
+		const SymbolRun * runsEnd = &index.symbolRuns[0] + state->symbolEnd;
+		const SymbolRun * run = lower_bound(runsBegin, runsEnd, symbol, symbolRunLess);
+		if (run != runsEnd && run->symbol == symbol) {
+			return index.transitionIndexes[run->start];
+		}
+		return NO_TRANSITION;
+	}
+	
+	void StateCursor::init(const StateIndex & index, const AcceleratedState * state, uint32_t symbol,
+	                       uint32_t variantSymbol) {
+		nextSpecial = &index.nextSpecial[state->tcStart];
+		nextSame = &index.nextSame[state->tcStart];
+		maxTc = state->maxTc;
+		special = nextSpecial[0];
+		matching = firstWithSymbol(index, state, symbol);
+		variant = firstWithSymbol(index, state, variantSymbol);
+		inVariantPhase = false;
+	}
+	
+	void StateCursor::resume(const StateIndex & index, const AcceleratedState * state, uint32_t startTc, uint32_t matching,
+	                         uint32_t variantSymbol, bool inVariantPhase) {
+		nextSpecial = &index.nextSpecial[state->tcStart];
+		nextSame = &index.nextSame[state->tcStart];
+		maxTc = state->maxTc;
+		variant = firstWithSymbol(index, state, variantSymbol);
+		this->inVariantPhase = inVariantPhase;
+		if (inVariantPhase) {
+			special = NO_TRANSITION;
+			this->matching = NO_TRANSITION;
+			// transitions with the same symbol are few, so the position is not saved
+			while (variant < startTc) {
+				variant = nextSame[variant];
+			}
+		}
+		else {
+			special = (startTc <= maxTc ? nextSpecial[startTc] : NO_TRANSITION);
+			this->matching = matching;
+		}
+	}
+} }
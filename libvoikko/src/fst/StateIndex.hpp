@@ -0,0 +1,193 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_STATE_INDEX_H
+#define LIBVOIKKO_FST_STATE_INDEX_H
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Lookup tables for one state with many outgoing transitions.
+	 * Transition indexes are relative to the state head as in
+	 * currentTransitionStack.
+	 */
+	struct AcceleratedState {
+		/** Index of the last transition of this state */
+		uint32_t maxTc;
+		/** Start of the per transition tables of this state in nextSpecial and nextSame */
+		uint32_t tcStart;
+		/** Runs of transitions for each input symbol in symbolRuns, sorted by symbol */
+		uint32_t symbolStart;
+		uint32_t symbolEnd;
+	};
+	
+	struct SymbolRun {
+		uint32_t symbol;
+		/** Indexes of transitions with this input symbol in transitionIndexes */
+		uint32_t start;
+		uint32_t end;
+	};
+	
+	/** Marker for "no such transition" in the per transition tables */
+	const uint32_t NO_TRANSITION = 0xFFFFFFFF;
+	
+	/**
+	 * In-memory index built after loading a transducer that makes it possible
+	 * to find the transitions of a large state that can match the next input
+	 * symbol without scanning all of them. Transitions are still visited in
+	 * the order in which they appear in the transducer file, so lookup results
+	 * stay the same.
+	 */
+	class StateIndex {
+		private:
+			std::vector<uint32_t> stateOffsets;
+			/** Bit for each transition table cell telling whether an indexed state starts there */
+			std::vector<bool> stateStarts;
+			std::vector<AcceleratedState> states;
+			std::vector<SymbolRun> symbolRuns;
+			std::vector<uint32_t> transitionIndexes;
+			/** For each transition index the first epsilon, flag or final transition at or after it */
+			std::vector<uint32_t> nextSpecial;
+			/** For each normal transition the next transition with the same input symbol */
+			std::vector<uint32_t> nextSame;
+			const AcceleratedState * findIndexed(uint32_t stateOffset) const;
+		public:
+			/** States with at least this many transitions are indexed */
+			static const uint32_t MIN_TRANSITIONS = 32;
+			
+			/** States where more than 1/MAX_SPECIAL_FRACTION of transitions are special are not indexed */
+			static const uint32_t MAX_SPECIAL_FRACTION = 4;
+			
+			/**
+			 * Adds a state to the index unless it has too many special transitions.
+			 * States must be added in ascending order of offset.
+			 * @param stateOffset offset of the state in the transition table
+			 * @param maxTc index of the last transition of the state
+			 * @param inputSymbols input symbol of each transition index of the state. Epsilon,
+			 *        flag diacritic and final transitions must be given as 0 and the overflow
+			 *        cell, if any, as NO_TRANSITION.
+			 */
+			void addState(uint32_t stateOffset, uint32_t maxTc, const std::vector<uint32_t> & inputSymbols);
+			
+			/**
+			 * Returns the index for state at given offset or null pointer if
+			 * the state has not been indexed.
+			 */
+			const AcceleratedState * find(uint32_t stateOffset) const {
+				if (stateOffset >= stateStarts.size() || !stateStarts[stateOffset]) {
+					return 0;
+				}
+				return findIndexed(stateOffset);
+			}
+			
+			friend class StateCursor;
+	};
+	
+	/**
+	 * Iterates over the transitions of an indexed state that may match given
+	 * input symbol in ascending order of transition index. When the traversal
+	 * leaves the state, the position of the cursor is saved to
+	 * matchingTransitionStack of the configuration so that it can be resumed
+	 * without searching.
+	 */
+	class StateCursor {
+		private:
+			const uint32_t * nextSpecial;
+			const uint32_t * nextSame;
+			uint32_t maxTc;
+			uint32_t special;
+			uint32_t matching;
+			/** Next transition with the variant symbol, see init */
+			uint32_t variant;
+			/** Whether the other transitions have been visited and only the variant ones remain */
+			bool inVariantPhase;
+			static uint32_t firstWithSymbol(const StateIndex & index, const AcceleratedState * state, uint32_t symbol);
+		public:
+			/**
+			 * Starts iterating over the transitions of a state from the beginning.
+			 * @param symbol next input symbol or 0 if there is no input left
+			 * @param variantSymbol another input symbol whose transitions are visited
+			 *        after all the others or 0 if there is none. This must not be
+			 *        the same as symbol.
+			 */
+			void init(const StateIndex & index, const AcceleratedState * state, uint32_t symbol,
+			          uint32_t variantSymbol = 0);
+			
+			/**
+			 * Continues iterating over the transitions of a state.
+			 * @param startTc index of the first transition to consider
+			 * @param matching value previously returned from following()
+			 * @param variantSymbol same as given to init
+			 * @param inVariantPhase true if the transition before startTc was a variant transition
+			 */
+			void resume(const StateIndex & index, const AcceleratedState * state, uint32_t startTc, uint32_t matching,
+			            uint32_t variantSymbol = 0, bool inVariantPhase = false);
+			
+			/**
+			 * Returns the index of the first candidate transition that is at least tc.
+			 * If there is none, NO_TRANSITION is returned. Successive calls must
+			 * be made with increasing values of tc, except that after the other
+			 * transitions the variant transitions start again from the beginning.
+			 */
+			uint32_t next(uint32_t tc) {
+				if (inVariantPhase) {
+					while (variant < tc) {
+						variant = nextSame[variant];
+					}
+					return variant;
+				}
+				if (special < tc) {
+					special = (tc <= maxTc ? nextSpecial[tc] : NO_TRANSITION);
+				}
+				while (matching < tc) {
+					matching = nextSame[matching];
+				}
+				uint32_t first = (special < matching ? special : matching);
+				if (first == NO_TRANSITION && variant != NO_TRANSITION) {
+					inVariantPhase = true;
+					return variant;
+				}
+				return first;
+			}
+			
+			/**
+			 * Returns the matching transition that follows candidate tc. This needs to
+			 * be saved when the traversal leaves the state through tc. The position
+			 * among the variant transitions is found again on resume.
+			 */
+			uint32_t following(uint32_t tc) const {
+				return matching == tc ? nextSame[tc] : matching;
+			}
+	};
+} }
+
+#endif
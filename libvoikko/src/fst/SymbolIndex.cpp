@@ -0,0 +1,121 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "fst/SymbolIndex.hpp"
+#include "utf8/utf8.hpp"
+#include "utils/Hash.hpp"
+#include <cstring>
+
+using namespace std;
+
+namespace libvoikko { namespace fst {
+	
+	// Characters above this are looked up from the hash table even if they are single code point symbols
+	static const uint32_t MAX_DIRECT_TABLE_SIZE = 0x10000;
+	
+	SymbolIndex::SymbolIndex() :
+		charToSymbol(),
+		hashTable(),
+		hashMask(0),
+		symbolStrings() {
+	}
+	
+	void SymbolIndex::build(const std::map<string, uint16_t> & stringToSymbol,
+	                        const std::vector<const char *> & symbolToString) {
+		symbolStrings = symbolToString;
+		
+		uint32_t tableSize = 1;
+		while (tableSize < 2 * symbolToString.size()) {
+			tableSize *= 2;
+		}
+		hashTable.assign(tableSize, 0);
+		hashMask = tableSize - 1;
+		
+		uint32_t directTableSize = 0;
+		for (std::map<string, uint16_t>::const_iterator it = stringToSymbol.begin(); it != stringToSymbol.end(); ++it) {
+			const string & symbol = it->first;
+			if (symbol.empty()) {
+				continue; // epsilon is never looked up
+			}
+			uint32_t hash = utils::fnvHash(symbol.data(), symbol.length()) & hashMask;
+			while (hashTable[hash]) {
+				hash = (hash + 1) & hashMask;
+			}
+			// store symbol + 1 so that 0 marks an empty slot
+			hashTable[hash] = it->second + 1;
+			
+			const char * sp = symbol.data();
+			uint32_t codePoint = utf8::unchecked::next(sp);
+			if (sp == symbol.data() + symbol.length() && codePoint < MAX_DIRECT_TABLE_SIZE && codePoint >= directTableSize) {
+				directTableSize = codePoint + 1;
+			}
+		}
+		
+		charToSymbol.assign(directTableSize, 0);
+		for (std::map<string, uint16_t>::const_iterator it = stringToSymbol.begin(); it != stringToSymbol.end(); ++it) {
+			const string & symbol = it->first;
+			if (symbol.empty()) {
+				continue;
+			}
+			const char * sp = symbol.data();
+			uint32_t codePoint = utf8::unchecked::next(sp);
+			if (sp == symbol.data() + symbol.length() && codePoint < directTableSize) {
+				charToSymbol[codePoint] = it->second;
+			}
+		}
+	}
+	
+	uint16_t SymbolIndex::findHashed(const char * str, size_t len) const {
+		if (hashTable.empty()) {
+			return 0;
+		}
+		uint32_t hash = utils::fnvHash(str, len) & hashMask;
+		while (hashTable[hash]) {
+			uint16_t symbol = hashTable[hash] - 1;
+			const char * symbolString = symbolStrings[symbol];
+			if (strncmp(symbolString, str, len) == 0 && symbolString[len] == '\0') {
+				return symbol;
+			}
+			hash = (hash + 1) & hashMask;
+		}
+		return 0;
+	}
+	
+	uint16_t SymbolIndex::find(const char * str, size_t len) const {
+		if (len == 0) {
+			return 0;
+		}
+		return findHashed(str, len);
+	}
+	
+	uint16_t SymbolIndex::findCharHashed(uint32_t codePoint) const {
+		char buffer[4];
+		char * end = utf8::unchecked::append(codePoint, buffer);
+		return findHashed(buffer, end - buffer);
+	}
+} }
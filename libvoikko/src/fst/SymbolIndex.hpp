@@ -0,0 +1,85 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_SYMBOL_INDEX_H
+#define LIBVOIKKO_FST_SYMBOL_INDEX_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Index from input characters and symbol strings to symbol numbers. The index
+	 * is built once when the transducer is loaded so that translating input does
+	 * not need to allocate anything. Symbols that consist of a single code point
+	 * are found from a direct table, all other symbols (multichar symbols and
+	 * characters beyond the table) from an open addressing hash table.
+	 */
+	class SymbolIndex {
+		private:
+			std::vector<uint16_t> charToSymbol;
+			std::vector<uint16_t> hashTable;
+			uint32_t hashMask;
+			std::vector<const char *> symbolStrings;
+			uint16_t findHashed(const char * str, size_t len) const;
+			uint16_t findCharHashed(uint32_t codePoint) const;
+		public:
+			SymbolIndex();
+			
+			/**
+			 * Builds the index from symbol table of a transducer.
+			 * @param stringToSymbol map from symbol strings to symbol numbers
+			 * @param symbolToString symbol strings ordered by symbol number
+			 */
+			void build(const std::map<std::string, uint16_t> & stringToSymbol,
+			           const std::vector<const char *> & symbolToString);
+			
+			/**
+			 * Returns the symbol corresponding to given single character or
+			 * 0 if there is no such symbol (symbol 0 is always epsilon).
+			 */
+			uint16_t findChar(uint32_t codePoint) const {
+				if (codePoint < charToSymbol.size()) {
+					return charToSymbol[codePoint];
+				}
+				return findCharHashed(codePoint);
+			}
+			
+			/**
+			 * Returns the symbol corresponding to given UTF-8 encoded
+			 * symbol string or 0 if there is no such symbol.
+			 */
+			uint16_t find(const char * str, size_t len) const;
+	};
+} }
+
+#endif
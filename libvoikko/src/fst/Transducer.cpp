@@ -30,9 +30,15 @@
 #include "fst/Transducer.hpp"
 #include "fst/Configuration.hpp"
 #include "setup/DictionaryException.hpp"
+#include "utils/Checksum.hpp"
 #include "utf8/utf8.hpp"
+#include "voikko_defines.h"
 #include <sys/types.h>
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
 
 #ifdef HAVE_MMAP
 #include <sys/stat.h>
@@ -56,6 +62,9 @@ using namespace std;
 
 namespace libvoikko { namespace fst {
 	
+	Transducer::Transducer() : residencyFlags(0) {
+	}
+	
 	Transducer::~Transducer() {
 	}
 
@@ -160,6 +169,107 @@ namespace libvoikko { namespace fst {
 		#endif
 	}
 	
+	string Transducer::nativeCopyPath(const char * filePath) const {
+		#ifdef HAVE_MMAP
+			// XXX: Not actually thread safe but will most probably work
+			const char * cacheDirectory = getenv("VOIKKO_TRANSDUCER_CACHE");
+			struct stat st;
+			if (!cacheDirectory || !cacheDirectory[0] || stat(filePath, &st) != 0) {
+				return string();
+			}
+			uint64_t checksum = utils::contentChecksum(static_cast<const char *>(map), fileLength);
+			ostringstream path;
+			path << cacheDirectory << "/" << hex << setw(16) << setfill('0') << checksum
+			     << "-" << dec << st.st_mtime << ".vfst";
+			return path.str();
+		#else
+			(void)(filePath);
+			return string();
+		#endif
+	}
+	
+	void * Transducer::openNativeCopy(const string & cachePath) {
+		if (cachePath.empty()) {
+			return 0;
+		}
+		size_t cachedLength = 0;
+		void * cached = vfstMmap(cachePath.c_str(), cachedLength);
+		#ifdef HAVE_MMAP
+			if (cached == MAP_FAILED) {
+				return 0;
+			}
+		#endif
+		if (!cached) {
+			return 0;
+		}
+		bool valid = (cachedLength == fileLength && cachedLength >= 16);
+		if (valid) {
+			try {
+				valid = !checkNeedForByteSwapping(static_cast<char *>(cached));
+			}
+			catch (setup::DictionaryException &) {
+				valid = false;
+			}
+		}
+		if (!valid) {
+			// broken copy, it will be replaced
+			vfstMunmap(cached, cachedLength);
+			return 0;
+		}
+		return cached;
+	}
+	
+	bool Transducer::useNativeCopy(const string & cachePath) {
+		void * cached = openNativeCopy(cachePath);
+		if (!cached) {
+			return false;
+		}
+		DEBUG("Using native byte order copy " << cachePath);
+		vfstMunmap(map, fileLength);
+		map = cached;
+		byteSwapped = false;
+		return true;
+	}
+	
+	void Transducer::storeNativeCopy(const string & cachePath) {
+		#ifdef HAVE_MMAP
+			if (cachePath.empty()) {
+				return;
+			}
+			// Write to a private temporary file first so that concurrent
+			// processes never see a partially written copy.
+			ostringstream tmpPath;
+			tmpPath << cachePath << "." << getpid() << ".tmp";
+			int fd = open(tmpPath.str().c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+			if (fd == -1) {
+				return;
+			}
+			const char * data = static_cast<const char *>(map);
+			size_t written = 0;
+			while (written < fileLength) {
+				ssize_t result = write(fd, data + written, fileLength - written);
+				if (result <= 0) {
+					break;
+				}
+				written += result;
+			}
+			if (close(fd) != 0 || written != fileLength || rename(tmpPath.str().c_str(), cachePath.c_str()) != 0) {
+				unlink(tmpPath.str().c_str());
+				return;
+			}
+			// Replace the private heap copy with the shared mapping of the file
+			// that was just written.
+			void * cached = openNativeCopy(cachePath);
+			if (cached) {
+				delete[] static_cast<char *>(map);
+				map = cached;
+				byteSwapped = false;
+			}
+		#else
+			(void)(cachePath);
+		#endif
+	}
+	
 	bool Transducer::checkNeedForByteSwapping(const char * filePtr) {
 		const uint32_t COOKIE1 = 0x00013A6E;
 		const uint32_t COOKIE2 = 0x000351FA;
@@ -182,6 +292,98 @@ namespace libvoikko { namespace fst {
 		return filePtr[8] == 0x01;
 	}
 	
+	#ifdef HAVE_MMAP
+	/**
+	 * Returns the page aligned range that contains the transducer.
+	 */
+	static void pageRange(void * map, size_t fileLength, char *& start, size_t & length) {
+		size_t pageSize = sysconf(_SC_PAGESIZE);
+		size_t offset = reinterpret_cast<size_t>(map) % pageSize;
+		start = static_cast<char *>(map) - offset;
+		length = fileLength + offset;
+	}
+	#endif
+	
+	bool Transducer::setResidency(int flags) {
+		bool ok = true;
+		#ifdef HAVE_MMAP
+			char * start;
+			size_t length;
+			pageRange(map, fileLength, start, length);
+			if (!byteSwapped) {
+				// Paging hints only make sense for the file mapping, not for a
+				// byte swapped copy in the heap.
+				ok = madvise(start, length, (flags & VOIKKO_RESIDENCY_RANDOM) ? MADV_RANDOM : MADV_NORMAL) == 0 && ok;
+				if (flags & VOIKKO_RESIDENCY_WILLNEED) {
+					ok = madvise(start, length, MADV_WILLNEED) == 0 && ok;
+				}
+				#ifdef MADV_HUGEPAGE
+				if (flags & VOIKKO_RESIDENCY_HUGEPAGE) {
+					ok = madvise(start, length, MADV_HUGEPAGE) == 0 && ok;
+				}
+				else if (residencyFlags & VOIKKO_RESIDENCY_HUGEPAGE) {
+					madvise(start, length, MADV_NOHUGEPAGE);
+				}
+				#else
+				if (flags & VOIKKO_RESIDENCY_HUGEPAGE) {
+					ok = false;
+				}
+				#endif
+			}
+			if (flags & VOIKKO_RESIDENCY_PREFAULT) {
+				// Same effect as MAP_POPULATE but also for a transducer that is
+				// already mapped: read one byte from each page.
+				size_t pageSize = sysconf(_SC_PAGESIZE);
+				volatile char sum = 0;
+				for (size_t pos = 0; pos < length; pos += pageSize) {
+					sum += start[pos];
+				}
+				(void)(sum);
+			}
+			if ((flags & VOIKKO_RESIDENCY_LOCK) && !(residencyFlags & VOIKKO_RESIDENCY_LOCK)) {
+				if (mlock(start, length) != 0) {
+					ok = false;
+					flags &= ~VOIKKO_RESIDENCY_LOCK;
+				}
+			}
+			else if (!(flags & VOIKKO_RESIDENCY_LOCK) && (residencyFlags & VOIKKO_RESIDENCY_LOCK)) {
+				munlock(start, length);
+			}
+		#else
+			if (flags) {
+				ok = false;
+			}
+		#endif
+		residencyFlags = flags;
+		return ok;
+	}
+	
+	void Transducer::getMemoryUsage(size_t & mappedBytes, size_t & residentBytes) const {
+		mappedBytes = fileLength;
+		residentBytes = 0;
+		#if defined(HAVE_MMAP) && defined(__linux__)
+			char * start;
+			size_t length;
+			pageRange(map, fileLength, start, length);
+			size_t pageSize = sysconf(_SC_PAGESIZE);
+			vector<unsigned char> pages((length + pageSize - 1) / pageSize);
+			if (!pages.empty() && mincore(start, length, &pages[0]) == 0) {
+				for (size_t i = 0; i < pages.size(); i++) {
+					if (pages[i] & 1) {
+						residentBytes += pageSize;
+					}
+				}
+				if (residentBytes > fileLength) {
+					residentBytes = fileLength;
+				}
+			}
+		#else
+			if (byteSwapped) {
+				residentBytes = fileLength;
+			}
+		#endif
+	}
+	
 	uint16_t Transducer::getFlagDiacriticFeatureCount() const {
 		return flagDiacriticFeatureCount;
 	}
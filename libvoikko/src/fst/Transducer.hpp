@@ -61,11 +61,37 @@ namespace libvoikko { namespace fst {
 			size_t fileLength;
 			void * map;
 			bool byteSwapped;
+			/** VOIKKO_RESIDENCY_* flags currently applied to the memory of this transducer */
+			int residencyFlags;
 			
 			OpFeatureValue getDiacriticOperation(const std::string & symbol, std::map<std::string, uint16_t> & features, std::map<std::string, uint16_t> & values);
 			void * vfstMmap(const char * filePath, size_t & fileLength);
 			void vfstMunmap(void * map, size_t fileLength);
 			bool checkNeedForByteSwapping(const char * filePtr);
+			
+			/**
+			 * Returns the path of the native byte order copy of a byte swapped
+			 * transducer file in the directory named by environment variable
+			 * VOIKKO_TRANSDUCER_CACHE, or an empty string if there is no cache.
+			 * The name contains a checksum of the mapped file and its modification
+			 * time, so a replaced dictionary gets a new copy.
+			 */
+			std::string nativeCopyPath(const char * filePath) const;
+			void * openNativeCopy(const std::string & cachePath);
+			
+			/**
+			 * Replaces the mapping of a byte swapped transducer with the native
+			 * copy at cachePath, if there is a valid one.
+			 * @return true if the native copy is used
+			 */
+			bool useNativeCopy(const std::string & cachePath);
+			
+			/**
+			 * Writes the byte swapped transducer in memory to cachePath and
+			 * replaces the memory copy with a shared mapping of that file.
+			 * Errors are ignored, the memory copy is kept in that case.
+			 */
+			void storeNativeCopy(const std::string & cachePath);
 			bool isWeightedTransducerFile(const char * filePtr);
 		public:
 			uint16_t flagDiacriticFeatureCount;
@@ -74,8 +100,25 @@ namespace libvoikko { namespace fst {
 			
 			uint16_t getFlagDiacriticFeatureCount() const;
 			
+			/**
+			 * Applies a combination of VOIKKO_RESIDENCY_* flags to the memory
+			 * holding this transducer. Flags that were applied earlier but are
+			 * not set any more are undone where possible.
+			 * @return false if some of the requested operations failed
+			 */
+			bool setResidency(int flags);
+			
+			/**
+			 * Returns the size of the transducer file in memory and how many bytes
+			 * of it are currently resident. Resident size is 0 if it cannot be
+			 * determined on this platform.
+			 */
+			void getMemoryUsage(size_t & mappedBytes, size_t & residentBytes) const;
+			
 			void terminate();
 			
+			Transducer();
+			
 			virtual ~Transducer();
 	};
 } }
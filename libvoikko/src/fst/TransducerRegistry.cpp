@@ -0,0 +1,141 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "porting.h"
+#include "fst/TransducerRegistry.hpp"
+#include "utils/Mutex.hpp"
+#include <map>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace libvoikko::utils;
+
+namespace libvoikko { namespace fst {
+	
+	struct RegistryEntry {
+		Transducer * transducer;
+		string filePath;
+		int referenceCount;
+	};
+	
+	static Mutex registryMutex;
+	static map<string, RegistryEntry> registry;
+	static int residencyFlags = 0;
+	
+	/**
+	 * Returns the registry key for given transducer file. Modification time and size
+	 * are included so that a dictionary that has been replaced on disk is not mixed
+	 * up with the one that is already loaded.
+	 */
+	static string registryKey(const string & filePath, char kind) {
+		ostringstream key;
+		key << kind << ":" << filePath;
+		struct stat st;
+		if (stat(filePath.c_str(), &st) == 0) {
+			key << ":" << st.st_size << ":" << st.st_mtime;
+		}
+		return key.str();
+	}
+	
+	static Transducer * acquire(const string & filePath, char kind) {
+		string key = registryKey(filePath, kind);
+		MutexLocker locker(registryMutex);
+		map<string, RegistryEntry>::iterator it = registry.find(key);
+		if (it != registry.end()) {
+			it->second.referenceCount++;
+			return it->second.transducer;
+		}
+		RegistryEntry entry;
+		if (kind == 'w') {
+			entry.transducer = new WeightedTransducer(filePath.c_str());
+		}
+		else if (kind == 'c') {
+			entry.transducer = new CompactTransducer(filePath.c_str());
+		}
+		else {
+			entry.transducer = new UnweightedTransducer(filePath.c_str());
+		}
+		if (residencyFlags) {
+			entry.transducer->setResidency(residencyFlags);
+		}
+		entry.filePath = filePath;
+		entry.referenceCount = 1;
+		registry[key] = entry;
+		return entry.transducer;
+	}
+	
+	const UnweightedTransducer * TransducerRegistry::acquireUnweighted(const string & filePath) {
+		return static_cast<UnweightedTransducer *>(acquire(filePath, 'u'));
+	}
+	
+	const WeightedTransducer * TransducerRegistry::acquireWeighted(const string & filePath) {
+		return static_cast<WeightedTransducer *>(acquire(filePath, 'w'));
+	}
+	
+	const CompactTransducer * TransducerRegistry::acquireCompact(const string & filePath) {
+		return static_cast<CompactTransducer *>(acquire(filePath, 'c'));
+	}
+	
+	void TransducerRegistry::release(const Transducer * transducer) {
+		MutexLocker locker(registryMutex);
+		for (map<string, RegistryEntry>::iterator it = registry.begin(); it != registry.end(); ++it) {
+			if (it->second.transducer == transducer) {
+				if (--it->second.referenceCount == 0) {
+					it->second.transducer->terminate();
+					delete it->second.transducer;
+					registry.erase(it);
+				}
+				return;
+			}
+		}
+	}
+	
+	bool TransducerRegistry::setResidency(int flags) {
+		MutexLocker locker(registryMutex);
+		residencyFlags = flags;
+		bool ok = true;
+		for (map<string, RegistryEntry>::iterator it = registry.begin(); it != registry.end(); ++it) {
+			ok = it->second.transducer->setResidency(flags) && ok;
+		}
+		return ok;
+	}
+	
+	bool TransducerRegistry::getMemoryUsage(size_t index, string & filePath, size_t & mappedBytes, size_t & residentBytes) {
+		MutexLocker locker(registryMutex);
+		for (map<string, RegistryEntry>::iterator it = registry.begin(); it != registry.end(); ++it) {
+			if (index-- == 0) {
+				filePath = it->second.filePath;
+				it->second.transducer->getMemoryUsage(mappedBytes, residentBytes);
+				return true;
+			}
+		}
+		return false;
+	}
+} }
@@ -0,0 +1,93 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_TRANSDUCER_REGISTRY_H
+#define LIBVOIKKO_FST_TRANSDUCER_REGISTRY_H
+
+#include "fst/UnweightedTransducer.hpp"
+#include "fst/WeightedTransducer.hpp"
+#include "fst/CompactTransducer.hpp"
+#include <string>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Process wide registry of loaded transducers. Components that load the
+	 * same transducer file share one read only copy of it, so creating several
+	 * handles for the same dictionary (for example one for each thread) does
+	 * not load the transducer again. Since all traversal state is kept in
+	 * configurations owned by the callers, a shared transducer may be used
+	 * from several threads at the same time.
+	 */
+	class TransducerRegistry {
+		public:
+			/**
+			 * Returns the unweighted transducer loaded from given file, loading it
+			 * if necessary. The transducer must be released with release().
+			 * @throws setup::DictionaryException if the transducer could not be loaded
+			 */
+			static const UnweightedTransducer * acquireUnweighted(const std::string & filePath);
+			
+			/**
+			 * Returns the weighted transducer loaded from given file, loading it
+			 * if necessary. The transducer must be released with release().
+			 * @throws setup::DictionaryException if the transducer could not be loaded
+			 */
+			static const WeightedTransducer * acquireWeighted(const std::string & filePath);
+			
+			/**
+			 * Returns the compact transducer loaded from given file, loading it
+			 * if necessary. The transducer must be released with release().
+			 * @throws setup::DictionaryException if the transducer could not be loaded
+			 */
+			static const CompactTransducer * acquireCompact(const std::string & filePath);
+			
+			/**
+			 * Releases a transducer returned from one of the acquire methods.
+			 * The transducer is unloaded when it is no longer used by anyone.
+			 */
+			static void release(const Transducer * transducer);
+			
+			/**
+			 * Applies a combination of VOIKKO_RESIDENCY_* flags to all loaded
+			 * transducers and to transducers loaded later.
+			 * @return false if some of the requested operations failed
+			 */
+			static bool setResidency(int flags);
+			
+			/**
+			 * Returns the memory usage of a loaded transducer (see
+			 * Transducer::getMemoryUsage).
+			 * @param index index of the transducer, starting from 0
+			 * @return false if there is no transducer with given index
+			 */
+			static bool getMemoryUsage(size_t index, std::string & filePath, size_t & mappedBytes, size_t & residentBytes);
+	};
+} }
+
+#endif
@@ -0,0 +1,335 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef LIBVOIKKO_FST_TRAVERSAL_H
+#define LIBVOIKKO_FST_TRAVERSAL_H
+
+#include "fst/Transducer.hpp"
+#include "fst/StateIndex.hpp"
+#include "fst/InputSymbolSummary.hpp"
+#include "fst/FlagDiacritics.hpp"
+#include "fst/PrefixFrontier.hpp"
+#include <cstring>
+#include <vector>
+
+namespace libvoikko { namespace fst {
+	
+	/**
+	 * Compile time options for traverse. Each combination is a separate
+	 * instantiation so that the inner loop has no tests for features that
+	 * are not in use.
+	 * 
+	 * - WeightedPaths: path weights are summed on the weight stack of the configuration
+	 * - FlagDiacritics: the transducer has flag diacritic symbols that must be checked
+	 * - PrefixMatch: paths may end before all of the input has been consumed
+	 * - RecordPrefixes: states after consumed input symbols are saved to a PrefixFrontier
+	 * - InputVariants: the first input symbol may also match firstInputVariant of the
+	 *   configuration and paths may skip the last input symbol if lastInputOptional is set
+	 * - CompleteInput: paths consume any input symbols after the input until they have
+	 *   consumed completionLength of the configuration, and the input side of the path
+	 *   is written to the output buffer instead of the output side
+	 */
+	template<bool WeightedPaths, bool FlagDiacritics, bool PrefixMatch, bool RecordPrefixes = false,
+	         bool InputVariants = false, bool CompleteInput = false>
+	struct TraversalPolicy {
+		static const bool weighted = WeightedPaths;
+		static const bool flags = FlagDiacritics;
+		static const bool prefix = PrefixMatch;
+		static const bool record = RecordPrefixes;
+		static const bool variants = InputVariants;
+		static const bool complete = CompleteInput;
+	};
+	
+	/**
+	 * Information about the path returned by traverse.
+	 */
+	struct TraversalResult {
+		/** Sum of the weights on the path (only with WeightedPaths) */
+		int16_t weight;
+		/** Number of input symbols consumed by the path */
+		size_t prefixLength;
+		/** Largest input position reached during this and previous calls */
+		int firstNotReachedPosition;
+		/** Whether traverse returned false because there are no more paths */
+		bool exhausted;
+		/** Whether the path consumed firstInputVariant instead of the first input symbol (only with InputVariants) */
+		bool firstInputVariantUsed;
+	};
+	
+	/**
+	 * Tables used by traverse that are common to all transition formats.
+	 * Each transducer extends this with a cells type that reads its own
+	 * transition records:
+	 * 
+	 * - static const bool OVERFLOW_CELLS: index 1 of states with 255 or more
+	 *   transitions is an overflow cell that must be skipped
+	 * - uint32_t finalSymbol(): input symbol that marks a final state
+	 * - uint32_t maxTc(stateOffset): index of the last transition of a state
+	 * - uint32_t symIn(transition), symOut(transition), targetState(transition)
+	 * - int16_t weight(transition)
+	 */
+	struct TraversalTables {
+		const Transducer * transducer;
+		const StateIndex & stateIndex;
+		const InputSymbolSummary & inputSummary;
+		const std::vector<const char *> & symbolToString;
+		TraversalTables(const Transducer * transducer, const StateIndex & stateIndex,
+		                const InputSymbolSummary & inputSummary, const std::vector<const char *> & symbolToString) :
+			transducer(transducer),
+			stateIndex(stateIndex),
+			inputSummary(inputSummary),
+			symbolToString(symbolToString) {
+		}
+	};
+	
+	/**
+	 * Returns false if an epsilon transition to given target state can be skipped
+	 * because nothing reachable from there can consume the next input symbol.
+	 */
+	template<class Policy, class Config>
+	inline bool targetMayContinue(const InputSymbolSummary & inputSummary, const Config * configuration, uint32_t target) {
+		if (Policy::complete && configuration->inputDepth >= configuration->inputLength) {
+			// any input symbol may follow until the completion is long enough
+			uint64_t required = (configuration->inputDepth < configuration->completionLength ?
+			                     ~InputSymbolSummary::FINAL : InputSymbolSummary::FINAL);
+			return (inputSummary.get(target) & required) != 0;
+		}
+		uint64_t required = (configuration->inputDepth < configuration->inputLength ?
+		                     InputSymbolSummary::symbolBit(configuration->inputSymbolStack[configuration->inputDepth]) :
+		                     InputSymbolSummary::FINAL);
+		if (Policy::prefix) {
+			required |= InputSymbolSummary::FINAL;
+		}
+		if (Policy::variants) {
+			if (configuration->inputDepth == 0 && configuration->firstInputVariant) {
+				required |= InputSymbolSummary::symbolBit(configuration->firstInputVariant);
+			}
+			if (configuration->lastInputOptional && configuration->inputDepth + 1 == configuration->inputLength) {
+				required |= InputSymbolSummary::FINAL;
+			}
+		}
+		return (inputSummary.get(target) & required) != 0;
+	}
+	
+	/**
+	 * Depth first traversal shared by all transducer formats. Continues from
+	 * the state stored in configuration and returns true when the next path
+	 * matching the input has been found. The output of the path is written to
+	 * outputBuffer and the rest of the information about it to result.
+	 * With RecordPrefixes the states after consumed input symbols are saved
+	 * to frontier.
+	 */
+	template<class Policy, class Cells, class Config>
+	bool traverse(const Cells & cells, Config * configuration, char * outputBuffer, size_t bufferLen,
+	              TraversalResult & result, PrefixFrontier * frontier = 0) {
+		const uint32_t firstNormalChar = cells.transducer->firstNormalChar;
+		const uint32_t finalSymbol = cells.finalSymbol();
+		uint32_t loopCounter = 0;
+		uint32_t lastIndexedOffset = NO_TRANSITION;
+		const AcceleratedState * lastIndexed = 0;
+		StateCursor cursor;
+		result.firstNotReachedPosition = configuration->inputDepth;
+		result.exhausted = false;
+		while (loopCounter < MAX_LOOP_COUNT) {
+			uint32_t stateOffset = configuration->stateIndexStack[configuration->stackDepth];
+			uint32_t startTransitionIndex = configuration->currentTransitionStack[configuration->stackDepth] - stateOffset;
+			uint32_t maxTc = cells.maxTc(stateOffset);
+			const AcceleratedState * accelerated = 0;
+			// the state index cannot skip transitions when any input symbol is accepted
+			if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS &&
+			    !(Policy::complete && configuration->inputDepth >= configuration->inputLength)) {
+				if (stateOffset != lastIndexedOffset) {
+					lastIndexed = cells.stateIndex.find(stateOffset);
+					lastIndexedOffset = stateOffset;
+				}
+				accelerated = lastIndexed;
+			}
+			if (accelerated) {
+				// Transitions with the first input symbol are visited before those with its variant
+				uint32_t variantSymbol = (Policy::variants && configuration->inputDepth == 0 &&
+				                          configuration->firstInputVariant != configuration->inputSymbolStack[0] ?
+				                          configuration->firstInputVariant : 0);
+				if (startTransitionIndex == 0) {
+					cursor.init(cells.stateIndex, accelerated, configuration->inputDepth < configuration->inputLength ?
+					            configuration->inputSymbolStack[configuration->inputDepth] : 0, variantSymbol);
+				}
+				else {
+					cursor.resume(cells.stateIndex, accelerated, startTransitionIndex,
+					              configuration->matchingTransitionStack[configuration->stackDepth], variantSymbol,
+					              variantSymbol && cells.symIn(stateOffset + startTransitionIndex - 1) == variantSymbol);
+				}
+			}
+			for (uint32_t tc = startTransitionIndex; tc <= maxTc; tc++) {
+				if (accelerated) {
+					// only visit transitions that can match
+					tc = cursor.next(tc);
+					if (tc > maxTc) {
+						break;
+					}
+				}
+				else if (Cells::OVERFLOW_CELLS && tc == 1 && maxTc >= 255) {
+					// skip overflow cell
+					tc++;
+				}
+				uint32_t transition = stateOffset + tc;
+				uint32_t symIn = cells.symIn(transition);
+				if (symIn == finalSymbol) {
+					// final state
+					if (Policy::prefix ||
+					    configuration->inputDepth == (Policy::complete ? configuration->completionLength :
+					                                                     configuration->inputLength) ||
+					    (Policy::variants && configuration->lastInputOptional &&
+					     configuration->inputDepth + 1 == configuration->inputLength)) {
+						char * outputBufferPos = outputBuffer;
+						for (int i = 0; i < configuration->stackDepth; i++) {
+							uint32_t symbol = configuration->outputSymbolStack[i];
+							if (Policy::complete) {
+								symbol = cells.symIn(configuration->currentTransitionStack[i]);
+								if (symbol < firstNormalChar) {
+									continue;
+								}
+							}
+							const char * outputSym = cells.symbolToString[symbol];
+							size_t symLen = strlen(outputSym);
+							if ((outputBufferPos - outputBuffer) + symLen + 1 >= bufferLen) {
+								// would overflow the output buffer
+								return false;
+							}
+							strncpy(outputBufferPos, outputSym, symLen);
+							outputBufferPos += symLen;
+						}
+						*outputBufferPos = '\0';
+						configuration->currentTransitionStack[configuration->stackDepth] = transition + 1;
+						if (accelerated) {
+							configuration->matchingTransitionStack[configuration->stackDepth] = cursor.following(tc);
+						}
+						result.prefixLength = configuration->inputDepth;
+						if (Policy::variants) {
+							result.firstInputVariantUsed = false;
+							for (int i = 0; i < configuration->stackDepth; i++) {
+								uint32_t consumed = cells.symIn(configuration->currentTransitionStack[i]);
+								if (consumed >= firstNormalChar) {
+									result.firstInputVariantUsed = (consumed == configuration->firstInputVariant);
+									break;
+								}
+							}
+						}
+						if (Policy::weighted) {
+							result.weight = static_cast<int16_t>(configuration->weightStack[configuration->stackDepth] +
+							                                     cells.weight(transition));
+						}
+						return true;
+					}
+				}
+				else if (((configuration->inputDepth < configuration->inputLength &&
+					  configuration->inputSymbolStack[configuration->inputDepth] == symIn) ||
+					  (Policy::variants && configuration->inputDepth == 0 && configuration->inputLength > 0 &&
+					  symIn == configuration->firstInputVariant && symIn >= firstNormalChar) ||
+					  (Policy::complete && configuration->inputDepth >= configuration->inputLength &&
+					  configuration->inputDepth < configuration->completionLength && symIn >= firstNormalChar) ||
+					  (symIn < firstNormalChar &&
+					  targetMayContinue<Policy>(cells.inputSummary, configuration, cells.targetState(transition)))) &&
+					  (!Policy::flags || flagDiacriticCheck(configuration, cells.transducer, symIn))) {
+					// down
+					if (configuration->stackDepth + 2 == configuration->bufferSize) {
+						// max stack depth reached
+						return false;
+					}
+					uint32_t symOut = cells.symOut(transition);
+					configuration->outputSymbolStack[configuration->stackDepth] = (symOut >= firstNormalChar ? symOut : 0);
+					configuration->currentTransitionStack[configuration->stackDepth] = transition;
+					if (accelerated) {
+						configuration->matchingTransitionStack[configuration->stackDepth] = cursor.following(tc);
+					}
+					if (Policy::weighted) {
+						configuration->weightStack[configuration->stackDepth + 1] =
+							configuration->weightStack[configuration->stackDepth] + cells.weight(transition);
+					}
+					configuration->stackDepth++;
+					uint32_t target = cells.targetState(transition);
+					configuration->stateIndexStack[configuration->stackDepth] = target;
+					configuration->currentTransitionStack[configuration->stackDepth] = target;
+					if (symIn >= firstNormalChar) {
+						configuration->inputDepth++;
+						if (result.firstNotReachedPosition < configuration->inputDepth) {
+							result.firstNotReachedPosition = configuration->inputDepth;
+						}
+						if (Policy::record) {
+							frontier->record<Policy::weighted>(configuration);
+						}
+					}
+					goto nextInMainLoop;
+				}
+			}
+			if (configuration->stackDepth == configuration->baseDepth) {
+				// end
+				result.exhausted = true;
+				return false;
+			}
+			// up
+			configuration->stackDepth--;
+			{
+				uint32_t previousInputSymbol = cells.symIn(configuration->currentTransitionStack[configuration->stackDepth]);
+				if (previousInputSymbol >= firstNormalChar) {
+					configuration->inputDepth--;
+				}
+				else if (Policy::flags) {
+					flagDiacriticUndo(configuration, cells.transducer, previousInputSymbol);
+				}
+			}
+			configuration->currentTransitionStack[configuration->stackDepth]++;
+			nextInMainLoop:
+			loopCounter++;
+		}
+		// maximum number of loops reached
+		return false;
+	}
+	
+	/**
+	 * Like traverse but continues from the states saved in frontier for the
+	 * prefix that the input shares with the previous input, and saves the
+	 * states of longer prefixes for the next input (see PrefixFrontier).
+	 */
+	template<class Policy, class Cells, class Config>
+	bool traverseBatch(const Cells & cells, Config * configuration, PrefixFrontier * frontier,
+	                   char * outputBuffer, size_t bufferLen, TraversalResult & result) {
+		while (frontier->isActive()) {
+			if (traverse<Policy>(cells, configuration, outputBuffer, bufferLen, result, frontier)) {
+				return true;
+			}
+			if (!result.exhausted) {
+				frontier->abandon();
+				return false;
+			}
+			frontier->resumeNext(configuration);
+		}
+		return false;
+	}
+} }
+
+#endif
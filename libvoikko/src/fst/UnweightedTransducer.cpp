@@ -29,6 +29,7 @@
 #include "porting.h"
 #include "fst/UnweightedTransducer.hpp"
 #include "fst/Configuration.hpp"
+#include "fst/Traversal.hpp"
 #include "setup/DictionaryException.hpp"
 #include "utf8/utf8.hpp"
 #include <sys/types.h>
@@ -67,10 +68,57 @@ namespace libvoikko { namespace fst {
 			(x<<24);
 	}
 	
+	static uint32_t getMaxTc(const Transition * stateHead) {
+		uint32_t maxTc = stateHead->transInfo.moreTransitions;
+		if (maxTc == 255) {
+			const OverflowCell * oc = reinterpret_cast<const OverflowCell *>(stateHead + 1);
+			maxTc = oc->moreTransitions + 1;
+		}
+		return maxTc;
+	}
+	
+	/**
+	 * Access to the transitions of the original format for traverse.
+	 */
+	struct UnweightedCells : public TraversalTables {
+		static const bool OVERFLOW_CELLS = true;
+		const Transition * transitionStart;
+		UnweightedCells(const Transducer * transducer, const StateIndex & stateIndex, const InputSymbolSummary & inputSummary,
+		                const std::vector<const char *> & symbolToString, const Transition * transitionStart) :
+			TraversalTables(transducer, stateIndex, inputSummary, symbolToString),
+			transitionStart(transitionStart) {
+		}
+		uint32_t finalSymbol() const {
+			return 0xFFFF;
+		}
+		uint32_t maxTc(uint32_t stateOffset) const {
+			return getMaxTc(transitionStart + stateOffset);
+		}
+		uint32_t symIn(uint32_t transition) const {
+			return transitionStart[transition].symIn;
+		}
+		uint32_t symOut(uint32_t transition) const {
+			return transitionStart[transition].symOut;
+		}
+		uint32_t targetState(uint32_t transition) const {
+			return transitionStart[transition].transInfo.targetState;
+		}
+		int16_t weight(uint32_t) const {
+			return 0;
+		}
+	};
+	
 	void UnweightedTransducer::byteSwapTransducer(void *& mapPtr, size_t fileLength) {
 		DEBUG("Byte-swapping the transducer");
 		char * newMap = new char[fileLength];
-		// skip header
+		// copy header with the cookies in native byte order
+		memcpy(newMap, mapPtr, 16);
+		for (int i = 0; i < 2; i++) {
+			uint32_t cookie;
+			memcpy(&cookie, newMap + i * sizeof(uint32_t), sizeof(uint32_t));
+			cookie = swap(cookie);
+			memcpy(newMap + i * sizeof(uint32_t), &cookie, sizeof(uint32_t));
+		}
 		char * oldMapPtr = static_cast<char *>(mapPtr) + 16;
 		char * newMapPtr = newMap + 16;
 		
@@ -131,7 +179,11 @@ namespace libvoikko { namespace fst {
 			throw setup::DictionaryException("Expected unweighted but got weighted transducer");
 		}
 		if (byteSwapped) {
-			byteSwapTransducer(map, fileLength);
+			string nativeCopy = nativeCopyPath(filePath);
+			if (!useNativeCopy(nativeCopy)) {
+				byteSwapTransducer(map, fileLength);
+				storeNativeCopy(nativeCopy);
+			}
 		}
 		char * filePtr = static_cast<char *>(map);
 		
@@ -142,6 +194,7 @@ namespace libvoikko { namespace fst {
 		
 		firstNormalChar = 0;
 		firstMultiChar = 0;
+		std::map<string, uint16_t> stringToSymbol;
 		std::map<string, uint16_t> features;
 		std::map<string, uint16_t> values;
 		values[""] = FlagValueNeutral;
@@ -163,6 +216,7 @@ namespace libvoikko { namespace fst {
 				symbolToDiacritic.push_back(getDiacriticOperation(symbol, features, values));
 			}
 		}
+		symbolIndex.build(stringToSymbol, symbolToString);
 		unknownSymbolOrdinal = symbolCount;
 		flagDiacriticFeatureCount = features.size();
 		{
@@ -173,184 +227,136 @@ namespace libvoikko { namespace fst {
 			}
 		}
 		transitionStart = reinterpret_cast<Transition *>(filePtr);
+		buildStateIndex();
+	}
+	
+	void UnweightedTransducer::buildStateIndex() {
+		uint32_t cellCount = (static_cast<char *>(map) + fileLength - reinterpret_cast<char *>(transitionStart)) / sizeof(Transition);
+		uint32_t stateOffset = 0;
+		while (stateOffset < cellCount) {
+			Transition * stateHead = transitionStart + stateOffset;
+			uint32_t maxTc = getMaxTc(stateHead);
+			uint64_t ownSummary = 0;
+			bool hasEpsilons = false;
+			for (uint32_t tc = 0; tc <= maxTc; tc++) {
+				uint16_t symIn = (stateHead + tc)->symIn;
+				if (tc == 1 && maxTc >= 255) {
+					continue; // overflow cell
+				}
+				if (symIn == 0xFFFF) {
+					ownSummary |= InputSymbolSummary::FINAL;
+				}
+				else if (symIn < firstNormalChar) {
+					hasEpsilons = true;
+				}
+				else {
+					ownSummary |= InputSymbolSummary::symbolBit(symIn);
+				}
+			}
+			inputSummary.addState(stateOffset, ownSummary);
+			for (uint32_t tc = 0; hasEpsilons && tc <= maxTc; tc++) {
+				Transition * transition = stateHead + tc;
+				if (!(tc == 1 && maxTc >= 255) && transition->symIn < firstNormalChar) {
+					inputSummary.addEpsilonTransition(transition->transInfo.targetState);
+				}
+			}
+			if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS) {
+				vector<uint32_t> inputSymbols(maxTc + 1);
+				for (uint32_t tc = 0; tc <= maxTc; tc++) {
+					uint32_t symIn = (stateHead + tc)->symIn;
+					if (tc == 1 && maxTc >= 255) {
+						inputSymbols[tc] = NO_TRANSITION; // overflow cell
+					}
+					else if (symIn == 0xFFFF || symIn < firstNormalChar) {
+						inputSymbols[tc] = 0;
+					}
+					else {
+						inputSymbols[tc] = symIn;
+					}
+				}
+				stateIndex.addState(stateOffset, maxTc, inputSymbols);
+			}
+			stateOffset += maxTc + 1;
+		}
+		inputSummary.build(cellCount);
 	}
 	
 	bool UnweightedTransducer::prepare(Configuration * configuration, const char * input, size_t inputLen) const {
 		configuration->stackDepth = 0;
+		configuration->baseDepth = 0;
 		configuration->inputDepth = 0;
 		configuration->stateIndexStack[0] = 0;
 		configuration->currentTransitionStack[0] = 0;
+		if (flagDiacriticFeatureCount) {
+			memset(configuration->flagValues, 0, flagDiacriticFeatureCount * sizeof(uint16_t));
+		}
 		configuration->inputLength = 0;
 		const char * ip = input;
 		bool allKnown = true;
 		while (ip < input + inputLen) {
-			const char * prevIp = ip;
-			utf8::unchecked::next(ip);
-			std::map<std::string,uint16_t>::const_iterator it = stringToSymbol.find(string(prevIp, ip - prevIp));
-			if (it == stringToSymbol.end()) {
+			uint16_t symbol = symbolIndex.findChar(utf8::unchecked::next(ip));
+			if (symbol == 0) {
 				configuration->inputSymbolStack[configuration->inputLength] = unknownSymbolOrdinal;
 				allKnown = false;
 			}
 			else {
-				configuration->inputSymbolStack[configuration->inputLength] = it->second;
+				configuration->inputSymbolStack[configuration->inputLength] = symbol;
 			}
 			configuration->inputLength++;
 		}
 		return allKnown;
 	}
 	
-	static uint32_t getMaxTc(Transition * stateHead) {
-		uint32_t maxTc = stateHead->transInfo.moreTransitions;
-		if (maxTc == 255) {
-			OverflowCell * oc = reinterpret_cast<OverflowCell *>(stateHead + 1);
-			maxTc = oc->moreTransitions + 1;
-		}
-		return maxTc;
+	bool UnweightedTransducer::next(Configuration * configuration, char * outputBuffer, size_t bufferLen) const {
+		return nextPrefix(configuration, outputBuffer, bufferLen, 0);
 	}
 	
-	static bool flagDiacriticCheck(Configuration * configuration, const Transducer * transducer, uint16_t symbol) {
-		uint16_t flagDiacriticFeatureCount = transducer->flagDiacriticFeatureCount;
-		if (!flagDiacriticFeatureCount) {
-			return true;
-		}
-		int stackDepth = configuration->stackDepth;
-		size_t diacriticCell = flagDiacriticFeatureCount * sizeof(uint16_t);
-		uint16_t * flagValueStack = configuration->flagValueStack;
-		uint16_t * currentFlagArray = flagValueStack + stackDepth * flagDiacriticFeatureCount;
-		
-		bool update = false;
-		OpFeatureValue ofv;
-		if (symbol != 0 && symbol < transducer->firstNormalChar) {
-			ofv = transducer->symbolToDiacritic[symbol];
-			uint16_t currentValue = currentFlagArray[ofv.feature];
-			DEBUG("checking op " << ofv.op << " " << ofv.feature << " " << ofv.value << " current value " << currentValue)
-			switch (ofv.op) {
-				case Operation_P:
-					update = true;
-					break;
-				case Operation_C:
-					ofv.value = FlagValueNeutral;
-					update = true;
-					break;
-				case Operation_U:
-					if (currentValue) {
-						if (currentValue != ofv.value) {
-							return false;
-						}
-					}
-					else {
-						update = true;
-					}
-					break;
-				case Operation_R:
-					if (ofv.value == FlagValueAny && currentValue == FlagValueNeutral) {
-						return false;
-					}
-					if (ofv.value != FlagValueAny && currentValue != ofv.value) {
-						return false;
-					}
-					break;
-				case Operation_D:
-					if ((ofv.value == FlagValueAny && currentValue != FlagValueNeutral) || currentValue == ofv.value) {
-						return false;
-					}
-					break;
-				default:
-					return false;// this would be an error
+	bool UnweightedTransducer::nextPrefix(Configuration * configuration, char * outputBuffer, size_t bufferLen, size_t * prefixLength) const {
+		UnweightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		bool flags = (firstNormalChar > 1);
+		if (prefixLength) {
+			bool found = (flags ?
+				traverse< TraversalPolicy<false, true, true> >(cells, configuration, outputBuffer, bufferLen, result) :
+				traverse< TraversalPolicy<false, false, true> >(cells, configuration, outputBuffer, bufferLen, result));
+			if (found) {
+				*prefixLength = result.prefixLength;
 			}
-			DEBUG("allowed")
+			return found;
 		}
-		
-		memcpy(currentFlagArray + flagDiacriticFeatureCount, currentFlagArray, diacriticCell);
-		if (update) {
-			DEBUG("updating feature " << ofv.feature << " to " << ofv.value)
-			(currentFlagArray + flagDiacriticFeatureCount)[ofv.feature] = ofv.value;
+		return flags ?
+			traverse< TraversalPolicy<false, true, false> >(cells, configuration, outputBuffer, bufferLen, result) :
+			traverse< TraversalPolicy<false, false, false> >(cells, configuration, outputBuffer, bufferLen, result);
+	}
+	
+	bool UnweightedTransducer::prepare(Configuration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const {
+		if (!prepare(configuration, input, inputLen)) {
+			return false;
 		}
+		frontier->start(configuration);
 		return true;
 	}
 	
-	bool UnweightedTransducer::next(Configuration * configuration, char * outputBuffer, size_t bufferLen) const {
-		return nextPrefix(configuration, outputBuffer, bufferLen, 0);
+	bool UnweightedTransducer::next(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen) const {
+		UnweightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		return firstNormalChar > 1 ?
+			traverseBatch< TraversalPolicy<false, true, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result) :
+			traverseBatch< TraversalPolicy<false, false, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result);
 	}
 	
-	bool UnweightedTransducer::nextPrefix(Configuration * configuration, char * outputBuffer, size_t bufferLen, size_t * prefixLength) const {
-		uint32_t loopCounter = 0;
-		while (loopCounter < MAX_LOOP_COUNT) {
-			Transition * stateHead = transitionStart + configuration->stateIndexStack[configuration->stackDepth];
-			Transition * currentTransition = transitionStart + configuration->currentTransitionStack[configuration->stackDepth];
-			uint32_t startTransitionIndex = currentTransition - stateHead;
-			uint32_t maxTc = getMaxTc(stateHead);
-			for (uint32_t tc = startTransitionIndex; tc <= maxTc; tc++) {
-				if (tc == 1 && maxTc >= 255) {
-					// skip overflow cell
-					tc++;
-					currentTransition++;
-				}
-				// next
-				if (currentTransition->symIn == 0xFFFF) {
-					// final state
-					if (configuration->inputDepth == configuration->inputLength || prefixLength) {
-						char * outputBufferPos = outputBuffer;
-						for (int i = 0; i < configuration->stackDepth; i++) {
-							const char * outputSym = symbolToString[configuration->outputSymbolStack[i]];
-							size_t symLen = strlen(outputSym);
-							if ((outputBufferPos - outputBuffer) + symLen + 1 >= bufferLen) {
-								// would overflow the output buffer
-								return false;
-							}
-							strncpy(outputBufferPos, outputSym, symLen);
-							outputBufferPos += symLen;
-						}
-						*outputBufferPos = '\0';
-						configuration->currentTransitionStack[configuration->stackDepth] = currentTransition - transitionStart + 1;
-						if (prefixLength) {
-							*prefixLength = configuration->inputDepth;
-						}
-						return true;
-					}
-				}
-				else if (((configuration->inputDepth < configuration->inputLength &&
-					  configuration->inputSymbolStack[configuration->inputDepth] == currentTransition->symIn) ||
-					  currentTransition->symIn < firstNormalChar) &&
-					  flagDiacriticCheck(configuration, this, currentTransition->symIn)) {
-					// down
-					DEBUG("down " << tc)
-					if (configuration->stackDepth + 2 == configuration->bufferSize) {
-						// max stack depth reached
-						return false;
-					}
-					configuration->outputSymbolStack[configuration->stackDepth] = 
-						(currentTransition->symOut >= firstNormalChar ? currentTransition->symOut : 0);
-					configuration->currentTransitionStack[configuration->stackDepth] = currentTransition - transitionStart;
-					configuration->stackDepth++;
-					configuration->stateIndexStack[configuration->stackDepth] = currentTransition->transInfo.targetState;
-					configuration->currentTransitionStack[configuration->stackDepth] = currentTransition->transInfo.targetState;
-					if (currentTransition->symIn >= firstNormalChar) {
-						configuration->inputDepth++;
-					}
-					goto nextInMainLoop;
-				}
-				currentTransition++;
-			}
-			if (configuration->stackDepth == 0) {
-				// end
-				return false;
-			}
-			// up
-			configuration->stackDepth--;
-			DEBUG("up")
-			{
-				uint16_t previousInputSymbol = (transitionStart + configuration->currentTransitionStack[configuration->stackDepth])->symIn;
-				if (previousInputSymbol >= firstNormalChar) {
-					configuration->inputDepth--;
-				}
-			}
-			configuration->currentTransitionStack[configuration->stackDepth]++;
-			nextInMainLoop:
-			loopCounter++;
-		}
-		DEBUG("maximum number of loops reached")
-		return false;
+	bool UnweightedTransducer::prepareCompletions(Configuration * configuration, const char * input, size_t inputLen,
+	                                              size_t completionLength) const {
+		configuration->completionLength = completionLength;
+		return prepare(configuration, input, inputLen);
+	}
+	
+	bool UnweightedTransducer::nextCompletion(Configuration * configuration, char * outputBuffer, size_t bufferLen) const {
+		UnweightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		return firstNormalChar > 1 ?
+			traverse< TraversalPolicy<false, true, false, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result) :
+			traverse< TraversalPolicy<false, false, false, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result);
 	}
 	
 } }
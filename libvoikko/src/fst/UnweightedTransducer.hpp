@@ -31,19 +31,26 @@
 #define LIBVOIKKO_FST_UNWEIGHTED_TRANSDUCER_H
 
 #include "fst/Transducer.hpp"
+#include "fst/SymbolIndex.hpp"
+#include "fst/StateIndex.hpp"
+#include "fst/InputSymbolSummary.hpp"
 #include "fst/Transition.hpp"
 #include "fst/Configuration.hpp"
+#include "fst/PrefixFrontier.hpp"
 
 namespace libvoikko { namespace fst {
 	
 	class UnweightedTransducer : public Transducer {
 		private:
 			Transition * transitionStart;
-			std::map<std::string, uint16_t> stringToSymbol;
+			SymbolIndex symbolIndex;
+			StateIndex stateIndex;
+			InputSymbolSummary inputSummary;
 			std::vector<const char *> symbolToString;
 			uint16_t firstMultiChar;
 			uint16_t unknownSymbolOrdinal;
 			void byteSwapTransducer(void *& mapPtr, size_t fileLength);
+			void buildStateIndex();
 		public:
 			UnweightedTransducer(const char * filePath);
 			
@@ -52,6 +59,31 @@ namespace libvoikko { namespace fst {
 			bool next(Configuration * configuration, char * outputBuffer, size_t bufferLen) const;
 			
 			bool nextPrefix(Configuration * configuration, char * outputBuffer, size_t bufferLen, size_t * prefixLength) const;
+			
+			/**
+			 * Like prepare but the lookup continues from the states that frontier
+			 * has saved for the prefix shared with the previous input. Results must
+			 * then be read with the next method that takes the same frontier.
+			 */
+			bool prepare(Configuration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const;
+			
+			bool next(Configuration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen) const;
+			
+			/**
+			 * Prepares the configuration for listing the input sides of paths whose
+			 * input begins with given input and has completionLength symbols in
+			 * total. The input sides are then read with nextCompletion.
+			 * @return false if the input contains unknown symbols
+			 */
+			bool prepareCompletions(Configuration * configuration, const char * input, size_t inputLen,
+			                        size_t completionLength) const;
+			
+			/**
+			 * Writes the input side of the next path found for prepareCompletions
+			 * to outputBuffer. The same input side is returned for each path that
+			 * has it.
+			 */
+			bool nextCompletion(Configuration * configuration, char * outputBuffer, size_t bufferLen) const;
 	};
 } }
 
@@ -38,25 +38,35 @@ namespace libvoikko { namespace fst {
 	WeightedConfiguration::WeightedConfiguration(uint32_t flagDiacriticFeatureCount, int bufferSize) :
 		bufferSize(bufferSize),
 		stackDepth(0),
+		baseDepth(0),
 		inputDepth(0),
 		stateIndexStack(new uint32_t[bufferSize]),
 		currentTransitionStack(new uint32_t[bufferSize]),
+		matchingTransitionStack(new uint32_t[bufferSize]),
+		weightStack(new int32_t[bufferSize]),
 		inputSymbolStack(new uint32_t[bufferSize]),
 		outputSymbolStack(new uint32_t[bufferSize]),
-		flagValueStack(flagDiacriticFeatureCount ? new uint32_t[flagDiacriticFeatureCount * bufferSize] : 0),
-		inputLength(0)
+		flagValues(flagDiacriticFeatureCount ? new uint32_t[flagDiacriticFeatureCount] : 0),
+		flagUndoStack(flagDiacriticFeatureCount ? new uint32_t[bufferSize] : 0),
+		inputLength(0),
+		firstInputVariant(0),
+		lastInputOptional(false),
+		completionLength(0)
 		{
+			weightStack[0] = 0;
 			if (flagDiacriticFeatureCount) {
-				// initialize flag values for initial state (these are immutable)
-				memset(flagValueStack, 0, flagDiacriticFeatureCount * sizeof(uint32_t));
+				memset(flagValues, 0, flagDiacriticFeatureCount * sizeof(uint32_t));
 			}
 		}
 	
 	WeightedConfiguration::~WeightedConfiguration() {
 		delete[] stateIndexStack;
 		delete[] currentTransitionStack;
+		delete[] matchingTransitionStack;
+		delete[] weightStack;
 		delete[] inputSymbolStack;
 		delete[] outputSymbolStack;
-		delete[] flagValueStack;
+		delete[] flagValues;
+		delete[] flagUndoStack;
 	}
 } }
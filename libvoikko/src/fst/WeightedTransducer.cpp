@@ -29,10 +29,13 @@
 #include "porting.h"
 #include "fst/WeightedTransducer.hpp"
 #include "fst/Configuration.hpp"
+#include "fst/Traversal.hpp"
 #include "setup/DictionaryException.hpp"
 #include "utf8/utf8.hpp"
 #include <sys/types.h>
 #include <cstring>
+#include <algorithm>
+#include <queue>
 
 #ifdef HAVE_MMAP
 #include <sys/stat.h>
@@ -62,7 +65,7 @@ namespace libvoikko { namespace fst {
 	}
 	
 	static int16_t swap(int16_t x) {
-		return (x>>8) | (x<<8);
+		return static_cast<int16_t>(swap(static_cast<uint16_t>(x)));
 	}
 	
 	static uint32_t swap(uint32_t x) {
@@ -72,10 +75,57 @@ namespace libvoikko { namespace fst {
 			(x<<24);
 	}
 	
+	static uint32_t getMaxTc(const WeightedTransition * stateHead) {
+		uint32_t maxTc = stateHead->moreTransitions;
+		if (maxTc == 255) {
+			const WeightedOverflowCell * oc = reinterpret_cast<const WeightedOverflowCell *>(stateHead + 1);
+			maxTc = oc->moreTransitions + 1;
+		}
+		return maxTc;
+	}
+	
+	/**
+	 * Access to the transitions of the original weighted format for traverse.
+	 */
+	struct WeightedCells : public TraversalTables {
+		static const bool OVERFLOW_CELLS = true;
+		const WeightedTransition * transitionStart;
+		WeightedCells(const Transducer * transducer, const StateIndex & stateIndex, const InputSymbolSummary & inputSummary,
+		              const std::vector<const char *> & symbolToString, const WeightedTransition * transitionStart) :
+			TraversalTables(transducer, stateIndex, inputSummary, symbolToString),
+			transitionStart(transitionStart) {
+		}
+		uint32_t finalSymbol() const {
+			return 0xFFFFFFFF;
+		}
+		uint32_t maxTc(uint32_t stateOffset) const {
+			return getMaxTc(transitionStart + stateOffset);
+		}
+		uint32_t symIn(uint32_t transition) const {
+			return transitionStart[transition].symIn;
+		}
+		uint32_t symOut(uint32_t transition) const {
+			return transitionStart[transition].symOut;
+		}
+		uint32_t targetState(uint32_t transition) const {
+			return transitionStart[transition].targetState;
+		}
+		int16_t weight(uint32_t transition) const {
+			return transitionStart[transition].weight;
+		}
+	};
+	
 	void WeightedTransducer::byteSwapTransducer(void *& mapPtr, size_t fileLength) {
 		DEBUG("Byte-swapping the transducer");
 		char * newMap = new char[fileLength];
-		// skip header
+		// copy header with the cookies in native byte order
+		memcpy(newMap, mapPtr, 16);
+		for (int i = 0; i < 2; i++) {
+			uint32_t cookie;
+			memcpy(&cookie, newMap + i * sizeof(uint32_t), sizeof(uint32_t));
+			cookie = swap(cookie);
+			memcpy(newMap + i * sizeof(uint32_t), &cookie, sizeof(uint32_t));
+		}
 		char * oldMapPtr = static_cast<char *>(mapPtr) + 16;
 		char * newMapPtr = newMap + 16;
 		
@@ -137,7 +187,11 @@ namespace libvoikko { namespace fst {
 			throw setup::DictionaryException("Expected weighted but got unweighted transducer");
 		}
 		if (byteSwapped) {
-			byteSwapTransducer(map, fileLength);
+			string nativeCopy = nativeCopyPath(filePath);
+			if (!useNativeCopy(nativeCopy)) {
+				byteSwapTransducer(map, fileLength);
+				storeNativeCopy(nativeCopy);
+			}
 		}
 		char * filePtr = static_cast<char *>(map);
 		
@@ -148,6 +202,7 @@ namespace libvoikko { namespace fst {
 		
 		firstNormalChar = 0;
 		firstMultiChar = 0;
+		std::map<string, uint16_t> stringToSymbol;
 		std::map<string, uint16_t> features;
 		std::map<string, uint16_t> values;
 		values[""] = FlagValueNeutral;
@@ -169,6 +224,7 @@ namespace libvoikko { namespace fst {
 				symbolToDiacritic.push_back(getDiacriticOperation(symbol, features, values));
 			}
 		}
+		symbolIndex.build(stringToSymbol, symbolToString);
 		flagDiacriticFeatureCount = features.size();
 		{
 			size_t partial = (filePtr - static_cast<char *>(map)) % sizeof(WeightedTransition);
@@ -178,95 +234,245 @@ namespace libvoikko { namespace fst {
 			}
 		}
 		transitionStart = reinterpret_cast<WeightedTransition *>(filePtr);
+		buildStateIndex();
+		checkWeights();
+		finalDistancesComputed = false;
+	}
+	
+	void WeightedTransducer::buildStateIndex() {
+		uint32_t cellCount = (static_cast<char *>(map) + fileLength - reinterpret_cast<char *>(transitionStart)) / sizeof(WeightedTransition);
+		uint32_t stateOffset = 0;
+		while (stateOffset < cellCount) {
+			WeightedTransition * stateHead = transitionStart + stateOffset;
+			uint32_t maxTc = getMaxTc(stateHead);
+			uint64_t ownSummary = 0;
+			bool hasEpsilons = false;
+			for (uint32_t tc = 0; tc <= maxTc; tc++) {
+				uint32_t symIn = (stateHead + tc)->symIn;
+				if (tc == 1 && maxTc >= 255) {
+					continue; // overflow cell
+				}
+				if (symIn == 0xFFFFFFFF) {
+					ownSummary |= InputSymbolSummary::FINAL;
+				}
+				else if (symIn < firstNormalChar) {
+					hasEpsilons = true;
+				}
+				else {
+					ownSummary |= InputSymbolSummary::symbolBit(symIn);
+				}
+			}
+			inputSummary.addState(stateOffset, ownSummary);
+			for (uint32_t tc = 0; hasEpsilons && tc <= maxTc; tc++) {
+				WeightedTransition * transition = stateHead + tc;
+				if (!(tc == 1 && maxTc >= 255) && transition->symIn < firstNormalChar) {
+					inputSummary.addEpsilonTransition(transition->targetState);
+				}
+			}
+			if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS) {
+				vector<uint32_t> inputSymbols(maxTc + 1);
+				for (uint32_t tc = 0; tc <= maxTc; tc++) {
+					uint32_t symIn = (stateHead + tc)->symIn;
+					if (tc == 1 && maxTc >= 255) {
+						inputSymbols[tc] = NO_TRANSITION; // overflow cell
+					}
+					else if (symIn == 0xFFFFFFFF || symIn < firstNormalChar) {
+						inputSymbols[tc] = 0;
+					}
+					else {
+						inputSymbols[tc] = symIn;
+					}
+				}
+				stateIndex.addState(stateOffset, maxTc, inputSymbols);
+			}
+			stateOffset += maxTc + 1;
+		}
+		inputSummary.build(cellCount);
+	}
+	
+	void WeightedTransducer::checkWeights() {
+		negativeWeights = false;
+		uint32_t cellCount = (static_cast<char *>(map) + fileLength - reinterpret_cast<char *>(transitionStart)) / sizeof(WeightedTransition);
+		uint32_t stateOffset = 0;
+		while (stateOffset < cellCount) {
+			WeightedTransition * stateHead = transitionStart + stateOffset;
+			uint32_t maxTc = getMaxTc(stateHead);
+			for (uint32_t tc = 0; tc <= maxTc; tc++) {
+				if (tc == 1 && maxTc >= 255) {
+					continue; // overflow cell
+				}
+				if ((stateHead + tc)->weight < 0) {
+					negativeWeights = true;
+					return;
+				}
+			}
+			stateOffset += maxTc + 1;
+		}
+	}
+	
+	bool WeightedTransducer::hasNegativeWeights() const {
+		return negativeWeights;
+	}
+	
+	static const int32_t UNREACHABLE_STATE = 0x7FFFFFFF;
+	
+	void WeightedTransducer::computeFinalDistances() const {
+		uint32_t cellCount = (static_cast<char *>(map) + fileLength - reinterpret_cast<char *>(transitionStart)) / sizeof(WeightedTransition);
+		finalDistance.assign(cellCount, UNREACHABLE_STATE);
+		
+		// Transitions are reversed into a compact table where the transitions
+		// leading to state s are reverseSource[reverseStart[s] .. reverseStart[s + 1]).
+		// Flag diacritics are ignored, so the distances are lower bounds.
+		vector<uint32_t> reverseStart(cellCount + 1, 0);
+		for (uint32_t stateOffset = 0; stateOffset < cellCount; ) {
+			WeightedTransition * stateHead = transitionStart + stateOffset;
+			uint32_t maxTc = getMaxTc(stateHead);
+			for (uint32_t tc = 0; tc <= maxTc; tc++) {
+				if (tc == 1 && maxTc >= 255) {
+					continue;
+				}
+				WeightedTransition * t = stateHead + tc;
+				if (t->symIn == 0xFFFFFFFF) {
+					finalDistance[stateOffset] = min(finalDistance[stateOffset], static_cast<int32_t>(t->weight));
+				}
+				else {
+					reverseStart[t->targetState + 1]++;
+				}
+			}
+			stateOffset += maxTc + 1;
+		}
+		for (uint32_t i = 0; i < cellCount; i++) {
+			reverseStart[i + 1] += reverseStart[i];
+		}
+		vector<uint32_t> reverseSource(reverseStart[cellCount]);
+		vector<int16_t> reverseWeight(reverseStart[cellCount]);
+		{
+			vector<uint32_t> fillPosition(reverseStart.begin(), reverseStart.end() - 1);
+			for (uint32_t stateOffset = 0; stateOffset < cellCount; ) {
+				WeightedTransition * stateHead = transitionStart + stateOffset;
+				uint32_t maxTc = getMaxTc(stateHead);
+				for (uint32_t tc = 0; tc <= maxTc; tc++) {
+					WeightedTransition * t = stateHead + tc;
+					if ((tc == 1 && maxTc >= 255) || t->symIn == 0xFFFFFFFF) {
+						continue;
+					}
+					uint32_t pos = fillPosition[t->targetState]++;
+					reverseSource[pos] = stateOffset;
+					reverseWeight[pos] = t->weight;
+				}
+				stateOffset += maxTc + 1;
+			}
+		}
+		
+		// Dijkstra's algorithm starting from all final states at once
+		priority_queue<pair<int32_t, uint32_t>, vector<pair<int32_t, uint32_t> >, greater<pair<int32_t, uint32_t> > > queue;
+		for (uint32_t i = 0; i < cellCount; i++) {
+			if (finalDistance[i] != UNREACHABLE_STATE) {
+				queue.push(make_pair(finalDistance[i], i));
+			}
+		}
+		while (!queue.empty()) {
+			int32_t distance = queue.top().first;
+			uint32_t state = queue.top().second;
+			queue.pop();
+			if (distance > finalDistance[state]) {
+				continue;
+			}
+			for (uint32_t i = reverseStart[state]; i < reverseStart[state + 1]; i++) {
+				int32_t newDistance = distance + reverseWeight[i];
+				if (newDistance < finalDistance[reverseSource[i]]) {
+					finalDistance[reverseSource[i]] = newDistance;
+					queue.push(make_pair(newDistance, reverseSource[i]));
+				}
+			}
+		}
+		finalDistancesComputed = true;
 	}
 	
 	bool WeightedTransducer::prepare(WeightedConfiguration * configuration, const char * input, size_t inputLen) const {
 		configuration->stackDepth = 0;
+		configuration->baseDepth = 0;
 		configuration->inputDepth = 0;
 		configuration->stateIndexStack[0] = 0;
 		configuration->currentTransitionStack[0] = 0;
+		if (flagDiacriticFeatureCount) {
+			memset(configuration->flagValues, 0, flagDiacriticFeatureCount * sizeof(uint32_t));
+		}
 		configuration->inputLength = 0;
+		configuration->firstInputVariant = 0;
+		configuration->lastInputOptional = false;
 		const char * ip = input;
 		while (ip < input + inputLen) {
-			const char * prevIp = ip;
-			utf8::unchecked::next(ip);
-			std::map<std::string,uint16_t>::const_iterator it = stringToSymbol.find(string(prevIp, ip - prevIp));
-			if (it == stringToSymbol.end()) {
+			uint16_t symbol = symbolIndex.findChar(utf8::unchecked::next(ip));
+			if (symbol == 0) {
 				// Unknown symbol
 				return false;
 			}
-			configuration->inputSymbolStack[configuration->inputLength] = it->second;
+			configuration->inputSymbolStack[configuration->inputLength] = symbol;
 			configuration->inputLength++;
 		}
 		return true;
 	}
 	
-	static uint32_t getMaxTc(WeightedTransition * stateHead) {
-		uint32_t maxTc = stateHead->moreTransitions;
-		if (maxTc == 255) {
-			WeightedOverflowCell * oc = reinterpret_cast<WeightedOverflowCell *>(stateHead + 1);
-			maxTc = oc->moreTransitions + 1;
+	bool WeightedTransducer::prepare(WeightedConfiguration * configuration, const wchar_t * input, size_t inputLen) const {
+		configuration->stackDepth = 0;
+		configuration->baseDepth = 0;
+		configuration->inputDepth = 0;
+		configuration->stateIndexStack[0] = 0;
+		configuration->currentTransitionStack[0] = 0;
+		if (flagDiacriticFeatureCount) {
+			memset(configuration->flagValues, 0, flagDiacriticFeatureCount * sizeof(uint32_t));
 		}
-		return maxTc;
+		bool allKnown = true;
+		for (size_t i = 0; i < inputLen; i++) {
+			uint16_t symbol = symbolIndex.findChar(static_cast<uint32_t>(input[i]));
+			if (symbol == 0) {
+				allKnown = false;
+			}
+			configuration->inputSymbolStack[i] = symbol;
+		}
+		configuration->inputLength = static_cast<int>(inputLen);
+		configuration->firstInputVariant = 0;
+		configuration->lastInputOptional = false;
+		return allKnown;
 	}
 	
-	static bool flagDiacriticCheck(WeightedConfiguration * configuration, const Transducer * transducer, uint16_t symbol) {
-		uint16_t flagDiacriticFeatureCount = transducer->flagDiacriticFeatureCount;
-		if (!flagDiacriticFeatureCount) {
-			return true;
+	bool WeightedTransducer::prepareVariants(WeightedConfiguration * configuration, const wchar_t * input, size_t inputLen,
+	                                         wchar_t firstVariant, bool lastOptional) const {
+		prepare(configuration, input, inputLen);
+		if (inputLen == 0) {
+			return false;
 		}
-		int stackDepth = configuration->stackDepth;
-		size_t diacriticCell = flagDiacriticFeatureCount * sizeof(uint32_t);
-		uint32_t * flagValueStack = configuration->flagValueStack;
-		uint32_t * currentFlagArray = flagValueStack + stackDepth * flagDiacriticFeatureCount;
-		
-		bool update = false;
-		OpFeatureValue ofv;
-		if (symbol != 0 && symbol < transducer->firstNormalChar) {
-			ofv = transducer->symbolToDiacritic[symbol];
-			uint32_t currentValue = currentFlagArray[ofv.feature];
-			DEBUG("checking op " << ofv.op << " " << ofv.feature << " " << ofv.value << " current value " << currentValue)
-			switch (ofv.op) {
-				case Operation_P:
-					update = true;
-					break;
-				case Operation_C:
-					ofv.value = FlagValueNeutral;
-					update = true;
-					break;
-				case Operation_U:
-					if (currentValue) {
-						if (currentValue != ofv.value) {
-							return false;
-						}
-					}
-					else {
-						update = true;
-					}
-					break;
-				case Operation_R:
-					if (ofv.value == FlagValueAny && currentValue == FlagValueNeutral) {
-						return false;
-					}
-					if (ofv.value != FlagValueAny && currentValue != ofv.value) {
-						return false;
-					}
-					break;
-				case Operation_D:
-					if ((ofv.value == FlagValueAny && currentValue != FlagValueNeutral) || currentValue == ofv.value) {
-						return false;
-					}
-					break;
-				default:
-					return false;// this would be an error
+		uint32_t * symbols = configuration->inputSymbolStack;
+		if (firstVariant) {
+			configuration->firstInputVariant = symbolIndex.findChar(static_cast<uint32_t>(firstVariant));
+			if (symbols[0] == 0) {
+				// only the variant can match
+				symbols[0] = configuration->firstInputVariant;
 			}
-			DEBUG("allowed")
 		}
-		
-		memcpy(currentFlagArray + flagDiacriticFeatureCount, currentFlagArray, diacriticCell);
-		if (update) {
-			DEBUG("updating feature " << ofv.feature << " to " << ofv.value)
-			(currentFlagArray + flagDiacriticFeatureCount)[ofv.feature] = ofv.value;
+		// Symbol 0 of an unknown last character is never consumed
+		configuration->lastInputOptional = lastOptional && inputLen > 1;
+		int requiredLength = configuration->inputLength - (configuration->lastInputOptional ? 1 : 0);
+		for (int i = 0; i < requiredLength; i++) {
+			if (symbols[i] == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	/**
+	 * Checks whether a transition with given input symbol is allowed by flag diacritic
+	 * values currentFlagArray and if so, stores the flag values after the transition
+	 * to nextFlagArray.
+	 */
+	static bool flagDiacriticUpdate(const Transducer * transducer, uint16_t symbol,
+	                                const uint32_t * currentFlagArray, uint32_t * nextFlagArray) {
+		memcpy(nextFlagArray, currentFlagArray, transducer->flagDiacriticFeatureCount * sizeof(uint32_t));
+		if (symbol != 0 && symbol < transducer->firstNormalChar) {
+			OpFeatureValue ofv = transducer->symbolToDiacritic[symbol];
+			return flagDiacriticApply(ofv, nextFlagArray[ofv.feature]);
 		}
 		return true;
 	}
@@ -282,91 +488,505 @@ namespace libvoikko { namespace fst {
 	}
 	
 	bool WeightedTransducer::next(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen, int16_t * weight, int * firstNotReachedPosition) const {
-		uint32_t loopCounter = 0;
-		*firstNotReachedPosition = configuration->inputDepth;
-		while (loopCounter < MAX_LOOP_COUNT) {
-			WeightedTransition * stateHead = transitionStart + configuration->stateIndexStack[configuration->stackDepth];
-			WeightedTransition * currentTransition = transitionStart + configuration->currentTransitionStack[configuration->stackDepth];
-			uint32_t startTransitionIndex = currentTransition - stateHead;
-			uint32_t maxTc = getMaxTc(stateHead);
-			for (uint32_t tc = startTransitionIndex; tc <= maxTc; tc++) {
-				if (tc == 1 && maxTc >= 255) {
-					// skip overflow cell
-					tc++;
-					currentTransition++;
-				}
-				// next
-				if (currentTransition->symIn == 0xFFFFFFFF) {
-					// final state
-					if (configuration->inputDepth == configuration->inputLength) {
-						char * outputBufferPos = outputBuffer;
-						for (int i = 0; i < configuration->stackDepth; i++) {
-							const char * outputSym = symbolToString[configuration->outputSymbolStack[i]];
-							size_t symLen = strlen(outputSym);
-							if ((outputBufferPos - outputBuffer) + symLen + 1 >= bufferLen) {
-								DEBUG("would overflow the output buffer")
-								return false;
-							}
-							strncpy(outputBufferPos, outputSym, symLen);
-							outputBufferPos += symLen;
-						}
-						*outputBufferPos = '\0';
-						configuration->currentTransitionStack[configuration->stackDepth] = currentTransition - transitionStart + 1;
-						*weight = currentTransition->weight;
-						for (int i = 0; i < configuration->stackDepth; i++) {
-							*weight += (transitionStart + configuration->currentTransitionStack[i])->weight;
-						}
-						return true;
+		WeightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		bool found = (firstNormalChar > 1 ?
+			traverse< TraversalPolicy<true, true, false> >(cells, configuration, outputBuffer, bufferLen, result) :
+			traverse< TraversalPolicy<true, false, false> >(cells, configuration, outputBuffer, bufferLen, result));
+		*firstNotReachedPosition = result.firstNotReachedPosition;
+		if (found) {
+			*weight = result.weight;
+		}
+		return found;
+	}
+	
+	bool WeightedTransducer::nextVariant(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen,
+	                                     bool & firstVariantUsed, bool & lastConsumed) const {
+		WeightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		bool found = (firstNormalChar > 1 ?
+			traverse< TraversalPolicy<true, true, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result) :
+			traverse< TraversalPolicy<true, false, false, false, true> >(cells, configuration, outputBuffer, bufferLen, result));
+		if (found) {
+			firstVariantUsed = result.firstInputVariantUsed;
+			lastConsumed = (result.prefixLength == static_cast<size_t>(configuration->inputLength));
+		}
+		return found;
+	}
+	
+	void WeightedTransducer::skipFirstVariant(WeightedConfiguration * configuration) const {
+		WeightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		int variantDepth = 0;
+		while (variantDepth < configuration->stackDepth &&
+		       cells.symIn(configuration->currentTransitionStack[variantDepth]) < firstNormalChar) {
+			variantDepth++;
+		}
+		if (variantDepth == configuration->stackDepth) {
+			return;
+		}
+		// backtrack to the state where the first input symbol was consumed
+		while (configuration->stackDepth > variantDepth) {
+			configuration->stackDepth--;
+			flagDiacriticUndo(configuration, this, cells.symIn(configuration->currentTransitionStack[configuration->stackDepth]));
+		}
+		configuration->inputDepth = 0;
+		configuration->currentTransitionStack[variantDepth]++;
+	}
+	
+	bool WeightedTransducer::prepare(WeightedConfiguration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const {
+		if (!prepare(configuration, input, inputLen)) {
+			return false;
+		}
+		frontier->start(configuration);
+		return true;
+	}
+	
+	bool WeightedTransducer::prepare(WeightedConfiguration * configuration, PrefixFrontier * frontier, const wchar_t * input, size_t inputLen) const {
+		if (!prepare(configuration, input, inputLen)) {
+			return false;
+		}
+		frontier->start(configuration);
+		return true;
+	}
+	
+	bool WeightedTransducer::next(WeightedConfiguration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen,
+	                              int16_t * weight) const {
+		WeightedCells cells(this, stateIndex, inputSummary, symbolToString, transitionStart);
+		TraversalResult result;
+		bool found = (firstNormalChar > 1 ?
+			traverseBatch< TraversalPolicy<true, true, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result) :
+			traverseBatch< TraversalPolicy<true, false, false, true> >(cells, configuration, frontier, outputBuffer, bufferLen, result));
+		if (found) {
+			*weight = result.weight;
+		}
+		return found;
+	}
+	
+	bool WeightedTransducer::prepare(BestFirstConfiguration * configuration, const char * input, size_t inputLen) const {
+		return prepare(configuration, input, inputLen, 0);
+	}
+	
+	bool WeightedTransducer::prepare(BestFirstConfiguration * configuration, const char * input, size_t inputLen,
+	                                 const WeightedTransducer * acceptor) const {
+		if (negativeWeights || (acceptor && acceptor->negativeWeights)) {
+			return false;
+		}
+		{
+			utils::MutexLocker lock(finalDistanceMutex);
+			if (!finalDistancesComputed) {
+				computeFinalDistances();
+			}
+		}
+		if (acceptor != configuration->acceptor) {
+			configuration->acceptorSymbols.assign(symbolToString.size(), 0);
+			if (acceptor) {
+				for (size_t sym = firstNormalChar; sym < symbolToString.size(); sym++) {
+					const char * symStr = symbolToString[sym];
+					uint16_t acceptorSym = acceptor->symbolIndex.find(symStr, strlen(symStr));
+					if (acceptorSym >= acceptor->firstNormalChar) {
+						configuration->acceptorSymbols[sym] = acceptorSym;
 					}
 				}
-				else if (((configuration->inputDepth < configuration->inputLength &&
-					  configuration->inputSymbolStack[configuration->inputDepth] == currentTransition->symIn) ||
-					  currentTransition->symIn < firstNormalChar) &&
-					  flagDiacriticCheck(configuration, this, currentTransition->symIn)) {
-					// down
-					DEBUG("down " << tc)
-					if (configuration->stackDepth + 2 == configuration->bufferSize) {
-						DEBUG("max stack depth reached")
-						return false;
+			}
+			configuration->acceptor = acceptor;
+		}
+		configuration->flagsPerNode = flagDiacriticFeatureCount + (acceptor ? acceptor->flagDiacriticFeatureCount : 0);
+		configuration->nodes.clear();
+		configuration->flagValues.clear();
+		configuration->queue.clear();
+		configuration->hasNextEntry = false;
+		configuration->inputLength = 0;
+		configuration->completeInput = false;
+		configuration->distinctOutputs = false;
+		const char * ip = input;
+		while (ip < input + inputLen) {
+			if (configuration->inputLength + 1 >= configuration->bufferSize) {
+				return false;
+			}
+			uint16_t symbol = symbolIndex.findChar(utf8::unchecked::next(ip));
+			if (symbol == 0) {
+				// Unknown symbol
+				return false;
+			}
+			configuration->inputSymbolStack[configuration->inputLength] = symbol;
+			configuration->inputLength++;
+		}
+		if (finalDistance[0] != UNREACHABLE_STATE) {
+			BestFirstNode root = {0, 0, 0, 0, 0, 0, 0, true};
+			configuration->nodes.push_back(root);
+			configuration->flagValues.resize(configuration->flagsPerNode, FlagValueNeutral);
+			BestFirstQueueEntry entry = {finalDistance[0], 0};
+			configuration->queue.push_back(entry);
+		}
+		return true;
+	}
+	
+	bool WeightedTransducer::prepareCompletions(BestFirstConfiguration * configuration, const char * input, size_t inputLen) const {
+		if (!prepare(configuration, input, inputLen, 0)) {
+			return false;
+		}
+		configuration->completeInput = true;
+		configuration->distinctOutputs = true;
+		configuration->clearOutputs();
+		return true;
+	}
+	
+	/**
+	 * Adds a new path to be extended. The lightest of the paths added during one
+	 * expansion is kept aside in bestChild and the rest go to the queue.
+	 */
+	static void addPath(BestFirstConfiguration * configuration, const BestFirstNode & child, int32_t priority,
+	                    BestFirstQueueEntry & bestChild, bool & hasBestChild) {
+		BestFirstQueueEntry entry = {priority, static_cast<uint32_t>(configuration->nodes.size())};
+		configuration->nodes.push_back(child);
+		if (!hasBestChild) {
+			bestChild = entry;
+			hasBestChild = true;
+			return;
+		}
+		if (bestChild < entry) {
+			std::swap(bestChild, entry);
+		}
+		configuration->queue.push_back(entry);
+		push_heap(configuration->queue.begin(), configuration->queue.end());
+	}
+	
+	void WeightedTransducer::expandComposedPath(BestFirstConfiguration * configuration, uint32_t nodeIndex,
+	                                            BestFirstQueueEntry & bestChild, bool & hasBestChild) const {
+		const WeightedTransducer * acceptor = configuration->acceptor;
+		vector<uint32_t> & flagValues = configuration->flagValues;
+		const uint32_t flagsPerNode = configuration->flagsPerNode;
+		const uint32_t inputLength = configuration->inputLength;
+		const BestFirstNode node = configuration->nodes[nodeIndex];
+		const size_t nodeFlagPos = static_cast<size_t>(nodeIndex) * flagsPerNode;
+		StateCursor cursor;
+		
+		WeightedTransition * acceptorHead = acceptor->transitionStart + node.acceptorStateOffset;
+		uint32_t acceptorMaxTc = getMaxTc(acceptorHead);
+		const AcceleratedState * acceptorAccelerated = 0;
+		if (acceptorMaxTc + 1 >= StateIndex::MIN_TRANSITIONS) {
+			acceptorAccelerated = acceptor->stateIndex.find(node.acceptorStateOffset);
+		}
+		
+		// Acceptor moves alone through epsilon and flag diacritic transitions
+		if (node.acceptorMoveAllowed) {
+			int32_t remaining = finalDistance[node.stateOffset];
+			if (acceptorAccelerated) {
+				cursor.init(acceptor->stateIndex, acceptorAccelerated, 0);
+			}
+			for (uint32_t atc = 0; atc <= acceptorMaxTc; atc++) {
+				if (acceptorAccelerated) {
+					atc = cursor.next(atc);
+					if (atc > acceptorMaxTc) {
+						break;
+					}
+				}
+				else if (atc == 1 && acceptorMaxTc >= 255) {
+					continue; // overflow cell
+				}
+				WeightedTransition * acceptorTransition = acceptorHead + atc;
+				if (acceptorTransition->symIn == 0xFFFFFFFF || acceptorTransition->symIn >= acceptor->firstNormalChar) {
+					continue;
+				}
+				if (flagsPerNode) {
+					size_t flagPos = flagValues.size();
+					flagValues.resize(flagPos + flagsPerNode);
+					copy(flagValues.begin() + nodeFlagPos, flagValues.begin() + nodeFlagPos + flagDiacriticFeatureCount,
+					     flagValues.begin() + flagPos);
+					if (!flagDiacriticUpdate(acceptor, acceptorTransition->symIn, &flagValues[0] + nodeFlagPos + flagDiacriticFeatureCount,
+					    &flagValues[0] + flagPos + flagDiacriticFeatureCount)) {
+						flagValues.resize(flagPos);
+						continue;
+					}
+				}
+				BestFirstNode child = node;
+				child.parent = nodeIndex;
+				child.symOut = 0;
+				child.weight += acceptorTransition->weight;
+				child.depth++;
+				child.acceptorStateOffset = acceptorTransition->targetState;
+				addPath(configuration, child, child.weight + remaining, bestChild, hasBestChild);
+			}
+		}
+		
+		// This transducer moves and the acceptor consumes its output, if any
+		WeightedTransition * stateHead = transitionStart + node.stateOffset;
+		uint32_t maxTc = getMaxTc(stateHead);
+		const AcceleratedState * accelerated = 0;
+		if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS) {
+			accelerated = stateIndex.find(node.stateOffset);
+		}
+		if (accelerated) {
+			cursor.init(stateIndex, accelerated, node.inputDepth < inputLength ? configuration->inputSymbolStack[node.inputDepth] : 0);
+		}
+		StateCursor acceptorCursor;
+		for (uint32_t tc = 0; tc <= maxTc; tc++) {
+			if (accelerated) {
+				tc = cursor.next(tc);
+				if (tc > maxTc) {
+					break;
+				}
+			}
+			else if (tc == 1 && maxTc >= 255) {
+				continue; // overflow cell
+			}
+			WeightedTransition * currentTransition = stateHead + tc;
+			uint32_t acceptorSymbol;
+			int32_t remaining;
+			if (currentTransition->symIn == 0xFFFFFFFF) {
+				if (node.inputDepth != inputLength) {
+					continue;
+				}
+				acceptorSymbol = 0xFFFFFFFF;
+				remaining = 0;
+			}
+			else if ((node.inputDepth < inputLength && configuration->inputSymbolStack[node.inputDepth] == currentTransition->symIn) ||
+			         currentTransition->symIn < firstNormalChar) {
+				remaining = finalDistance[currentTransition->targetState];
+				if (remaining == UNREACHABLE_STATE) {
+					continue;
+				}
+				if (currentTransition->symOut < firstNormalChar) {
+					// epsilon output, the acceptor stays where it is
+					BestFirstNode child = node;
+					if (flagsPerNode) {
+						size_t flagPos = flagValues.size();
+						flagValues.resize(flagPos + flagsPerNode);
+						if (!flagDiacriticUpdate(this, currentTransition->symIn, &flagValues[nodeFlagPos], &flagValues[flagPos])) {
+							flagValues.resize(flagPos);
+							continue;
+						}
+						copy(flagValues.begin() + nodeFlagPos + flagDiacriticFeatureCount, flagValues.begin() + nodeFlagPos + flagsPerNode,
+						     flagValues.begin() + flagPos + flagDiacriticFeatureCount);
 					}
-					configuration->outputSymbolStack[configuration->stackDepth] = 
-						(currentTransition->symOut >= firstNormalChar ? currentTransition->symOut : 0);
-					configuration->currentTransitionStack[configuration->stackDepth] = currentTransition - transitionStart;
-					configuration->stackDepth++;
-					configuration->stateIndexStack[configuration->stackDepth] = currentTransition->targetState;
-					configuration->currentTransitionStack[configuration->stackDepth] = currentTransition->targetState;
+					child.stateOffset = currentTransition->targetState;
+					child.parent = nodeIndex;
+					child.symOut = 0;
+					child.weight += currentTransition->weight;
+					child.depth++;
 					if (currentTransition->symIn >= firstNormalChar) {
-						configuration->inputDepth++;
-						if (*firstNotReachedPosition < configuration->inputDepth) {
-							*firstNotReachedPosition = configuration->inputDepth;
+						child.inputDepth++;
+					}
+					child.acceptorMoveAllowed = false;
+					addPath(configuration, child, child.weight + remaining, bestChild, hasBestChild);
+					continue;
+				}
+				acceptorSymbol = configuration->acceptorSymbols[currentTransition->symOut];
+				if (acceptorSymbol == 0) {
+					continue;
+				}
+			}
+			else {
+				continue;
+			}
+			
+			// Find the matching acceptor transitions (final transitions if this one is final)
+			if (acceptorAccelerated) {
+				acceptorCursor.init(acceptor->stateIndex, acceptorAccelerated, acceptorSymbol == 0xFFFFFFFF ? 0 : acceptorSymbol);
+			}
+			size_t transducerFlagPos = 0;
+			for (uint32_t atc = 0; atc <= acceptorMaxTc; atc++) {
+				if (acceptorAccelerated) {
+					atc = acceptorCursor.next(atc);
+					if (atc > acceptorMaxTc) {
+						break;
+					}
+				}
+				else if (atc == 1 && acceptorMaxTc >= 255) {
+					continue; // overflow cell
+				}
+				WeightedTransition * acceptorTransition = acceptorHead + atc;
+				if (acceptorTransition->symIn != acceptorSymbol) {
+					continue;
+				}
+				if (flagsPerNode) {
+					size_t flagPos = flagValues.size();
+					flagValues.resize(flagPos + flagsPerNode);
+					if (transducerFlagPos) {
+						// flags already checked for an earlier acceptor transition
+						copy(flagValues.begin() + transducerFlagPos, flagValues.begin() + transducerFlagPos + flagsPerNode,
+						     flagValues.begin() + flagPos);
+					}
+					else {
+						if (!flagDiacriticUpdate(this, currentTransition->symIn, &flagValues[nodeFlagPos], &flagValues[flagPos])) {
+							flagValues.resize(flagPos);
+							break;
 						}
+						copy(flagValues.begin() + nodeFlagPos + flagDiacriticFeatureCount, flagValues.begin() + nodeFlagPos + flagsPerNode,
+						     flagValues.begin() + flagPos + flagDiacriticFeatureCount);
+						transducerFlagPos = flagPos;
+					}
+				}
+				BestFirstNode child = node;
+				child.parent = nodeIndex;
+				child.weight += currentTransition->weight + acceptorTransition->weight;
+				if (acceptorSymbol == 0xFFFFFFFF) {
+					child.stateOffset = BestFirstConfiguration::FINAL_PATH;
+					child.symOut = 0;
+				}
+				else {
+					child.stateOffset = currentTransition->targetState;
+					child.symOut = currentTransition->symOut;
+					child.depth++;
+					if (currentTransition->symIn >= firstNormalChar) {
+						child.inputDepth++;
 					}
-					goto nextInMainLoop;
+					child.acceptorStateOffset = acceptorTransition->targetState;
+					child.acceptorMoveAllowed = true;
 				}
-				currentTransition++;
+				addPath(configuration, child, child.weight + remaining, bestChild, hasBestChild);
 			}
-			if (configuration->stackDepth == 0) {
-				DEBUG("end")
-				return false;
+		}
+	}
+	
+	bool WeightedTransducer::next(BestFirstConfiguration * configuration, char * outputBuffer, size_t bufferLen, int16_t * weight) const {
+		vector<BestFirstNode> & nodes = configuration->nodes;
+		vector<uint32_t> & flagValues = configuration->flagValues;
+		vector<BestFirstQueueEntry> & queue = configuration->queue;
+		uint32_t lastIndexedOffset = NO_TRANSITION;
+		const AcceleratedState * lastIndexed = 0;
+		StateCursor cursor;
+		uint32_t loopCounter = 0;
+		while ((configuration->hasNextEntry || !queue.empty()) && loopCounter < MAX_LOOP_COUNT) {
+			uint32_t nodeIndex;
+			if (configuration->hasNextEntry) {
+				nodeIndex = configuration->nextEntry.node;
+				configuration->hasNextEntry = false;
 			}
-			// up
-			configuration->stackDepth--;
-			DEBUG("up")
-			{
-				uint16_t previousInputSymbol = (transitionStart + configuration->currentTransitionStack[configuration->stackDepth])->symIn;
-				if (previousInputSymbol >= firstNormalChar) {
-					configuration->inputDepth--;
+			else {
+				pop_heap(queue.begin(), queue.end());
+				nodeIndex = queue.back().node;
+				queue.pop_back();
+			}
+			// copied because adding nodes may move the vector
+			const BestFirstNode node = nodes[nodeIndex];
+			if (node.stateOffset == BestFirstConfiguration::FINAL_PATH) {
+				uint32_t pathNode = node.parent;
+				for (uint32_t i = node.depth; i > 0; i--) {
+					configuration->outputSymbolStack[i - 1] = nodes[pathNode].symOut;
+					pathNode = nodes[pathNode].parent;
+				}
+				char * outputBufferPos = outputBuffer;
+				for (uint32_t i = 0; i < node.depth; i++) {
+					const char * outputSym = symbolToString[configuration->outputSymbolStack[i]];
+					size_t symLen = strlen(outputSym);
+					if ((outputBufferPos - outputBuffer) + symLen + 1 >= bufferLen) {
+						DEBUG("would overflow the output buffer")
+						return false;
+					}
+					strncpy(outputBufferPos, outputSym, symLen);
+					outputBufferPos += symLen;
+				}
+				*outputBufferPos = '\0';
+				if (configuration->distinctOutputs &&
+				    !configuration->addOutput(outputBuffer, outputBufferPos - outputBuffer)) {
+					continue;
 				}
+				*weight = static_cast<int16_t>(node.weight);
+				return true;
 			}
-			configuration->currentTransitionStack[configuration->stackDepth]++;
-			nextInMainLoop:
 			loopCounter++;
+			if (node.depth + 2 >= static_cast<uint32_t>(configuration->bufferSize)) {
+				DEBUG("max stack depth reached")
+				continue;
+			}
+			BestFirstQueueEntry bestChild;
+			bool hasBestChild = false;
+			if (configuration->acceptor) {
+				expandComposedPath(configuration, nodeIndex, bestChild, hasBestChild);
+			}
+			else {
+				// past the end of the input when completing, any input symbol may follow
+				const bool completing = configuration->completeInput &&
+				                        node.inputDepth >= static_cast<uint32_t>(configuration->inputLength);
+				WeightedTransition * stateHead = transitionStart + node.stateOffset;
+				uint32_t maxTc = getMaxTc(stateHead);
+				const AcceleratedState * accelerated = 0;
+				if (maxTc + 1 >= StateIndex::MIN_TRANSITIONS && !completing) {
+					if (node.stateOffset != lastIndexedOffset) {
+						lastIndexed = stateIndex.find(node.stateOffset);
+						lastIndexedOffset = node.stateOffset;
+					}
+					accelerated = lastIndexed;
+				}
+				if (accelerated) {
+					cursor.init(stateIndex, accelerated, node.inputDepth < static_cast<uint32_t>(configuration->inputLength) ?
+					            configuration->inputSymbolStack[node.inputDepth] : 0);
+				}
+				for (uint32_t tc = 0; tc <= maxTc; tc++) {
+					if (accelerated) {
+						// only visit transitions that can match
+						tc = cursor.next(tc);
+						if (tc > maxTc) {
+							break;
+						}
+					}
+					else if (tc == 1 && maxTc >= 255) {
+						continue; // overflow cell
+					}
+					WeightedTransition * currentTransition = stateHead + tc;
+					BestFirstNode child = node;
+					child.parent = nodeIndex;
+					child.weight = node.weight + currentTransition->weight;
+					int32_t priority;
+					if (currentTransition->symIn == 0xFFFFFFFF) {
+						if (node.inputDepth != static_cast<uint32_t>(configuration->inputLength) && !completing) {
+							continue;
+						}
+						child.stateOffset = BestFirstConfiguration::FINAL_PATH;
+						child.symOut = 0;
+						priority = child.weight;
+						flagValues.resize(flagValues.size() + flagDiacriticFeatureCount);
+					}
+					else if ((node.inputDepth < static_cast<uint32_t>(configuration->inputLength) &&
+					          configuration->inputSymbolStack[node.inputDepth] == currentTransition->symIn) ||
+					          currentTransition->symIn < firstNormalChar || completing) {
+						int32_t remaining = finalDistance[currentTransition->targetState];
+						if (remaining == UNREACHABLE_STATE) {
+							continue;
+						}
+						if (flagDiacriticFeatureCount) {
+							size_t flagPos = flagValues.size();
+							flagValues.resize(flagPos + flagDiacriticFeatureCount);
+							if (!flagDiacriticUpdate(this, currentTransition->symIn,
+							    &flagValues[nodeIndex * flagDiacriticFeatureCount], &flagValues[flagPos])) {
+								flagValues.resize(flagPos);
+								continue;
+							}
+						}
+						child.stateOffset = currentTransition->targetState;
+						child.symOut = (currentTransition->symOut >= firstNormalChar ? currentTransition->symOut : 0);
+						child.depth++;
+						if (currentTransition->symIn >= firstNormalChar) {
+							child.inputDepth++;
+						}
+						priority = child.weight + remaining;
+					}
+					else {
+						continue;
+					}
+					addPath(configuration, child, priority, bestChild, hasBestChild);
+				}
+			}
+			if (hasBestChild) {
+				// Continue directly from the best new path if it would be the next
+				// one to be taken from the queue anyway. This saves queue operations
+				// when a path is extended without increasing its weight.
+				if (queue.empty() || !(bestChild < queue.front())) {
+					configuration->nextEntry = bestChild;
+					configuration->hasNextEntry = true;
+				}
+				else {
+					queue.push_back(bestChild);
+					push_heap(queue.begin(), queue.end());
+				}
+			}
 		}
-		DEBUG("maximum number of loops reached")
+		DEBUG("end or maximum number of loops reached")
 		return false;
 	}
 	
-	void WeightedTransducer::backtrackToOutputDepth(WeightedConfiguration * configuration, int depth) {
+	void WeightedTransducer::backtrackToOutputDepth(WeightedConfiguration * configuration, int depth) const {
 		int outputDepth = 0;
 		int stackIndex = 0;
 		while (outputDepth < depth + 1 && stackIndex < configuration->stackDepth) {
@@ -383,6 +1003,9 @@ namespace libvoikko { namespace fst {
 				if (previousInputSymbol >= firstNormalChar) {
 					configuration->inputDepth--;
 				}
+				else {
+					flagDiacriticUndo(configuration, this, previousInputSymbol);
+				}
 			}
 			configuration->currentTransitionStack[configuration->stackDepth]++;
 		}
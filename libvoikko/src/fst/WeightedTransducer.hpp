@@ -31,23 +31,60 @@
 #define LIBVOIKKO_FST_WEIGHTED_TRANSDUCER_H
 
 #include "fst/Transducer.hpp"
+#include "fst/SymbolIndex.hpp"
+#include "fst/StateIndex.hpp"
+#include "fst/InputSymbolSummary.hpp"
 #include "fst/WeightedTransition.hpp"
 #include "fst/WeightedConfiguration.hpp"
+#include "fst/PrefixFrontier.hpp"
+#include "fst/BestFirstConfiguration.hpp"
+#include "utils/Mutex.hpp"
 
 namespace libvoikko { namespace fst {
 	
 	class WeightedTransducer : public Transducer {
 		private:
 			WeightedTransition * transitionStart;
-			std::map<std::string, uint16_t> stringToSymbol;
+			SymbolIndex symbolIndex;
+			StateIndex stateIndex;
+			InputSymbolSummary inputSummary;
 			std::vector<const char *> symbolToString;
 			uint16_t firstMultiChar;
+			bool negativeWeights;
+			/**
+			 * Lower bound for the weight of reaching a final state from each state.
+			 * Computed on first best-first traversal.
+			 */
+			mutable std::vector<int32_t> finalDistance;
+			mutable bool finalDistancesComputed;
+			mutable utils::Mutex finalDistanceMutex;
 			void byteSwapTransducer(void *& mapPtr, size_t fileLength);
+			void buildStateIndex();
+			void checkWeights();
+			void computeFinalDistances() const;
+			void expandComposedPath(BestFirstConfiguration * configuration, uint32_t nodeIndex,
+			                        BestFirstQueueEntry & bestChild, bool & hasBestChild) const;
 		public:
 			WeightedTransducer(const char * filePath);
 			
 			bool prepare(WeightedConfiguration * configuration, const char * input, size_t inputLen) const;
 			
+			/**
+			 * Prepares the configuration for traversing wide character input.
+			 * @return false if the input contains characters that have no symbol
+			 */
+			bool prepare(WeightedConfiguration * configuration, const wchar_t * input, size_t inputLen) const;
+			
+			/**
+			 * Prepares the configuration for finding the paths of several variants of
+			 * the input in one traversal. The first character may also be matched by
+			 * firstVariant (if it is not 0), and if lastOptional is true the paths
+			 * may end before the last character. Use nextVariant to find the paths.
+			 * @return false if no variant of the input can be found
+			 */
+			bool prepareVariants(WeightedConfiguration * configuration, const wchar_t * input, size_t inputLen,
+			                     wchar_t firstVariant, bool lastOptional) const;
+			
 			bool next(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen) const;
 			
 			bool next(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen, int16_t * weight) const;
@@ -55,7 +92,83 @@ namespace libvoikko { namespace fst {
 			bool next(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen, int16_t * weight,
 			          int * firstNotReachedPosition) const;
 			
-			void backtrackToOutputDepth(WeightedConfiguration * configuration, int depth);
+			/**
+			 * Finds the next path of a configuration set up with prepareVariants.
+			 * @param firstVariantUsed set to true if the path starts with the variant of the first character
+			 * @param lastConsumed set to false if the path ends before the last character
+			 */
+			bool nextVariant(WeightedConfiguration * configuration, char * outputBuffer, size_t bufferLen,
+			                 bool & firstVariantUsed, bool & lastConsumed) const;
+			
+			/**
+			 * Skips the remaining paths that begin with the same transition as the
+			 * path that nextVariant just returned. Useful when the path used the
+			 * variant of the first character and more such paths are not needed.
+			 */
+			void skipFirstVariant(WeightedConfiguration * configuration) const;
+			
+			/**
+			 * Like prepare but the lookup continues from the states that frontier
+			 * has saved for the prefix shared with the previous input. Results must
+			 * then be read with the next method that takes the same frontier.
+			 */
+			bool prepare(WeightedConfiguration * configuration, PrefixFrontier * frontier, const char * input, size_t inputLen) const;
+			
+			bool prepare(WeightedConfiguration * configuration, PrefixFrontier * frontier, const wchar_t * input, size_t inputLen) const;
+			
+			bool next(WeightedConfiguration * configuration, PrefixFrontier * frontier, char * outputBuffer, size_t bufferLen,
+			          int16_t * weight) const;
+			
+			void backtrackToOutputDepth(WeightedConfiguration * configuration, int depth) const;
+			
+			/**
+			 * Returns true if some transition or final state has a negative weight.
+			 * Best-first traversal is not possible for such transducers.
+			 */
+			bool hasNegativeWeights() const;
+			
+			/**
+			 * Prepares the configuration for enumerating the outputs for given input
+			 * in ascending order of weight.
+			 * @return false if the input contains unknown symbols or the transducer
+			 *         has negative weights
+			 */
+			bool prepare(BestFirstConfiguration * configuration, const char * input, size_t inputLen) const;
+			
+			/**
+			 * Prepares the configuration for enumerating the outputs for given input
+			 * that are accepted by acceptor, in ascending order of the combined
+			 * weight of both transducers. The composition is built lazily: each output
+			 * symbol is fed to the acceptor as soon as it is produced, so paths whose
+			 * output the acceptor cannot continue are dropped right away.
+			 * @param acceptor transducer whose input is the output of this one or
+			 *        null pointer for plain traversal
+			 * @return false if the input contains unknown symbols or either of
+			 *         the transducers has negative weights
+			 */
+			bool prepare(BestFirstConfiguration * configuration, const char * input, size_t inputLen,
+			             const WeightedTransducer * acceptor) const;
+			
+			/**
+			 * Prepares the configuration for enumerating the outputs of paths whose
+			 * input begins with given input, in ascending order of weight. Any
+			 * input symbols may follow the given ones. Each output is returned
+			 * only once, also when several paths produce it.
+			 * @return false if the input contains unknown symbols or the transducer
+			 *         has negative weights
+			 */
+			bool prepareCompletions(BestFirstConfiguration * configuration, const char * input, size_t inputLen) const;
+			
+			/**
+			 * Returns the next lightest output. Paths are searched with A* using
+			 * the smallest weight needed to reach a final state as the estimate
+			 * for the rest of the path, so the first results are found without
+			 * going through all paths. When traversing a composition, the output
+			 * is that of this transducer and the weight is the combined weight of
+			 * both transducers. The same output may be returned more than once,
+			 * except when listing completions.
+			 */
+			bool next(BestFirstConfiguration * configuration, char * outputBuffer, size_t bufferLen, int16_t * weight) const;
 	};
 } }
 
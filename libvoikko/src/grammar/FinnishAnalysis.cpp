@@ -39,6 +39,17 @@ using std::list;
 
 namespace libvoikko {
 
+/** Attributes that are used in analyseToken */
+static const uint32_t ANALYSIS_KEYS =
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_STRUCTURE) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_CLASS) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_MOOD) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_PERSON) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_NEGATIVE) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_POSSIBLE_GEOGRAPHICAL_NAME) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_REQUIRE_FOLLOWING_VERB) |
+	morphology::Analysis::keyBit(morphology::Analysis::KEY_SIJAMUOTO);
+
 FinnishAnalysis::FinnishAnalysis(voikko_options_t * voikkoOptions) : voikkoOptions(voikkoOptions) {
 }
 
@@ -74,7 +85,7 @@ void FinnishAnalysis::analyseToken(Token * token) {
 	    utils::StringUtils::stripSpecialCharsForMalaga(token->str,
 	                                                   token->tokenlen);
 	morphology::Analyzer * analyzer = voikkoOptions->morAnalyzer;
-	list<morphology::Analysis *> * analyses = analyzer->analyze(wordBuffer, wcslen(wordBuffer), false);
+	list<morphology::Analysis *> * analyses = analyzer->analyze(wordBuffer, wcslen(wordBuffer), ANALYSIS_KEYS);
 	delete[] wordBuffer;
 	
 	list<morphology::Analysis *>::const_iterator it = analyses->begin();
@@ -82,18 +93,18 @@ void FinnishAnalysis::analyseToken(Token * token) {
 	bool verbFollowerTypeSet = false;
 	while (it != analyses->end()) {
 		token->isValidWord = true;
-		const wchar_t * structure = (*it)->getValue("STRUCTURE");
-		const wchar_t * wclass = (*it)->getValue("CLASS");
-		const wchar_t * mood = (*it)->getValue("MOOD");
-		const wchar_t * person = (*it)->getValue("PERSON");
-		const wchar_t * negative = (*it)->getValue("NEGATIVE");
-		const wchar_t * possibleGeographicalName = (*it)->getValue("POSSIBLE_GEOGRAPHICAL_NAME");
-		const wchar_t * requireFollowingVerb = (*it)->getValue("REQUIRE_FOLLOWING_VERB");
+		const wchar_t * structure = (*it)->getValue(morphology::Analysis::KEY_STRUCTURE);
+		const wchar_t * wclass = (*it)->getValue(morphology::Analysis::KEY_CLASS);
+		const wchar_t * mood = (*it)->getValue(morphology::Analysis::KEY_MOOD);
+		const wchar_t * person = (*it)->getValue(morphology::Analysis::KEY_PERSON);
+		const wchar_t * negative = (*it)->getValue(morphology::Analysis::KEY_NEGATIVE);
+		const wchar_t * possibleGeographicalName = (*it)->getValue(morphology::Analysis::KEY_POSSIBLE_GEOGRAPHICAL_NAME);
+		const wchar_t * requireFollowingVerb = (*it)->getValue(morphology::Analysis::KEY_REQUIRE_FOLLOWING_VERB);
 		if (wcslen(structure) < 2 || (structure[1] != L'p' &&
 		    structure[1] != L'q')) {
 			// Word may start with a capital letter anywhere
 			token->firstLetterLcase = false;
-			const wchar_t * wcase = (*it)->getValue("SIJAMUOTO");
+			const wchar_t * wcase = (*it)->getValue(morphology::Analysis::KEY_SIJAMUOTO);
 			if (wclass && wcscmp(L"paikannimi", wclass) == 0 &&
 			    wcase && wcscmp(L"omanto", wcase) == 0) {
 				token->isGeographicalNameInGenitive = true;
@@ -196,10 +207,7 @@ Sentence * FinnishAnalysis::analyseSentence(const wchar_t * text, size_t textlen
 	bool next_word_is_possible_sentence_start = false;
 	for (int i = 0; i < Sentence::MAX_TOKENS_IN_SENTENCE; i++) {
 		enum voikko_token_type tt;
-		int ignore_dot_saved = voikkoOptions->ignore_dot;
-		voikkoOptions->ignore_dot = 0;
-		tt = tokenizer::Tokenizer::nextToken(voikkoOptions, pos, remaining, &tokenlen);
-		voikkoOptions->ignore_dot = ignore_dot_saved;
+		tt = tokenizer::Tokenizer::nextToken(pos, remaining, &tokenlen, false);
 		if (tt == TOKEN_NONE) return s;
 
 		s->tokens[i].type = tt;
@@ -28,6 +28,7 @@
 
 #include "grammar/FinnishRuleEngine/VfstAutocorrectCheck.hpp"
 #include "grammar/error.hpp"
+#include "fst/TransducerRegistry.hpp"
 #include "utils/StringUtils.hpp"
 #include "character/SimpleChar.hpp"
 #include <list>
@@ -40,7 +41,7 @@ namespace libvoikko { namespace grammar { namespace check {
 static const size_t BUFFER_SIZE = 20000;
 
 VfstAutocorrectCheck::VfstAutocorrectCheck(const string & fileName) throw(setup::DictionaryException) {
-	transducer = new fst::UnweightedTransducer(fileName.c_str());
+	transducer = fst::TransducerRegistry::acquireUnweighted(fileName);
 	configuration = new fst::Configuration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
 	inputBuffer = new char[BUFFER_SIZE + 1];
 	outputBuffer = new char[BUFFER_SIZE + 1];
@@ -51,8 +52,7 @@ VfstAutocorrectCheck::~VfstAutocorrectCheck() {
 	delete[] inputBuffer;
 	delete configuration;
 	if (transducer) {
-		transducer->terminate();
-		delete transducer;
+		fst::TransducerRegistry::release(transducer);
 	}
 }
 
@@ -45,7 +45,7 @@ class VfstAutocorrectCheck : public SentenceCheck {
 		~VfstAutocorrectCheck();
 		void check(voikko_options_t * options, const Sentence * sentence);
 	private:
-		fst::UnweightedTransducer * transducer;
+		const fst::UnweightedTransducer * transducer;
 		fst::Configuration * configuration;
 		char * inputBuffer;
 		char * outputBuffer;
@@ -86,10 +86,7 @@ Sentence * HfstAnalysis::analyseSentence(const wchar_t * text, size_t textlen, s
 	bool next_word_is_possible_sentence_start = false;
 	for (int i = 0; i < Sentence::MAX_TOKENS_IN_SENTENCE; i++) {
 		enum voikko_token_type tt;
-		int ignore_dot_saved = voikkoOptions->ignore_dot;
-		voikkoOptions->ignore_dot = 0;
-		tt = tokenizer::Tokenizer::nextToken(voikkoOptions, pos, remaining, &tokenlen);
-		voikkoOptions->ignore_dot = ignore_dot_saved;
+		tt = tokenizer::Tokenizer::nextToken(pos, remaining, &tokenlen, false);
 		if (tt == TOKEN_NONE) return s;
 
 		s->tokens[i].type = tt;
@@ -28,44 +28,167 @@
 
 #include "morphology/Analysis.hpp"
 #include "utils/StringUtils.hpp"
+#include <algorithm>
+#include <cstring>
 
 using namespace libvoikko::utils;
 
 namespace libvoikko { namespace morphology {
 
+static const char * const KEY_NAMES[Analysis::KEY_COUNT] = {
+	"BASEFORM",
+	"CLASS",
+	"COMPARISON",
+	"FOCUS",
+	"FSTOUTPUT",
+	"KYSYMYSLIITE",
+	"MALAGA_VAPAA_JALKIOSA",
+	"MOOD",
+	"NEGATIVE",
+	"NUMBER",
+	"PARTICIPLE",
+	"PERSON",
+	"POSSESSIVE",
+	"POSSIBLE_GEOGRAPHICAL_NAME",
+	"REQUIRE_FOLLOWING_VERB",
+	"SIJAMUOTO",
+	"STRUCTURE",
+	"TENSE",
+	"WEIGHT",
+	"WORDBASES",
+	"WORDIDS"
+};
+
+const uint32_t Analysis::ALL_KEYS;
+const uint32_t Analysis::FULL_MORPHOLOGY_KEYS;
+
 Analysis::Analysis() : keys(0) {
+	std::fill(values, values + KEY_COUNT, static_cast<wchar_t *>(0));
 }
 
 Analysis::~Analysis() {
 	deleteKeys();
-	std::map<std::string, wchar_t *>::iterator it = attributes.begin();
-	while (it != attributes.end()) {
+	for (size_t i = 0; i < KEY_COUNT; i++) {
+		delete[] values[i];
+	}
+	std::map<std::string, wchar_t *>::iterator it = otherAttributes.begin();
+	while (it != otherAttributes.end()) {
 		delete[] it++->second;
 	}
 }
 
+bool Analysis::findKey(const char * name, Key & key) {
+	size_t low = 0;
+	size_t high = KEY_COUNT;
+	while (low < high) {
+		size_t middle = (low + high) / 2;
+		int cmp = strcmp(name, KEY_NAMES[middle]);
+		if (cmp == 0) {
+			key = static_cast<Key>(middle);
+			return true;
+		}
+		if (cmp < 0) {
+			high = middle;
+		}
+		else {
+			low = middle + 1;
+		}
+	}
+	return false;
+}
+
+void Analysis::addAttribute(Key key, wchar_t * value) {
+	if (values[key]) {
+		delete[] value;
+		return;
+	}
+	values[key] = value;
+	deleteKeys();
+}
+
 void Analysis::addAttribute(const char * key, wchar_t * value) {
-	attributes.insert(std::make_pair(std::string(key), value));
-	recreateKeys();
+	Key slot;
+	if (findKey(key, slot)) {
+		addAttribute(slot, value);
+		return;
+	}
+	if (!otherAttributes.insert(std::make_pair(std::string(key), value)).second) {
+		delete[] value;
+		return;
+	}
+	deleteKeys();
+}
+
+void Analysis::removeAttribute(Key key) {
+	if (values[key]) {
+		delete[] values[key];
+		values[key] = 0;
+		deleteKeys();
+	}
 }
 
 void Analysis::removeAttribute(const char * key) {
-	std::map<std::string, wchar_t *>::iterator valueI = attributes.find(std::string(key));
-	if (valueI != attributes.end()) {
+	Key slot;
+	if (findKey(key, slot)) {
+		removeAttribute(slot);
+		return;
+	}
+	std::map<std::string, wchar_t *>::iterator valueI = otherAttributes.find(std::string(key));
+	if (valueI != otherAttributes.end()) {
 		delete[] valueI->second;
-		attributes.erase(valueI);
-		recreateKeys();
+		otherAttributes.erase(valueI);
+		deleteKeys();
+	}
+}
+
+void Analysis::retainAttributes(uint32_t keyMask) {
+	for (size_t i = 0; i < KEY_COUNT; i++) {
+		if (!(keyMask & keyBit(static_cast<Key>(i)))) {
+			removeAttribute(static_cast<Key>(i));
+		}
 	}
 }
 
 const char ** Analysis::getKeys() const {
-	return const_cast<const char **>(keys);
+	if (!keys) {
+		// merge the slots and the other attributes in alphabetical order
+		size_t count = otherAttributes.size();
+		for (size_t i = 0; i < KEY_COUNT; i++) {
+			if (values[i]) {
+				count++;
+			}
+		}
+		keys = new const char*[count + 1];
+		std::map<std::string, wchar_t *>::const_iterator it = otherAttributes.begin();
+		size_t slot = 0;
+		size_t i = 0;
+		while (true) {
+			while (slot < KEY_COUNT && !values[slot]) {
+				slot++;
+			}
+			if (slot < KEY_COUNT && (it == otherAttributes.end() || strcmp(KEY_NAMES[slot], it->first.c_str()) < 0)) {
+				keys[i++] = KEY_NAMES[slot++];
+			}
+			else if (it != otherAttributes.end()) {
+				keys[i++] = it++->first.c_str();
+			}
+			else {
+				break;
+			}
+		}
+		keys[i] = 0;
+	}
+	return keys;
 }
 
 const wchar_t * Analysis::getValue(const char * key) const {
+	Key slot;
+	if (findKey(key, slot)) {
+		return values[slot];
+	}
 	std::map<std::string, wchar_t *>::const_iterator valueI =
-	    attributes.find(std::string(key));
-	if (valueI == attributes.end()) {
+	    otherAttributes.find(std::string(key));
+	if (valueI == otherAttributes.end()) {
 		return 0;
 	}
 	else {
@@ -73,20 +196,9 @@ const wchar_t * Analysis::getValue(const char * key) const {
 	}
 }
 
-void Analysis::deleteKeys() {
+void Analysis::deleteKeys() const {
 	delete[] keys;
 	keys = 0;
 }
 
-void Analysis::recreateKeys() {
-	deleteKeys();
-	keys = new const char*[attributes.size() + 1];
-	std::map<std::string, wchar_t *>::const_iterator it = attributes.begin();
-	size_t i = 0;
-	while (it != attributes.end()) {
-		keys[i++] = it++->first.c_str();
-	}
-	keys[i] = 0;
-}
-
 } }
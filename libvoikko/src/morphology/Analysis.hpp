@@ -31,6 +31,7 @@
 
 #include <string>
 #include <map>
+#include <stdint.h>
 
 namespace libvoikko { namespace morphology {
 
@@ -38,26 +39,83 @@ namespace libvoikko { namespace morphology {
  * Results from morphological analysis. See
  * doc/morphological-analysis.txt for more information about the
  * attributes that should be included in the analysis.
+ * 
+ * The attributes produced by the analyzers of this library are stored in
+ * fixed slots indexed by Key. Other attributes are kept in a map. The array
+ * of attribute names is built only when it is requested.
  */
 class Analysis {
 	public:
+		/**
+		 * Attributes that have a slot of their own. These are in the
+		 * alphabetical order of the attribute names.
+		 */
+		enum Key {
+			KEY_BASEFORM,
+			KEY_CLASS,
+			KEY_COMPARISON,
+			KEY_FOCUS,
+			KEY_FSTOUTPUT,
+			KEY_KYSYMYSLIITE,
+			KEY_MALAGA_VAPAA_JALKIOSA,
+			KEY_MOOD,
+			KEY_NEGATIVE,
+			KEY_NUMBER,
+			KEY_PARTICIPLE,
+			KEY_PERSON,
+			KEY_POSSESSIVE,
+			KEY_POSSIBLE_GEOGRAPHICAL_NAME,
+			KEY_REQUIRE_FOLLOWING_VERB,
+			KEY_SIJAMUOTO,
+			KEY_STRUCTURE,
+			KEY_TENSE,
+			KEY_WEIGHT,
+			KEY_WORDBASES,
+			KEY_WORDIDS,
+			KEY_COUNT
+		};
+		
+		/** Mask of all attributes that have a slot */
+		static const uint32_t ALL_KEYS = (1u << KEY_COUNT) - 1;
+		
+		/** Attributes that are only produced in full morphology mode */
+		static const uint32_t FULL_MORPHOLOGY_KEYS = (1u << KEY_BASEFORM) | (1u << KEY_FSTOUTPUT) |
+		                                             (1u << KEY_WORDBASES) | (1u << KEY_WORDIDS);
+		
+		/**
+		 * Returns the bit of given attribute in attribute masks.
+		 */
+		static uint32_t keyBit(Key key) {
+			return 1u << key;
+		}
+		
 		Analysis();
 		~Analysis();
 		
 		/**
 		 * Adds an attribute to analysis. Ownership of value
-		 * is transferred to this object.
+		 * is transferred to this object. If the attribute is
+		 * already present, its value is not changed and value
+		 * is deleted.
 		 */
+		void addAttribute(Key key, wchar_t * value);
 		void addAttribute(const char * key, wchar_t * value);
 		
 		/**
 		 * Deletes an attribute from analysis.
 		 */
+		void removeAttribute(Key key);
 		void removeAttribute(const char * key);
 		
+		/**
+		 * Deletes the attributes that have a slot but are not in keyMask.
+		 */
+		void retainAttributes(uint32_t keyMask);
+		
 		/**
 		 * Returns a null terminated array of strings containing
-		 * the attribute names in this analysis.
+		 * the attribute names in this analysis. The array is valid
+		 * until the attributes are changed.
 		 */
 		const char ** getKeys() const;
 
@@ -65,15 +123,23 @@ class Analysis {
 		 * Returns the value of given attribute. If no such
 		 * attribute exists, returns null.
 		 */
+		const wchar_t * getValue(Key key) const {
+			return values[key];
+		}
 		const wchar_t * getValue(const char * key) const;
 	private:
 		Analysis(Analysis const & other);
 		Analysis & operator = (const Analysis & other);
 		
-		void deleteKeys();
-		void recreateKeys();
-		const char ** keys;
-		std::map<std::string, wchar_t *> attributes;
+		/**
+		 * Finds the slot for an attribute name.
+		 * @return false if the attribute does not have a slot
+		 */
+		static bool findKey(const char * name, Key & key);
+		void deleteKeys() const;
+		mutable const char ** keys;
+		wchar_t * values[KEY_COUNT];
+		std::map<std::string, wchar_t *> otherAttributes;
 };
 
 } }
@@ -0,0 +1,52 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef VOIKKO_MORPHOLOGY_ANALYSIS_VISITOR
+#define VOIKKO_MORPHOLOGY_ANALYSIS_VISITOR
+
+#include "morphology/Analysis.hpp"
+
+namespace libvoikko { namespace morphology {
+
+/**
+ * Receives the results of Analyzer::analyze one at a time.
+ */
+class AnalysisVisitor {
+	public:
+		/**
+		 * Called for each analysis of the word. The analysis belongs to the
+		 * analyzer and is valid only during the call. Return false to stop the
+		 * analysis before the remaining results are computed.
+		 */
+		virtual bool visit(const Analysis & analysis) = 0;
+		virtual ~AnalysisVisitor() { }
+};
+
+} }
+
+#endif
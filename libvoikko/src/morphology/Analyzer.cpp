@@ -36,6 +36,31 @@ namespace libvoikko { namespace morphology {
 Analyzer::~Analyzer() {
 }
 
+list<Analysis *> * Analyzer::analyze(const wchar_t * word, size_t wlen, uint32_t keyMask) {
+	list<Analysis *> * analyses = analyze(word, wlen, (keyMask & Analysis::FULL_MORPHOLOGY_KEYS) != 0);
+	for (list<Analysis *>::iterator it = analyses->begin(); it != analyses->end(); ++it) {
+		(*it)->retainAttributes(keyMask);
+	}
+	return analyses;
+}
+
+void Analyzer::analyze(const wchar_t * word, size_t wlen, uint32_t keyMask, AnalysisVisitor & visitor) {
+	list<Analysis *> * analyses = analyze(word, wlen, keyMask);
+	for (list<Analysis *>::const_iterator it = analyses->begin(); it != analyses->end(); ++it) {
+		if (!visitor.visit(**it)) {
+			break;
+		}
+	}
+	deleteAnalyses(analyses);
+}
+
+void Analyzer::setPrefixSharing(bool) {
+}
+
+bool Analyzer::listWords(const wchar_t *, size_t, WordVisitor &) {
+	return false;
+}
+
 void Analyzer::deleteAnalyses(list<Analysis *> * &analyses) {
 	list<Analysis *>::iterator it = analyses->begin();
 	while (it != analyses->end()) {
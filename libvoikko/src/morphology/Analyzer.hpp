@@ -30,6 +30,8 @@
 #define VOIKKO_MORPHOLOGY_ANALYZER
 
 #include "morphology/Analysis.hpp"
+#include "morphology/AnalysisVisitor.hpp"
+#include "morphology/WordVisitor.hpp"
 #include <list>
 
 namespace libvoikko { namespace morphology {
@@ -46,6 +48,43 @@ class Analyzer {
 		virtual std::list<Analysis *> * analyze(const wchar_t * word, size_t wlen, bool fullMorphology) = 0;
 		virtual std::list<Analysis *> * analyze(const char * word, bool fullMorphology) = 0;
 		
+		/**
+		 * Analyzes given word and returns only the attributes that are in keyMask,
+		 * a combination of Analysis::keyBit values. Attributes that do not have a
+		 * slot in Analysis are always returned. The default implementation runs
+		 * the analysis with the fullMorphology flag needed for keyMask and
+		 * deletes the other attributes afterwards.
+		 */
+		virtual std::list<Analysis *> * analyze(const wchar_t * word, size_t wlen, uint32_t keyMask);
+		
+		/**
+		 * Analyzes given word and passes the results with the attributes in keyMask
+		 * to visitor one at a time until the visitor asks to stop. The default
+		 * implementation collects the results in a list first, analyzers that
+		 * produce their results one by one skip the rest of the analysis when
+		 * the visitor stops.
+		 */
+		virtual void analyze(const wchar_t * word, size_t wlen, uint32_t keyMask, AnalysisVisitor & visitor);
+		
+		/**
+		 * Tells the analyzer whether the following words are likely to share
+		 * prefixes with the word analyzed before them, as in a sorted word list.
+		 * Analyzers that can continue a lookup from the shared prefix do so only
+		 * when this is enabled. The default implementation does nothing.
+		 */
+		virtual void setPrefixSharing(bool enabled);
+		
+		/**
+		 * Passes words that begin with given prefix to visitor, shortest first,
+		 * until the visitor asks to stop. The words are read from the lexicon
+		 * without analyzing them, so some of them may have no valid analysis.
+		 * The prefix itself is not listed. The default implementation cannot
+		 * list any words.
+		 * @return false if this analyzer cannot list words or gave up before
+		 *         all words had been listed or the visitor asked to stop
+		 */
+		virtual bool listWords(const wchar_t * prefix, size_t plen, WordVisitor & visitor);
+		
 		virtual void terminate() = 0;
 		virtual ~Analyzer();
 
@@ -28,11 +28,13 @@
 
 #include "morphology/FinnishVfstAnalyzer.hpp"
 #include "setup/DictionaryException.hpp"
+#include "fst/TransducerRegistry.hpp"
 #include "utils/StringUtils.hpp"
 #include "character/SimpleChar.hpp"
 #include "utils/utils.hpp"
 #include "voikko_defines.h"
 #include <cassert>
+#include <set>
 
 using namespace libvoikko::character;
 using namespace libvoikko::utils;
@@ -42,16 +44,29 @@ using std::string;
 using std::wstring;
 using std::list;
 using std::map;
+using std::set;
 
 namespace libvoikko { namespace morphology {
 
 static const int BUFFER_SIZE = 2000;
 static const int MAX_ANALYSIS_COUNT = 100;
+static const size_t MAX_LISTED_WORDS = 500;
 
 FinnishVfstAnalyzer::FinnishVfstAnalyzer(const string & directoryName) throw(setup::DictionaryException) {
 	string morFile = directoryName + "/mor.vfst";
-	transducer = new UnweightedTransducer(morFile.c_str());
-	configuration = new Configuration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	transducer = 0;
+	compactTransducer = 0;
+	frontier = 0;
+	completionConfiguration = 0;
+	completionBuffer = 0;
+	if (CompactTransducer::isCompactTransducerFile(morFile.c_str())) {
+		compactTransducer = TransducerRegistry::acquireCompact(morFile);
+		configuration = new Configuration(compactTransducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	}
+	else {
+		transducer = TransducerRegistry::acquireUnweighted(morFile);
+		configuration = new Configuration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	}
 	outputBuffer = new char[BUFFER_SIZE];
 	
 	classMap.insert(std::make_pair(L"n", L"nimisana"));
@@ -308,7 +323,7 @@ static wchar_t * getAttributeFromMap(map<wstring, wstring> & theMap, const wchar
 }
 
 static void parseBasicAttribute(Analysis * analysis, const wchar_t * fstOutput, size_t i, size_t j,
-			        const char * attributeName, map<wstring, wstring> & theMap) {
+			        Analysis::Key attributeName, map<wstring, wstring> & theMap) {
 	if (analysis->getValue(attributeName)) {
 		return; // already set
 	}
@@ -426,26 +441,26 @@ static bool isValidAnalysis(const wchar_t * fstOutput, size_t len) {
 }
 
 static void addInfoFlag(Analysis * analysis, const wchar_t * outputPosition, const wchar_t * outputBuffer) {
-	const wchar_t * className = analysis->getValue("CLASS");
+	const wchar_t * className = analysis->getValue(Analysis::KEY_CLASS);
 	if (wcsncmp(outputPosition, L"vj", 2) == 0) {
 		if (outputBuffer[0] != L'-') {
-			analysis->addAttribute("MALAGA_VAPAA_JALKIOSA", StringUtils::copy(L"true"));
+			analysis->addAttribute(Analysis::KEY_MALAGA_VAPAA_JALKIOSA, StringUtils::copy(L"true"));
 		}
 	}
 	else if (wcsncmp(outputPosition, L"ca", 2) == 0) {
 		if (!wcsstr(outputPosition, L"[Bc]") && !wcsstr(outputPosition, L"[Ll]") && (!className || wcsncmp(className, L"nimisana", 8) == 0)) {
-			analysis->addAttribute("POSSIBLE_GEOGRAPHICAL_NAME", StringUtils::copy(L"true"));
+			analysis->addAttribute(Analysis::KEY_POSSIBLE_GEOGRAPHICAL_NAME, StringUtils::copy(L"true"));
 		}
 	}
 	else {
-		const wchar_t * mood = analysis->getValue("MOOD");
+		const wchar_t * mood = analysis->getValue(Analysis::KEY_MOOD);
 		if ((!mood || (wcscmp(mood, L"E-infinitive") != 0 && wcscmp(mood, L"MINEN-infinitive") != 0 && wcscmp(mood, L"MA-infinitive") != 0)) &&
 		    (!className || wcscmp(className, L"teonsana") == 0)) {
 			if (wcsncmp(outputPosition, L"ra", 2) == 0) {
-				analysis->addAttribute("REQUIRE_FOLLOWING_VERB", StringUtils::copy(L"A-infinitive"));
+				analysis->addAttribute(Analysis::KEY_REQUIRE_FOLLOWING_VERB, StringUtils::copy(L"A-infinitive"));
 			}
 			else if (wcsncmp(outputPosition, L"rm", 2) == 0) {
-				analysis->addAttribute("REQUIRE_FOLLOWING_VERB", StringUtils::copy(L"MA-infinitive"));
+				analysis->addAttribute(Analysis::KEY_REQUIRE_FOLLOWING_VERB, StringUtils::copy(L"MA-infinitive"));
 			}
 		}
 	}
@@ -662,24 +677,24 @@ static wchar_t * parseBaseform(const wchar_t * fstOutput, size_t fstLen, const w
 	return baseform;
 }
 
-void FinnishVfstAnalyzer::duplicateOrgName(Analysis * analysis, const wchar_t * fstOutput, std::list<Analysis *> * analysisList) {
-	const wchar_t * oldClass = analysis->getValue("CLASS");
+Analysis * FinnishVfstAnalyzer::duplicateOrgName(Analysis * analysis, const wchar_t * fstOutput) {
+	const wchar_t * oldClass = analysis->getValue(Analysis::KEY_CLASS);
 	if (!oldClass || wcscmp(oldClass, L"nimisana") != 0) {
-		return;
+		return 0;
 	}
 	size_t fstLen = wcslen(fstOutput);
 	if (fstLen < 13) {
-		return;
+		return 0;
 	}
 	if (fstOutput[0] == L'-') {
-		return;
+		return 0;
 	}
 	if (wcsncmp(fstOutput, L"[La]", 4) == 0) {
-		return;
+		return 0;
 	}
 	for (size_t i = fstLen - 5; i >= 8; i--) {
 		if (wcsncmp(fstOutput + i, L"[Bc]", 4) == 0) {
-			return;
+			return 0;
 		}
 		if (wcsncmp(fstOutput + i, L"[Ion]", 5) == 0) {
 			for (size_t j = i - 4; j >= 4; j--) {
@@ -711,15 +726,15 @@ void FinnishVfstAnalyzer::duplicateOrgName(Analysis * analysis, const wchar_t *
 					if (newStructure) {
 						wchar_t * baseform = parseBaseform(fstOutput, fstLen, newStructure);
 						if (baseform) {
-							newAnalysis->addAttribute("BASEFORM", baseform);
+							newAnalysis->addAttribute(Analysis::KEY_BASEFORM, baseform);
 						}
 					}
-					analysisList->push_back(newAnalysis);
-					return;
+					return newAnalysis;
 				}
 			}
 		}
 	}
+	return 0;
 }
 
 static void debugContentEnd(wchar_t * wordIds, wchar_t * wordBases, wchar_t * xsBuffer, wchar_t * xpBuffer,
@@ -875,12 +890,12 @@ void FinnishVfstAnalyzer::parseDebugAttributes(Analysis * analysis, const wchar_
 	delete[] xsBuffer;
 	delete[] xpBuffer;
 	if (anyXs) {
-		analysis->addAttribute("WORDIDS", wordIds);
+		analysis->addAttribute(Analysis::KEY_WORDIDS, wordIds);
 	}
 	else {
 		delete[] wordIds;
 	}
-	analysis->addAttribute("WORDBASES", wordBases);
+	analysis->addAttribute(Analysis::KEY_WORDBASES, wordBases);
 }
 
 void FinnishVfstAnalyzer::parseBasicAttributes(Analysis * analysis, const wchar_t * fstOutput, size_t fstLen) {
@@ -894,71 +909,71 @@ void FinnishVfstAnalyzer::parseBasicAttributes(Analysis * analysis, const wchar_
 				if (fstOutput[j] == L'[') {
 					if (fstOutput[j + 1] == L'L') {
 						if (wcsncmp(fstOutput + (j + 2), L"nl", 2) == 0) {
-							const wchar_t * comp = analysis->getValue("COMPARISON");
+							const wchar_t * comp = analysis->getValue(Analysis::KEY_COMPARISON);
 							if (convertNimiLaatusanaToLaatusana || (comp && (wcscmp(comp, L"comparative") == 0 || wcscmp(comp, L"superlative") == 0)) ||
 							    wcsncmp(fstOutput, L"[Lu]", 4) == 0) {
-								analysis->addAttribute("CLASS", StringUtils::copy(L"laatusana"));
+								analysis->addAttribute(Analysis::KEY_CLASS, StringUtils::copy(L"laatusana"));
 							}
 							else {
-								analysis->addAttribute("CLASS", StringUtils::copy(L"nimisana_laatusana"));
+								analysis->addAttribute(Analysis::KEY_CLASS, StringUtils::copy(L"nimisana_laatusana"));
 							}
 						}
 						else {
-							parseBasicAttribute(analysis, fstOutput, i, j, "CLASS", classMap);
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_CLASS, classMap);
 						}
 					}
 					else if (fstOutput[j + 1] == L'N') {
-						const wchar_t * wclass = analysis->getValue("CLASS");
+						const wchar_t * wclass = analysis->getValue(Analysis::KEY_CLASS);
 						if (!wclass || (wcscmp(wclass, L"etuliite") != 0 && wcscmp(wclass, L"seikkasana") != 0)) {
-							parseBasicAttribute(analysis, fstOutput, i, j, "NUMBER", numberMap);
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_NUMBER, numberMap);
 						}
 					}
 					else if (fstOutput[j + 1] == L'P') {
-						parseBasicAttribute(analysis, fstOutput, i, j, "PERSON", personMap);
+						parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_PERSON, personMap);
 					}
 					else if (fstOutput[j + 1] == L'S') {
-						const wchar_t * wclass = analysis->getValue("CLASS");
+						const wchar_t * wclass = analysis->getValue(Analysis::KEY_CLASS);
 						if (!wclass || (wcscmp(wclass, L"etuliite") != 0 && wcscmp(wclass, L"seikkasana") != 0)) {
-							parseBasicAttribute(analysis, fstOutput, i, j, "SIJAMUOTO", sijamuotoMap);
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_SIJAMUOTO, sijamuotoMap);
 							if (j + 5 < fstLen && wcsncmp(fstOutput + (j + 2), L"sti", 3) == 0) {
 								convertNimiLaatusanaToLaatusana = true;
 							}
 						}
 					}
 					else if (fstOutput[j + 1] == L'T') {
-						if (!analysis->getValue("CLASS")) {
-							parseBasicAttribute(analysis, fstOutput, i, j, "MOOD", moodMap);
+						if (!analysis->getValue(Analysis::KEY_CLASS)) {
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_MOOD, moodMap);
 						}
 					}
 					else if (fstOutput[j + 1] == L'A') {
-						parseBasicAttribute(analysis, fstOutput, i, j, "TENSE", tenseMap);
+						parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_TENSE, tenseMap);
 					}
 					else if (fstOutput[j + 1] == L'F') {
 						if (wcsncmp(fstOutput + (j + 2), L"ko", 2) == 0) {
-							analysis->addAttribute("KYSYMYSLIITE", StringUtils::copy(L"true"));
+							analysis->addAttribute(Analysis::KEY_KYSYMYSLIITE, StringUtils::copy(L"true"));
 						}
 						else {
-							parseBasicAttribute(analysis, fstOutput, i, j, "FOCUS", focusMap);
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_FOCUS, focusMap);
 						}
 					}
 					else if (fstOutput[j + 1] == L'O') {
-						parseBasicAttribute(analysis, fstOutput, i, j, "POSSESSIVE", possessiveMap);
+						parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_POSSESSIVE, possessiveMap);
 					}
 					else if (fstOutput[j + 1] == L'C') {
-						if (!analysis->getValue("CLASS")) {
-							parseBasicAttribute(analysis, fstOutput, i, j, "COMPARISON", comparisonMap);
+						if (!analysis->getValue(Analysis::KEY_CLASS)) {
+							parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_COMPARISON, comparisonMap);
 						}
 					}
 					else if (fstOutput[j + 1] == L'E') {
-						parseBasicAttribute(analysis, fstOutput, i, j, "NEGATIVE", negativeMap);
+						parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_NEGATIVE, negativeMap);
 					}
 					else if (fstOutput[j + 1] == L'R') {
 						if (!bcPassed) {
-							const wchar_t * wclass = analysis->getValue("CLASS");
+							const wchar_t * wclass = analysis->getValue(Analysis::KEY_CLASS);
 							// TODO: Checking the end for [Ln] is done to handle -tUAnne ("kuunneltuanne"). This is for compatibility
 							// with Malaga implementation. See VISK § 543 (temporaalirakenne) for correct analysis.
 							if (!wclass || wcscmp(wclass, L"laatusana") == 0 || wcscmp(fstOutput + (fstLen - 4), L"[Ln]") == 0) {
-								parseBasicAttribute(analysis, fstOutput, i, j, "PARTICIPLE", participleMap);
+								parseBasicAttribute(analysis, fstOutput, i, j, Analysis::KEY_PARTICIPLE, participleMap);
 							}
 						}
 					}
@@ -967,8 +982,8 @@ void FinnishVfstAnalyzer::parseBasicAttributes(Analysis * analysis, const wchar_
 					}
 					else if (fstOutput[j + 1] == L'B') {
 						if (j >= 5 && fstOutput[j + 2] == L'c') {
-							if (!analysis->getValue("CLASS") && (fstOutput[j - 1] == L'-' || wcsncmp(fstOutput + (j - 5), L"-[Bh]", 5) == 0)) {
-								analysis->addAttribute("CLASS", StringUtils::copy(L"etuliite"));
+							if (!analysis->getValue(Analysis::KEY_CLASS) && (fstOutput[j - 1] == L'-' || wcsncmp(fstOutput + (j - 5), L"-[Bh]", 5) == 0)) {
+								analysis->addAttribute(Analysis::KEY_CLASS, StringUtils::copy(L"etuliite"));
 							}
 							bcPassed = true;
 						}
@@ -1031,24 +1046,193 @@ static void fixStructure(wchar_t * structure, wchar_t * fstOutput, size_t fstLen
 	}
 }
 
+void FinnishVfstAnalyzer::setPrefixSharing(bool enabled) {
+	if (enabled && !frontier) {
+		frontier = new PrefixFrontier(compactTransducer ? compactTransducer->getFlagDiacriticFeatureCount() :
+		                              transducer->getFlagDiacriticFeatureCount());
+	}
+	else if (!enabled) {
+		delete frontier;
+		frontier = 0;
+	}
+}
+
+bool FinnishVfstAnalyzer::prepareLookup(const char * word) {
+	size_t len = strlen(word);
+	if (compactTransducer) {
+		return frontier ? compactTransducer->prepare(configuration, frontier, word, len) :
+		                  compactTransducer->prepare(configuration, word, len);
+	}
+	return frontier ? transducer->prepare(configuration, frontier, word, len) :
+	                  transducer->prepare(configuration, word, len);
+}
+
+bool FinnishVfstAnalyzer::nextLookupResult() {
+	if (compactTransducer) {
+		return frontier ? compactTransducer->next(configuration, frontier, outputBuffer, BUFFER_SIZE) :
+		                  compactTransducer->next(configuration, outputBuffer, BUFFER_SIZE);
+	}
+	return frontier ? transducer->next(configuration, frontier, outputBuffer, BUFFER_SIZE) :
+	                  transducer->next(configuration, outputBuffer, BUFFER_SIZE);
+}
+
+bool FinnishVfstAnalyzer::prepareCompletions(const char * prefix, size_t completionLength) {
+	if (!completionConfiguration) {
+		completionConfiguration = new Configuration(compactTransducer ? compactTransducer->getFlagDiacriticFeatureCount() :
+		                                            transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+		completionBuffer = new char[BUFFER_SIZE];
+	}
+	size_t len = strlen(prefix);
+	return compactTransducer ? compactTransducer->prepareCompletions(completionConfiguration, prefix, len, completionLength) :
+	                           transducer->prepareCompletions(completionConfiguration, prefix, len, completionLength);
+}
+
+bool FinnishVfstAnalyzer::nextCompletion() {
+	return compactTransducer ? compactTransducer->nextCompletion(completionConfiguration, completionBuffer, BUFFER_SIZE) :
+	                           transducer->nextCompletion(completionConfiguration, completionBuffer, BUFFER_SIZE);
+}
+
+bool FinnishVfstAnalyzer::listWords(const wchar_t * prefix, size_t plen, WordVisitor & visitor) {
+	char * prefixLower = lowerCaseWord(prefix, plen);
+	if (!prefixLower) {
+		return true;
+	}
+	// Each word length is searched separately so that shorter words come first
+	size_t listedCount = 0;
+	wchar_t word[LIBVOIKKO_MAX_WORD_CHARS + 1];
+	for (size_t length = plen + 1; length <= LIBVOIKKO_MAX_WORD_CHARS; length++) {
+		if (!prepareCompletions(prefixLower, length)) {
+			break;
+		}
+		// A word has a path for each of its analyses
+		set<wstring> listed;
+		while (nextCompletion()) {
+			size_t wlen = StringUtils::ucs4FromUtf8(completionBuffer, strlen(completionBuffer), word, LIBVOIKKO_MAX_WORD_CHARS + 1);
+			if (wlen > LIBVOIKKO_MAX_WORD_CHARS || !listed.insert(wstring(word, wlen)).second) {
+				continue;
+			}
+			if (listedCount++ == MAX_LISTED_WORDS) {
+				delete[] prefixLower;
+				return false;
+			}
+			// the lexicon is in lower case, the prefix keeps its case
+			wmemcpy(word, prefix, plen);
+			if (!visitor.visit(word, wlen)) {
+				delete[] prefixLower;
+				return true;
+			}
+		}
+	}
+	delete[] prefixLower;
+	return true;
+}
+
 list<Analysis *> * FinnishVfstAnalyzer::analyze(const wchar_t * word, size_t wlen, bool fullMorphology) {
-	list<Analysis *> * analysisList = new list<Analysis *>();
+	return analyzeKeys(word, wlen, fullMorphology ? Analysis::ALL_KEYS :
+	                   Analysis::ALL_KEYS & ~Analysis::FULL_MORPHOLOGY_KEYS);
+}
+
+list<Analysis *> * FinnishVfstAnalyzer::analyze(const wchar_t * word, size_t wlen, uint32_t keyMask) {
+	list<Analysis *> * analysisList = analyzeKeys(word, wlen, keyMask);
+	for (list<Analysis *>::iterator it = analysisList->begin(); it != analysisList->end(); ++it) {
+		(*it)->retainAttributes(keyMask);
+	}
+	return analysisList;
+}
+
+char * FinnishVfstAnalyzer::lowerCaseWord(const wchar_t * word, size_t wlen) {
 	if (wlen > LIBVOIKKO_MAX_WORD_CHARS) {
-		return analysisList;
+		return 0;
 	}
-	
 	wchar_t * wordLowerUcs4 = new wchar_t[wlen];
 	memcpy(wordLowerUcs4, word, wlen * sizeof(wchar_t));
 	voikko_set_case(CT_ALL_LOWER, wordLowerUcs4, wlen);
 	char * wordLower = StringUtils::utf8FromUcs4(wordLowerUcs4, wlen);
 	delete[] wordLowerUcs4;
+	return wordLower;
+}
+
+Analysis * FinnishVfstAnalyzer::fillAnalysis(Analysis * analysis, wchar_t * fstOutput, size_t fstLen,
+                                             size_t wlen, uint32_t keyMask) {
+	// BASEFORM is derived from STRUCTURE
+	const bool structureWanted = (keyMask & (Analysis::keyBit(Analysis::KEY_STRUCTURE) |
+	                                         Analysis::keyBit(Analysis::KEY_BASEFORM))) != 0;
+	const bool basicAttributesWanted = (keyMask & ~Analysis::FULL_MORPHOLOGY_KEYS &
+	                                    ~Analysis::keyBit(Analysis::KEY_STRUCTURE)) != 0;
+	
+	wchar_t * structure = 0;
+	if (structureWanted) {
+		structure = parseStructure(fstOutput, wlen);
+	}
+	// Proper names may get a second analysis with a different structure. Whether
+	// that happens depends on the word class, so the basic attributes are needed.
+	const bool parseBasic = basicAttributesWanted || (structureWanted && wcsstr(fstOutput, L"[Ion]"));
+	if (parseBasic) {
+		parseBasicAttributes(analysis, fstOutput, fstLen);
+	}
+	if (structure) {
+		fixStructure(structure, fstOutput, fstLen);
+		analysis->addAttribute(Analysis::KEY_STRUCTURE, structure);
+	}
+	if (parseBasic) {
+		const wchar_t * wclass = analysis->getValue(Analysis::KEY_CLASS);
+		const wchar_t * sijamuoto = analysis->getValue(Analysis::KEY_SIJAMUOTO);
+		const wchar_t * mood = analysis->getValue(Analysis::KEY_MOOD);
+		const wchar_t * participle = analysis->getValue(Analysis::KEY_PARTICIPLE);
+		if (analysis->getValue(Analysis::KEY_NEGATIVE) && ((wclass && wcscmp(wclass, L"teonsana") != 0) ||
+		    (mood && (wcscmp(mood, L"MINEN-infinitive") == 0 || wcscmp(mood, L"E-infinitive") == 0 || wcscmp(mood, L"MA-infinitive") == 0))
+		)) {
+			analysis->removeAttribute(Analysis::KEY_NEGATIVE);
+		}
+		if (participle && wcscmp(participle, L"past_passive") == 0 && (!wclass || wcscmp(participle, L"laatusana") != 0)) {
+			wclass = L"laatusana";
+			analysis->removeAttribute(Analysis::KEY_CLASS);
+			analysis->addAttribute(Analysis::KEY_CLASS, StringUtils::copy(wclass));
+		}
+		if (analysis->getValue(Analysis::KEY_NUMBER) && sijamuoto && wcscmp(sijamuoto, L"kerrontosti") == 0) {
+			analysis->removeAttribute(Analysis::KEY_NUMBER);
+		}
+		if (!analysis->getValue(Analysis::KEY_COMPARISON)) {
+			if (wclass && (wcscmp(wclass, L"laatusana") == 0 || wcscmp(wclass, L"nimisana_laatusana") == 0)) {
+				analysis->addAttribute(Analysis::KEY_COMPARISON, StringUtils::copy(L"positive"));
+			}
+		}
+		else if (wclass && (wcscmp(wclass, L"nimisana") == 0)) {
+			analysis->removeAttribute(Analysis::KEY_COMPARISON);
+		}
+	}
+	Analysis * orgName = 0;
+	if (parseBasic) {
+		orgName = duplicateOrgName(analysis, fstOutput);
+	}
+	if (structure && (keyMask & Analysis::keyBit(Analysis::KEY_BASEFORM))) {
+		wchar_t * baseform = parseBaseform(fstOutput, fstLen, structure);
+		if (baseform) {
+			analysis->addAttribute(Analysis::KEY_BASEFORM, baseform);
+		}
+	}
+	if (keyMask & (Analysis::keyBit(Analysis::KEY_WORDBASES) | Analysis::keyBit(Analysis::KEY_WORDIDS))) {
+		parseDebugAttributes(analysis, fstOutput, fstLen);
+	}
+	if (keyMask & Analysis::keyBit(Analysis::KEY_FSTOUTPUT)) {
+		analysis->addAttribute(Analysis::KEY_FSTOUTPUT, fstOutput);
+	}
+	else {
+		delete[] fstOutput;
+	}
+	return orgName;
+}
+
+list<Analysis *> * FinnishVfstAnalyzer::analyzeKeys(const wchar_t * word, size_t wlen, uint32_t keyMask) {
+	list<Analysis *> * analysisList = new list<Analysis *>();
+	char * wordLower = lowerCaseWord(word, wlen);
 	if (!wordLower) {
 		return analysisList;
 	}
 	
-	if (transducer->prepare(configuration, wordLower, strlen(wordLower))) {
+	if (prepareLookup(wordLower)) {
 		int analysisCount = 0;
-		while (++analysisCount < MAX_ANALYSIS_COUNT && transducer->next(configuration, outputBuffer, BUFFER_SIZE)) {
+		while (++analysisCount < MAX_ANALYSIS_COUNT && nextLookupResult()) {
 			wchar_t * fstOutput = StringUtils::ucs4FromUtf8(outputBuffer);
 			size_t fstLen = wcslen(fstOutput);
 			if (!isValidAnalysis(fstOutput, fstLen)) {
@@ -1056,60 +1240,61 @@ list<Analysis *> * FinnishVfstAnalyzer::analyze(const wchar_t * word, size_t wle
 				continue;
 			}
 			Analysis * analysis = new Analysis();
-			wchar_t * structure = parseStructure(fstOutput, wlen);
-			parseBasicAttributes(analysis, fstOutput, fstLen);
-			fixStructure(structure, fstOutput, fstLen);
-			analysis->addAttribute("STRUCTURE", structure);
-			const wchar_t * wclass = analysis->getValue("CLASS");
-			const wchar_t * sijamuoto = analysis->getValue("SIJAMUOTO");
-			const wchar_t * mood = analysis->getValue("MOOD");
-			const wchar_t * participle = analysis->getValue("PARTICIPLE");
-			if (analysis->getValue("NEGATIVE") && ((wclass && wcscmp(wclass, L"teonsana") != 0) ||
-			    (mood && (wcscmp(mood, L"MINEN-infinitive") == 0 || wcscmp(mood, L"E-infinitive") == 0 || wcscmp(mood, L"MA-infinitive") == 0))
-			)) {
-				analysis->removeAttribute("NEGATIVE");
-			}
-			if (participle && wcscmp(participle, L"past_passive") == 0 && (!wclass || wcscmp(participle, L"laatusana") != 0)) {
-				wclass = L"laatusana";
-				analysis->removeAttribute("CLASS");
-				analysis->addAttribute("CLASS", StringUtils::copy(wclass));
-			}
-			if (analysis->getValue("NUMBER") && sijamuoto && wcscmp(sijamuoto, L"kerrontosti") == 0) {
-				analysis->removeAttribute("NUMBER");
-			}
-			if (!analysis->getValue("COMPARISON")) {
-				if (wclass && (wcscmp(wclass, L"laatusana") == 0 || wcscmp(wclass, L"nimisana_laatusana") == 0)) {
-					analysis->addAttribute("COMPARISON", StringUtils::copy(L"positive"));
-				}
-			}
-			else if (wclass && (wcscmp(wclass, L"nimisana") == 0)) {
-				analysis->removeAttribute("COMPARISON");
-			}
+			Analysis * orgName = fillAnalysis(analysis, fstOutput, fstLen, wlen, keyMask);
 			analysisList->push_back(analysis);
-			duplicateOrgName(analysis, fstOutput, analysisList);
-			if (fullMorphology) {
-				analysis->addAttribute("FSTOUTPUT", fstOutput);
-				wchar_t * baseform = parseBaseform(fstOutput, fstLen, structure);
-				if (baseform) {
-					analysis->addAttribute("BASEFORM", baseform);
-				}
-				parseDebugAttributes(analysis, fstOutput, fstLen);
+			if (orgName) {
+				analysisList->push_back(orgName);
 			}
-			else {
+		}
+	}
+	
+	delete[] wordLower;
+	return analysisList;
+}
+
+void FinnishVfstAnalyzer::analyze(const wchar_t * word, size_t wlen, uint32_t keyMask, AnalysisVisitor & visitor) {
+	char * wordLower = lowerCaseWord(word, wlen);
+	if (!wordLower) {
+		return;
+	}
+	
+	if (prepareLookup(wordLower)) {
+		int analysisCount = 0;
+		bool visitMore = true;
+		while (visitMore && ++analysisCount < MAX_ANALYSIS_COUNT && nextLookupResult()) {
+			wchar_t * fstOutput = StringUtils::ucs4FromUtf8(outputBuffer);
+			size_t fstLen = wcslen(fstOutput);
+			if (!isValidAnalysis(fstOutput, fstLen)) {
 				delete[] fstOutput;
+				continue;
+			}
+			Analysis analysis;
+			Analysis * orgName = fillAnalysis(&analysis, fstOutput, fstLen, wlen, keyMask);
+			analysis.retainAttributes(keyMask);
+			visitMore = visitor.visit(analysis);
+			if (orgName) {
+				orgName->retainAttributes(keyMask);
+				visitMore = visitMore && visitor.visit(*orgName);
+				delete orgName;
 			}
 		}
 	}
 	
 	delete[] wordLower;
-	return analysisList;
 }
 
 void FinnishVfstAnalyzer::terminate() {
+	delete[] completionBuffer;
+	delete completionConfiguration;
 	delete[] outputBuffer;
+	delete frontier;
 	delete configuration;
-	transducer->terminate();
-	delete transducer;
+	if (compactTransducer) {
+		TransducerRegistry::release(compactTransducer);
+	}
+	else {
+		TransducerRegistry::release(transducer);
+	}
 }
 
 } }
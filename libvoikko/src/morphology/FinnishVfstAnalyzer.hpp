@@ -32,6 +32,7 @@
 #include "morphology/Analyzer.hpp"
 #include "setup/DictionaryException.hpp"
 #include "fst/UnweightedTransducer.hpp"
+#include "fst/CompactTransducer.hpp"
 #include "fst/Configuration.hpp"
 #include <list>
 #include <string>
@@ -46,11 +47,27 @@ class FinnishVfstAnalyzer : public Analyzer {
 		FinnishVfstAnalyzer(const std::string & directoryName) throw(setup::DictionaryException);
 		std::list<Analysis *> * analyze(const wchar_t * word, size_t wlen, bool fullMorphology);
 		std::list<Analysis *> * analyze(const char * word, bool fullMorphology);
+		std::list<Analysis *> * analyze(const wchar_t * word, size_t wlen, uint32_t keyMask);
+		void analyze(const wchar_t * word, size_t wlen, uint32_t keyMask, AnalysisVisitor & visitor);
+		void setPrefixSharing(bool enabled);
+		bool listWords(const wchar_t * prefix, size_t plen, WordVisitor & visitor);
 		void terminate();
 	private:
-		fst::UnweightedTransducer * transducer;
+		/** Transducer in the original format, null if the dictionary uses the compact format */
+		const fst::UnweightedTransducer * transducer;
+		/** Transducer in the compact format, null if the dictionary uses the original format */
+		const fst::CompactTransducer * compactTransducer;
 		fst::Configuration * configuration;
+		/** Saved traversal states of the previous word if prefix sharing is enabled, otherwise null */
+		fst::PrefixFrontier * frontier;
 		char * outputBuffer;
+		/**
+		 * Configuration and buffer for listWords, created when first needed. The
+		 * visitor may analyze the listed words, so these are separate from the
+		 * ones used for analysis.
+		 */
+		fst::Configuration * completionConfiguration;
+		char * completionBuffer;
 		std::map<std::wstring, std::wstring> classMap;
 		std::map<std::wstring, std::wstring> sijamuotoMap;
 		std::map<std::wstring, std::wstring> moodMap;
@@ -63,9 +80,26 @@ class FinnishVfstAnalyzer : public Analyzer {
 		std::map<std::wstring, std::wstring> negativeMap;
 		std::map<std::wstring, std::wstring> participleMap;
 		
+		/**
+		 * Analyzes given word, parsing only what is needed for the attributes
+		 * in keyMask. Some other attributes may be included in the results.
+		 */
+		std::list<Analysis *> * analyzeKeys(const wchar_t * word, size_t wlen, uint32_t keyMask);
+		char * lowerCaseWord(const wchar_t * word, size_t wlen);
+		/**
+		 * Adds the attributes in keyMask parsed from fstOutput to analysis and takes
+		 * ownership of fstOutput. Returns the second analysis of an organization
+		 * name (see duplicateOrgName) or null pointer if there is none.
+		 */
+		Analysis * fillAnalysis(Analysis * analysis, wchar_t * fstOutput, size_t fstLen,
+		                        size_t wlen, uint32_t keyMask);
+		bool prepareLookup(const char * word);
+		bool nextLookupResult();
+		bool prepareCompletions(const char * prefix, size_t completionLength);
+		bool nextCompletion();
 		void parseBasicAttributes(Analysis * analysis, const wchar_t * fstOutput, size_t fstLen);
 		void parseDebugAttributes(Analysis * analysis, const wchar_t * fstOutput, size_t fstLen);
-		void duplicateOrgName(Analysis * analysis, const wchar_t * fstOutput, std::list<Analysis *> * analysisList);
+		Analysis * duplicateOrgName(Analysis * analysis, const wchar_t * fstOutput);
 };
 
 } }
@@ -80,12 +80,12 @@ static void addSingleAnalysis(wstring analysisString, list<Analysis *> * analysi
 	bool isNp = false;
 	if (analysisString.find(L"<np>") != wstring::npos) {
 		isNp = true;
-		analysis->addAttribute("CLASS", utils::StringUtils::copy(L"nimi"));
+		analysis->addAttribute(Analysis::KEY_CLASS, utils::StringUtils::copy(L"nimi"));
 	} else if (analysisString.find(L"<adj>") != wstring::npos) {
-		analysis->addAttribute("CLASS", utils::StringUtils::copy(L"LAATUSANA"));
+		analysis->addAttribute(Analysis::KEY_CLASS, utils::StringUtils::copy(L"LAATUSANA"));
 	} else {
 		// TODO other categories from http://wiki.apertium.org/wiki/List_of_symbols
-		analysis->addAttribute("CLASS", utils::StringUtils::copy(L"LAATUSANA"));
+		analysis->addAttribute(Analysis::KEY_CLASS, utils::StringUtils::copy(L"LAATUSANA"));
 	}
 	wchar_t * structure = new wchar_t[charCount + 2];
 	structure[0] = L'=';
@@ -94,9 +94,9 @@ static void addSingleAnalysis(wstring analysisString, list<Analysis *> * analysi
 		structure[i] = L'p';
 	}
 	structure[charCount + 1] = L'\0';
-	analysis->addAttribute("STRUCTURE", structure);
+	analysis->addAttribute(Analysis::KEY_STRUCTURE, structure);
 	
-	analysis->addAttribute("SIJAMUOTO", utils::StringUtils::copy(L"none"));
+	analysis->addAttribute(Analysis::KEY_SIJAMUOTO, utils::StringUtils::copy(L"none"));
 	analysisList->push_back(analysis);
 }
 
@@ -28,6 +28,7 @@
 
 #include "morphology/VfstAnalyzer.hpp"
 #include "setup/DictionaryException.hpp"
+#include "fst/TransducerRegistry.hpp"
 #include "utils/StringUtils.hpp"
 #include "character/SimpleChar.hpp"
 #include "utils/utils.hpp"
@@ -54,11 +55,22 @@ static const int MAX_ANALYSIS_COUNT = 100;
 VfstAnalyzer::VfstAnalyzer(const string & directoryName) throw(setup::DictionaryException) {
 	string morFile = directoryName + "/mor.vfst";
 	// XXX: could handle different types of transducers
-	transducer = new WeightedTransducer(morFile.c_str());
+	transducer = TransducerRegistry::acquireWeighted(morFile);
 	configuration = new WeightedConfiguration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	frontier = 0;
 	outputBuffer = new char[BUFFER_SIZE];
 }
 
+void VfstAnalyzer::setPrefixSharing(bool enabled) {
+	if (enabled && !frontier) {
+		frontier = new PrefixFrontier(transducer->getFlagDiacriticFeatureCount());
+	}
+	else if (!enabled) {
+		delete frontier;
+		frontier = 0;
+	}
+}
+
 list<Analysis *> * VfstAnalyzer::analyze(const char * word, bool fullMorphology) {
 	wchar_t * wordUcs4 = StringUtils::ucs4FromUtf8(word);
 	list<Analysis *> * result = analyze(wordUcs4, wcslen(wordUcs4), fullMorphology);
@@ -82,19 +94,23 @@ list<Analysis *> * VfstAnalyzer::analyze(const wchar_t * word, size_t wlen, bool
 	delete[] wordLowerUcs4;
 	
 	list<Analysis *> * analysisList = new list<Analysis *>();
-	if (transducer->prepare(configuration, wordLower, strlen(wordLower))) {
+	size_t lowerLen = strlen(wordLower);
+	if (frontier ? transducer->prepare(configuration, frontier, wordLower, lowerLen) :
+	               transducer->prepare(configuration, wordLower, lowerLen)) {
 		int analysisCount = 0;
 		int16_t weight;
-		while (++analysisCount < MAX_ANALYSIS_COUNT && transducer->next(configuration, outputBuffer, BUFFER_SIZE, &weight)) {
+		while (++analysisCount < MAX_ANALYSIS_COUNT && (frontier ?
+		       transducer->next(configuration, frontier, outputBuffer, BUFFER_SIZE, &weight) :
+		       transducer->next(configuration, outputBuffer, BUFFER_SIZE, &weight))) {
 			Analysis * analysis = new Analysis();
 			if (fullMorphology) {
 				wchar_t * fstOutput = StringUtils::ucs4FromUtf8(outputBuffer);
-				analysis->addAttribute("FSTOUTPUT", fstOutput);
+				analysis->addAttribute(Analysis::KEY_FSTOUTPUT, fstOutput);
 			}
 			stringstream ss;
 			ss << setprecision(9) << logWeightToProb(weight);
 			string weightStr = ss.str();
-			analysis->addAttribute("WEIGHT", StringUtils::ucs4FromUtf8(weightStr.c_str()));
+			analysis->addAttribute(Analysis::KEY_WEIGHT, StringUtils::ucs4FromUtf8(weightStr.c_str()));
 			analysisList->push_back(analysis);
 		}
 	}
@@ -105,9 +121,9 @@ list<Analysis *> * VfstAnalyzer::analyze(const wchar_t * word, size_t wlen, bool
 
 void VfstAnalyzer::terminate() {
 	delete[] outputBuffer;
+	delete frontier;
 	delete configuration;
-	transducer->terminate();
-	delete transducer;
+	TransducerRegistry::release(transducer);
 }
 
 } }
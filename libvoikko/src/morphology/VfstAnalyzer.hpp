@@ -46,10 +46,13 @@ class VfstAnalyzer : public Analyzer {
 		VfstAnalyzer(const std::string & directoryName) throw(setup::DictionaryException);
 		std::list<Analysis *> * analyze(const wchar_t * word, size_t wlen, bool fullMorphology);
 		std::list<Analysis *> * analyze(const char * word, bool fullMorphology);
+		void setPrefixSharing(bool enabled);
 		void terminate();
 	private:
-		fst::WeightedTransducer * transducer;
+		const fst::WeightedTransducer * transducer;
 		fst::WeightedConfiguration * configuration;
+		/** Saved traversal states of the previous word if prefix sharing is enabled, otherwise null */
+		fst::PrefixFrontier * frontier;
 		char * outputBuffer;
 };
 
@@ -27,6 +27,7 @@
  *********************************************************************************/
 
 #include "porting.h"
+#include "voikko_defines.h"
 #include "morphology/Analysis.hpp"
 #include "morphology/Analyzer.hpp"
 #include "setup/setup.hpp"
@@ -55,6 +56,66 @@ VOIKKOEXPORT voikko_mor_analysis ** voikkoAnalyzeWordUcs4(
 	return result;
 }
 
+static const struct {
+	int attribute;
+	Analysis::Key key;
+} ATTRIBUTE_KEYS[] = {
+	{ VOIKKO_ATTRIBUTE_BASEFORM, Analysis::KEY_BASEFORM },
+	{ VOIKKO_ATTRIBUTE_CLASS, Analysis::KEY_CLASS },
+	{ VOIKKO_ATTRIBUTE_COMPARISON, Analysis::KEY_COMPARISON },
+	{ VOIKKO_ATTRIBUTE_FOCUS, Analysis::KEY_FOCUS },
+	{ VOIKKO_ATTRIBUTE_FSTOUTPUT, Analysis::KEY_FSTOUTPUT },
+	{ VOIKKO_ATTRIBUTE_KYSYMYSLIITE, Analysis::KEY_KYSYMYSLIITE },
+	{ VOIKKO_ATTRIBUTE_MALAGA_VAPAA_JALKIOSA, Analysis::KEY_MALAGA_VAPAA_JALKIOSA },
+	{ VOIKKO_ATTRIBUTE_MOOD, Analysis::KEY_MOOD },
+	{ VOIKKO_ATTRIBUTE_NEGATIVE, Analysis::KEY_NEGATIVE },
+	{ VOIKKO_ATTRIBUTE_NUMBER, Analysis::KEY_NUMBER },
+	{ VOIKKO_ATTRIBUTE_PARTICIPLE, Analysis::KEY_PARTICIPLE },
+	{ VOIKKO_ATTRIBUTE_PERSON, Analysis::KEY_PERSON },
+	{ VOIKKO_ATTRIBUTE_POSSESSIVE, Analysis::KEY_POSSESSIVE },
+	{ VOIKKO_ATTRIBUTE_POSSIBLE_GEOGRAPHICAL_NAME, Analysis::KEY_POSSIBLE_GEOGRAPHICAL_NAME },
+	{ VOIKKO_ATTRIBUTE_REQUIRE_FOLLOWING_VERB, Analysis::KEY_REQUIRE_FOLLOWING_VERB },
+	{ VOIKKO_ATTRIBUTE_SIJAMUOTO, Analysis::KEY_SIJAMUOTO },
+	{ VOIKKO_ATTRIBUTE_STRUCTURE, Analysis::KEY_STRUCTURE },
+	{ VOIKKO_ATTRIBUTE_TENSE, Analysis::KEY_TENSE },
+	{ VOIKKO_ATTRIBUTE_WEIGHT, Analysis::KEY_WEIGHT },
+	{ VOIKKO_ATTRIBUTE_WORDBASES, Analysis::KEY_WORDBASES },
+	{ VOIKKO_ATTRIBUTE_WORDIDS, Analysis::KEY_WORDIDS }
+};
+
+VOIKKOEXPORT voikko_mor_analysis ** voikkoAnalyzeWordMaskUcs4(
+                                    voikko_options_t * options, const wchar_t * word, int attributes) {
+	uint32_t keyMask = 0;
+	for (size_t i = 0; i < sizeof(ATTRIBUTE_KEYS) / sizeof(ATTRIBUTE_KEYS[0]); i++) {
+		if (attributes & ATTRIBUTE_KEYS[i].attribute) {
+			keyMask |= Analysis::keyBit(ATTRIBUTE_KEYS[i].key);
+		}
+	}
+	Analyzer * analyzer = options->morAnalyzer;
+	list<Analysis *> * analyses = analyzer->analyze(word, wcslen(word), keyMask);
+	voikko_mor_analysis ** result
+	    = new voikko_mor_analysis*[analyses->size() + 1];
+	list<Analysis *>::const_iterator it = analyses->begin();
+	size_t i = 0;
+	while (it != analyses->end()) {
+		result[i++] = *it++;
+	}
+	result[i] = 0;
+	delete analyses;
+	return result;
+}
+
+VOIKKOEXPORT void voikkoAnalyzeWordBatchUcs4(voikko_options_t * options, const wchar_t * const * words,
+                                             size_t wordCount, voikko_mor_analysis *** results) {
+	// Continuing from shared prefixes only pays off when words are sorted
+	bool sorted = utils::StringUtils::isSorted(words, wordCount);
+	options->morAnalyzer->setPrefixSharing(sorted);
+	for (size_t i = 0; i < wordCount; i++) {
+		results[i] = words[i] ? voikkoAnalyzeWordUcs4(options, words[i]) : 0;
+	}
+	options->morAnalyzer->setPrefixSharing(false);
+}
+
 VOIKKOEXPORT void voikko_free_mor_analysis(voikko_mor_analysis ** analysis) {
 	if (!analysis) {
 		return;
@@ -94,6 +155,35 @@ VOIKKOEXPORT voikko_mor_analysis ** voikkoAnalyzeWordCstr(
 	return result;
 }
 
+VOIKKOEXPORT voikko_mor_analysis ** voikkoAnalyzeWordMaskCstr(
+                                    voikko_options_t * options, const char * word, int attributes) {
+	if (word == 0 || word[0] == '\0') {
+		return 0;
+	}
+	size_t len = strlen(word);
+	if (len > LIBVOIKKO_MAX_WORD_CHARS) {
+		return 0;
+	}
+	wchar_t * word_ucs4 = utils::StringUtils::ucs4FromUtf8(word, len);
+	if (word_ucs4 == 0) {
+		return 0;
+	}
+	voikko_mor_analysis ** result = voikkoAnalyzeWordMaskUcs4(options, word_ucs4, attributes);
+	delete[] word_ucs4;
+	return result;
+}
+
+VOIKKOEXPORT void voikkoAnalyzeWordBatchCstr(voikko_options_t * options, const char * const * words,
+                                             size_t wordCount, voikko_mor_analysis *** results) {
+	// Continuing from shared prefixes only pays off when words are sorted
+	bool sorted = utils::StringUtils::isSorted(words, wordCount);
+	options->morAnalyzer->setPrefixSharing(sorted);
+	for (size_t i = 0; i < wordCount; i++) {
+		results[i] = voikkoAnalyzeWordCstr(options, words[i]);
+	}
+	options->morAnalyzer->setPrefixSharing(false);
+}
+
 VOIKKOEXPORT char * voikko_mor_analysis_value_cstr(
                 const voikko_mor_analysis * analysis,
                 const char * key) {
@@ -81,11 +81,8 @@ voikko_sentence_type Sentence::next(voikko_options_t * options,
 	bool end_dotword = false;
 	bool possible_end_punctuation = false;
 	while (token != TOKEN_NONE && textlen > slen) {
-		int ignore_dot_saved = options->ignore_dot;
-		options->ignore_dot = 0;
-		token = tokenizer::Tokenizer::nextToken(options, text + slen,
-		                               textlen - slen, &tokenlen);
-		options->ignore_dot = ignore_dot_saved;
+		token = tokenizer::Tokenizer::nextToken(text + slen, textlen - slen,
+		                                        &tokenlen, false);
 		if (end_found && !in_quotation) {
 			if (token != TOKEN_WHITESPACE) {
 				*sentencelen = slen;
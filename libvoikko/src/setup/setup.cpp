@@ -37,6 +37,8 @@
 #include "grammar/GrammarCheckerFactory.hpp"
 #include "spellchecker/suggestion/SuggestionGeneratorFactory.hpp"
 #include "hyphenator/HyphenatorFactory.hpp"
+#include "fst/TransducerRegistry.hpp"
+#include "fst/CompactTransducer.hpp"
 #include <cstring>
 #include <sys/stat.h>
 #include <cstdlib>
@@ -66,6 +68,35 @@ static int setGrammarOption(voikko_options_t * handle, int value, int * option)
 		return 1;
 }
 
+/**
+ * Sets an option that affects the results of Speller. Cached spelling
+ * results are discarded when the value changes.
+ */
+static int setSpellerOption(voikko_options_t * handle, int value, int * option) {
+	int newValue = (value ? 1 : 0);
+	if (newValue != *option) {
+		*option = newValue;
+		if (handle->spellerCache) {
+			handle->spellerCache->clear();
+		}
+	}
+	return 1;
+}
+
+static int setSpellerCacheSize(voikko_options_t * handle, size_t sizeInBytes) {
+	if (handle->spellerCache && handle->spellerCache->getSizeInBytes() == sizeInBytes) {
+		return 1;
+	}
+	delete handle->spellerCache;
+	if (sizeInBytes > 0) {
+		handle->spellerCache = new spellchecker::SpellerCache(sizeInBytes);
+	}
+	else {
+		handle->spellerCache = 0;
+	}
+	return 1;
+}
+
 VOIKKOEXPORT int voikkoSetBooleanOption(voikko_options_t * options, int option, int value) {
 	switch (option) {
 		case VOIKKO_OPT_IGNORE_DOT:
@@ -112,11 +143,11 @@ VOIKKOEXPORT int voikkoSetBooleanOption(voikko_options_t * options, int option,
 			options->ignore_nonwords = (value ? 1 : 0);
 			return 1;
 		case VOIKKO_OPT_ACCEPT_EXTRA_HYPHENS:
-			options->accept_extra_hyphens = (value ? 1 : 0);
-			return 1;
+			return setSpellerOption(options, value,
+			       &(options->accept_extra_hyphens));
 		case VOIKKO_OPT_ACCEPT_MISSING_HYPHENS:
-			options->accept_missing_hyphens = (value ? 1 : 0);
-			return 1;
+			return setSpellerOption(options, value,
+			       &(options->accept_missing_hyphens));
 		case VOIKKO_OPT_ACCEPT_TITLES_IN_GC:
 			return setGrammarOption(options, value,
 			       &(options->accept_titles_in_gc));
@@ -144,31 +175,45 @@ VOIKKOEXPORT int voikkoSetIntegerOption(voikko_options_t * options, int option,
 			options->hyphenator->setMinHyphenatedWordLength(value);
 			return 1;
 		case VOIKKO_SPELLER_CACHE_SIZE:
-			if (options->spellerCache) {
-				if (options->spellerCache->getSizeParam() != value) {
-					delete options->spellerCache;
-					if (value >= 0) {
-						options->spellerCache = new spellchecker::SpellerCache(value);
-					} else {
-						options->spellerCache = 0;
-					}
-				}
-			} else {
-				if (value >= 0) {
-					options->spellerCache = new spellchecker::SpellerCache(value);
-				}
+			if (value >= 0) {
+				return setSpellerCacheSize(options,
+				       spellchecker::SpellerCache::sizeInBytesForSizeParam(value));
 			}
-			return 1;
+			return setSpellerCacheSize(options, 0);
+		case VOIKKO_SPELLER_CACHE_BYTES:
+			if (value < 0) {
+				return 0;
+			}
+			return setSpellerCacheSize(options, static_cast<size_t>(value));
+		case VOIKKO_TRANSDUCER_RESIDENCY:
+			if (value < 0 || value > (VOIKKO_RESIDENCY_WILLNEED | VOIKKO_RESIDENCY_PREFAULT |
+			    VOIKKO_RESIDENCY_RANDOM | VOIKKO_RESIDENCY_HUGEPAGE | VOIKKO_RESIDENCY_LOCK)) {
+				return 0;
+			}
+			return fst::TransducerRegistry::setResidency(value) ? 1 : 0;
 	}
 	return 0;
 }
 
-VOIKKOEXPORT voikko_options_t * voikkoInit(const char ** error, const char * langcode,
-                                   const char * path) {
-	if (!langcode) {
-		*error = "Language must not be null";
+VOIKKOEXPORT int voikkoGetTransducerMemoryUsage(voikko_options_t * options, size_t index, char * fileName,
+                                                size_t fileNameSize, size_t * mappedBytes, size_t * residentBytes) {
+	(void)(options);
+	string filePath;
+	if (!fst::TransducerRegistry::getMemoryUsage(index, filePath, *mappedBytes, *residentBytes)) {
 		return 0;
 	}
+	if (fileName && fileNameSize > 0) {
+		strncpy(fileName, filePath.c_str(), fileNameSize - 1);
+		fileName[fileNameSize - 1] = '\0';
+	}
+	return 1;
+}
+
+/**
+ * Creates a handle with default options and components for given dictionary.
+ * Returns null pointer and sets error if initialization fails.
+ */
+static voikko_options_t * createHandle(const char ** error, const Dictionary & dict) {
 	voikko_options_t * options = new voikko_options_t();
 	options->ignore_dot = 0;
 	options->ignore_numbers = 0;
@@ -184,22 +229,15 @@ VOIKKOEXPORT voikko_options_t * voikkoInit(const char ** error, const char * lan
 	options->morAnalyzer = 0;
 	options->grammarChecker = 0;
 	options->speller = 0;
+	options->frequentWords = 0;
 	options->suggestionGenerator = 0;
 	options->hyphenator = 0;
 	options->hfst = 0;
 	
 	try {
-		options->morAnalyzer = 0;
-		options->speller = 0;
-		Dictionary dict;
-		if (path) {
-			dict = DictionaryFactory::load(string(langcode), string(path));
-		}
-		else {
-			dict = DictionaryFactory::load(string(langcode));
-		}
 		options->dictionary = dict;
 		options->morAnalyzer = morphology::AnalyzerFactory::getAnalyzer(dict);
+		options->frequentWords = spellchecker::FrequentWordTable::acquire(dict.getMorBackend().getPath());
 		options->speller = spellchecker::SpellerFactory::getSpeller(options, dict);
 		options->suggestionGenerator =
 			spellchecker::suggestion::SuggestionGeneratorFactory::getSuggestionGenerator(options,
@@ -220,6 +258,7 @@ VOIKKOEXPORT voikko_options_t * voikkoInit(const char ** error, const char * lan
 			delete options->speller;
 			options->speller = 0;
 		}
+		spellchecker::FrequentWordTable::release(options->frequentWords);
 		if (options->morAnalyzer) {
 			options->morAnalyzer->terminate();
 			delete options->morAnalyzer;
@@ -230,11 +269,140 @@ VOIKKOEXPORT voikko_options_t * voikkoInit(const char ** error, const char * lan
 		return 0;
 	}
 	
-	options->spellerCache = new spellchecker::SpellerCache(0);
+	options->spellerCache = new spellchecker::SpellerCache(
+	                        spellchecker::SpellerCache::sizeInBytesForSizeParam(0));
 	*error = 0;
 	return options;
 }
 
+static bool loadDictionary(const char ** error, Dictionary & dict, const char * langcode,
+                           const char * path) {
+	if (!langcode) {
+		*error = "Language must not be null";
+		return false;
+	}
+	try {
+		if (path) {
+			dict = DictionaryFactory::load(string(langcode), string(path));
+		}
+		else {
+			dict = DictionaryFactory::load(string(langcode));
+		}
+	}
+	catch (DictionaryException & e) {
+		*error = e.what();
+		return false;
+	}
+	return true;
+}
+
+VOIKKOEXPORT voikko_options_t * voikkoInit(const char ** error, const char * langcode,
+                                   const char * path) {
+	Dictionary dict;
+	if (!loadDictionary(error, dict, langcode, path)) {
+		return 0;
+	}
+	return createHandle(error, dict);
+}
+
+/**
+ * Returns true if the backend is one whose data can be shared between
+ * sessions. VFST transducers are shared through TransducerRegistry and the
+ * other listed backends have no data of their own. Malaga, HFST, lttoolbox
+ * and VISL CG-3 backends would be loaded again for each session and they
+ * have not been verified to be safe for concurrent use.
+ */
+static bool isSessionSafeBackend(const BackendProperties & backend) {
+	static const char * const SAFE_BACKENDS[] = {
+		"", "null", "vfst", "finnishVfst", "finnish", "AllOk", "AllError",
+		"AnalyzerToSpellerAdapter(currentAnalyzer)",
+		"FinnishSpellerTweaksWrapper(AnalyzerToSpellerAdapter(currentAnalyzer),currentAnalyzer)",
+		"FinnishSuggestionStrategy(currentAnalyzer)",
+		"AnalyzerToFinnishHyphenatorAdapter(currentAnalyzer)"
+	};
+	const string & name = backend.getBackend();
+	for (size_t i = 0; i < sizeof(SAFE_BACKENDS) / sizeof(SAFE_BACKENDS[0]); i++) {
+		if (name == SAFE_BACKENDS[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void releaseSharedData(voikko_shared_t * shared) {
+	for (size_t i = 0; i < shared->transducers.size(); i++) {
+		fst::TransducerRegistry::release(shared->transducers[i]);
+	}
+	shared->transducers.clear();
+	spellchecker::FrequentWordTable::release(shared->frequentWords);
+	shared->frequentWords = 0;
+}
+
+/**
+ * Loads the transducers that the components of a session would load for
+ * given dictionary, so that the sessions can share them.
+ */
+static void acquireSharedData(voikko_shared_t * shared) throw(DictionaryException) {
+	const Dictionary & dict = shared->dictionary;
+	const string & morBackend = dict.getMorBackend().getBackend();
+	const string morPath = dict.getMorBackend().getPath();
+	const string morFile = morPath + "/mor.vfst";
+	if (morBackend == "vfst") {
+		shared->transducers.push_back(fst::TransducerRegistry::acquireWeighted(morFile));
+	}
+	else if (morBackend == "finnishVfst") {
+		if (fst::CompactTransducer::isCompactTransducerFile(morFile.c_str())) {
+			shared->transducers.push_back(fst::TransducerRegistry::acquireCompact(morFile));
+		}
+		else {
+			shared->transducers.push_back(fst::TransducerRegistry::acquireUnweighted(morFile));
+		}
+	}
+	if (dict.getSpellBackend().getBackend() == "vfst") {
+		shared->transducers.push_back(fst::TransducerRegistry::acquireWeighted(morPath + "/spl.vfst"));
+	}
+	if (dict.getSuggestionBackend().getBackend() == "vfst") {
+		shared->transducers.push_back(fst::TransducerRegistry::acquireWeighted(morPath + "/err.vfst"));
+	}
+	if (dict.getGrammarBackend().getBackend() == "finnishVfst") {
+		shared->transducers.push_back(fst::TransducerRegistry::acquireUnweighted(
+		                              dict.getGrammarBackend().getPath() + "/autocorr.vfst"));
+	}
+	shared->frequentWords = spellchecker::FrequentWordTable::acquire(morPath);
+}
+
+VOIKKOEXPORT voikko_shared_t * voikkoInitShared(const char ** error, const char * langcode,
+                                   const char * path) {
+	Dictionary dict;
+	if (!loadDictionary(error, dict, langcode, path)) {
+		return 0;
+	}
+	if (!isSessionSafeBackend(dict.getMorBackend()) || !isSessionSafeBackend(dict.getGramMorBackend()) ||
+	    !isSessionSafeBackend(dict.getSpellBackend()) || !isSessionSafeBackend(dict.getSuggestionBackend()) ||
+	    !isSessionSafeBackend(dict.getHyphenatorBackend()) || !isSessionSafeBackend(dict.getGrammarBackend())) {
+		*error = "Shared dictionaries are only supported for dictionaries that use VFST backends";
+		return 0;
+	}
+	voikko_shared_t * shared = new voikko_shared_t();
+	shared->dictionary = dict;
+	shared->frequentWords = 0;
+	try {
+		acquireSharedData(shared);
+	}
+	catch (DictionaryException & e) {
+		releaseSharedData(shared);
+		delete shared;
+		*error = e.what();
+		return 0;
+	}
+	*error = 0;
+	return shared;
+}
+
+VOIKKOEXPORT voikko_options_t * voikkoCreateSession(voikko_shared_t * shared, const char ** error) {
+	return createHandle(error, shared->dictionary);
+}
+
 VOIKKOEXPORT void voikkoTerminate(voikko_options_t * handle) {
 	delete handle->grammarChecker;
 	handle->hyphenator->terminate();
@@ -243,10 +411,16 @@ VOIKKOEXPORT void voikkoTerminate(voikko_options_t * handle) {
 	delete handle->suggestionGenerator;
 	handle->speller->terminate();
 	delete handle->speller;
+	spellchecker::FrequentWordTable::release(handle->frequentWords);
 	handle->morAnalyzer->terminate();
 	delete handle->morAnalyzer;
 	delete handle->spellerCache;
 	delete handle;
 }
 
+VOIKKOEXPORT void voikkoTerminateShared(voikko_shared_t * shared) {
+	releaseSharedData(shared);
+	delete shared;
+}
+
 }
@@ -36,10 +36,13 @@
 #include "morphology/Analyzer.hpp"
 #include "spellchecker/Speller.hpp"
 #include "spellchecker/SpellerCache.hpp"
+#include "spellchecker/FrequentWordTable.hpp"
 #include "grammar/GrammarChecker.hpp"
 #include "spellchecker/suggestion/SuggestionGenerator.hpp"
 #include "hyphenator/Hyphenator.hpp"
 #include "setup/Dictionary.hpp"
+#include "fst/Transducer.hpp"
+#include <vector>
 
 // TODO proper abstraction
 namespace hfst_ol {
@@ -64,12 +67,24 @@ typedef struct {
 	morphology::Analyzer * morAnalyzer;
 	spellchecker::Speller * speller;
 	spellchecker::SpellerCache * spellerCache;
+	/** Frequent words that are checked before the speller or null pointer if the dictionary has none */
+	const spellchecker::FrequentWordTable * frequentWords;
 	spellchecker::suggestion::SuggestionGenerator * suggestionGenerator;
 	hyphenator::Hyphenator * hyphenator;
 	setup::Dictionary dictionary;
 	hfst_ol::ZHfstOspeller* hfst;
 } voikko_options_t;
 
+/**
+ * Dictionary loaded with voikkoInitShared. The transducers and the frequent
+ * word table are kept loaded for as long as sessions may be created.
+ */
+typedef struct {
+	setup::Dictionary dictionary;
+	std::vector<const fst::Transducer *> transducers;
+	const spellchecker::FrequentWordTable * frequentWords;
+} voikko_shared_t;
+
 }
 
 #endif
@@ -28,40 +28,80 @@
 
 #include "spellchecker/AnalyzerToSpellerAdapter.hpp"
 #include "spellchecker/SpellUtils.hpp"
-#include <list>
 
 using namespace std;
 using namespace libvoikko::morphology;
 
 namespace libvoikko { namespace spellchecker {
 
-AnalyzerToSpellerAdapter::AnalyzerToSpellerAdapter(Analyzer * analyzer) :
-	analyzer(analyzer) { }
+AnalyzerToSpellerAdapter::AnalyzerToSpellerAdapter(Analyzer * analyzer,
+	                                           const FrequentWordTable * frequentWords) :
+	analyzer(analyzer), frequentWords(frequentWords) { }
+
+/**
+ * Keeps the best result of matching the word with the structures of its
+ * analyses and stops at the first one that matches exactly.
+ */
+class StructureMatcher : public AnalysisVisitor {
+	public:
+		StructureMatcher(const wchar_t * word, size_t wlen) :
+			word(word), wlen(wlen), bestResult(SPELL_FAILED) { }
+		
+		bool visit(const Analysis & analysis) {
+			const wchar_t * structure = analysis.getValue(Analysis::KEY_STRUCTURE);
+			spellresult result = SpellUtils::matchWordAndAnalysis(word, wlen, structure);
+			if (bestResult == SPELL_FAILED || bestResult > result) {
+				bestResult = result;
+			}
+			return bestResult != SPELL_OK;
+		}
+		
+		const wchar_t * const word;
+		const size_t wlen;
+		spellresult bestResult;
+};
 
 spellresult AnalyzerToSpellerAdapter::spell(const wchar_t * word, size_t wlen) {
-	list<Analysis *> * analyses = analyzer->analyze(word, wlen, false);
-	
-	if (analyses->empty()) {
-		Analyzer::deleteAnalyses(analyses);
-		return SPELL_FAILED;
+	spellresult result;
+	if (frequentWords && frequentWords->lookup(word, wlen, result)) {
+		return result;
 	}
-	
-	spellresult best_result = SPELL_FAILED;
-	list<Analysis *>::const_iterator it = analyses->begin();
-	while (it != analyses->end()) {
-		const wchar_t * structure = (*it)->getValue("STRUCTURE");
-		spellresult result = SpellUtils::matchWordAndAnalysis(word, wlen, structure);
-		if (best_result == SPELL_FAILED || best_result > result) {
-			best_result = result;
-		}
-		if (best_result == SPELL_OK) {
-			break;
+	StructureMatcher matcher(word, wlen);
+	analyzer->analyze(word, wlen, Analysis::keyBit(Analysis::KEY_STRUCTURE), matcher);
+	return matcher.bestResult;
+}
+
+/**
+ * Keeps the listed words that are spelled correctly and stops when maxCount
+ * of them have been found.
+ */
+class CompletionCollector : public WordVisitor {
+	public:
+		CompletionCollector(Speller * speller, size_t maxCount, list<wstring> & completions) :
+			speller(speller), maxCount(maxCount), completions(completions), foundCount(0) { }
+		
+		bool visit(const wchar_t * word, size_t wlen) {
+			if (speller->spell(word, wlen) == SPELL_OK) {
+				completions.push_back(wstring(word, wlen));
+				foundCount++;
+			}
+			return foundCount < maxCount;
 		}
-		++it;
+		
+		Speller * const speller;
+		const size_t maxCount;
+		list<wstring> & completions;
+		size_t foundCount;
+};
+
+bool AnalyzerToSpellerAdapter::complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+                                        list<wstring> & completions) {
+	if (maxCount == 0) {
+		return true;
 	}
-	Analyzer::deleteAnalyses(analyses);
-	
-	return best_result;
+	CompletionCollector collector(this, maxCount, completions);
+	// If the analyzer gave up before finding anything, no prefix can be ruled out
+	return analyzer->listWords(prefix, plen, collector) || collector.foundCount > 0;
 }
 
 void AnalyzerToSpellerAdapter::terminate() {
@@ -30,21 +30,28 @@
 #define VOIKKO_SPELLCHECKER_ANALYZER_TO_SPELLER_ADAPTER
 
 #include "spellchecker/Speller.hpp"
+#include "spellchecker/FrequentWordTable.hpp"
 #include "morphology/Analyzer.hpp"
 
 namespace libvoikko { namespace spellchecker {
 
 /**
  * Adapter that uses an existing Analyzer for spell checking. The analyzer must
- * remain operational until this adapter has been terminated.
+ * remain operational until this adapter has been terminated. Words found in
+ * the optional table of frequent words are not analyzed. Completions are the
+ * words listed by the analyzer that are spelled correctly, shortest first.
  */
 class AnalyzerToSpellerAdapter : public Speller {
 	public:
-		AnalyzerToSpellerAdapter(morphology::Analyzer * analyzer);
+		AnalyzerToSpellerAdapter(morphology::Analyzer * analyzer,
+		                         const FrequentWordTable * frequentWords = 0);
 		spellresult spell(const wchar_t * word, size_t wlen);
+		bool complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+		              std::list<std::wstring> & completions);
 		void terminate();
 	private:
 		morphology::Analyzer * const analyzer;
+		const FrequentWordTable * const frequentWords;
 };
 
 } }
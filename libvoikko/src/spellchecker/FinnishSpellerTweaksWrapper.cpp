@@ -102,11 +102,12 @@ spellresult FinnishSpellerTweaksWrapper::spellWithoutSoftHyphen(const wchar_t *
 			if (word[i] == L'-') {
 				spellresult leadingResult = spell(word, i);
 				if (leadingResult != SPELL_FAILED) {
-					list<Analysis *> * trailingAnalyses = analyzer->analyze(word + i + 1, wlen - (i + 1), false);
+					list<Analysis *> * trailingAnalyses = analyzer->analyze(word + i + 1, wlen - (i + 1),
+					        Analysis::keyBit(Analysis::KEY_MALAGA_VAPAA_JALKIOSA));
 					list<Analysis *>::const_iterator it = trailingAnalyses->begin();
 					bool isTrailingAcceptable = false;
 					while (it != trailingAnalyses->end()) {
-						const wchar_t * trailingAttr = (*it)->getValue("MALAGA_VAPAA_JALKIOSA");
+						const wchar_t * trailingAttr = (*it)->getValue(Analysis::KEY_MALAGA_VAPAA_JALKIOSA);
 						if (trailingAttr != 0 && wcscmp(trailingAttr, L"true") == 0) {
 							isTrailingAcceptable = true;
 							break;
@@ -126,7 +127,8 @@ spellresult FinnishSpellerTweaksWrapper::spellWithoutSoftHyphen(const wchar_t *
 		}
 		
 		/* Ambiguous compound ('syy-silta', 'syys-ilta') */
-		list<Analysis *> * analyses = analyzer->analyze(buffer, wcslen(buffer), false);
+		list<Analysis *> * analyses = analyzer->analyze(buffer, wcslen(buffer),
+		        Analysis::keyBit(Analysis::KEY_STRUCTURE));
 		
 		if (analyses->empty()) {
 			Analyzer::deleteAnalyses(analyses);
@@ -136,7 +138,7 @@ spellresult FinnishSpellerTweaksWrapper::spellWithoutSoftHyphen(const wchar_t *
 		
 		list<Analysis *>::const_iterator it = analyses->begin();
 		while (it != analyses->end()) {
-			const wchar_t * structure = (*it)->getValue("STRUCTURE");
+			const wchar_t * structure = (*it)->getValue(Analysis::KEY_STRUCTURE);
 			size_t j = 0;
 			size_t i;
 			for (i = 0; i < leading_len; i++) {
@@ -215,6 +217,12 @@ spellresult FinnishSpellerTweaksWrapper::spell(const wchar_t * word, size_t wlen
 	}
 }
 
+bool FinnishSpellerTweaksWrapper::complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+                                           list<std::wstring> & completions) {
+	// The tweaks only accept more words, so the words of the wrapped speller are correct
+	return speller->complete(prefix, plen, maxCount, completions);
+}
+
 void FinnishSpellerTweaksWrapper::terminate() {
 	delete hyphenator;
 	delete speller;
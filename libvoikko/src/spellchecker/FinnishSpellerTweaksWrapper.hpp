@@ -45,6 +45,8 @@ class FinnishSpellerTweaksWrapper : public Speller {
 	public:
 		FinnishSpellerTweaksWrapper(Speller * speller, morphology::Analyzer * analyzer, voikko_options_t * voikkoOptions);
 		spellresult spell(const wchar_t * word, size_t wlen);
+		bool complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+		              std::list<std::wstring> & completions);
 		void terminate();
 	private:
 		spellresult spellWithoutSoftHyphen(const wchar_t * word, size_t wlen);
@@ -0,0 +1,241 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "porting.h"
+#include "spellchecker/FrequentWordTable.hpp"
+#include "utils/Mutex.hpp"
+#include <map>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace libvoikko::utils;
+
+namespace libvoikko { namespace spellchecker {
+
+static const char * const TABLE_FILE_NAME = "/frequent.vfw";
+
+struct TableEntry {
+	const FrequentWordTable * table;
+	int referenceCount;
+};
+
+static Mutex registryMutex;
+static map<string, TableEntry> registry;
+
+/**
+ * Returns the registry key for the table in given directory or an empty string
+ * if there is no table. Modification times and sizes of the table and the
+ * transducer files are included so that a table or dictionary that has been
+ * replaced on disk is checked again.
+ */
+static string registryKey(const string & directoryName) {
+	static const char * const FILE_NAMES[] = {TABLE_FILE_NAME, "/mor.vfst", "/spl.vfst"};
+	ostringstream key;
+	key << directoryName;
+	for (size_t i = 0; i < sizeof(FILE_NAMES) / sizeof(FILE_NAMES[0]); i++) {
+		struct stat st;
+		if (stat((directoryName + FILE_NAMES[i]).c_str(), &st) == 0) {
+			key << ":" << st.st_size << ":" << st.st_mtime;
+		}
+		else if (i == 0) {
+			return string();
+		}
+		else {
+			key << ":-";
+		}
+	}
+	return key.str();
+}
+
+FrequentWordTable::FrequentWordTable(void * data, size_t length) :
+	data(data),
+	length(length),
+	header(static_cast<const FrequentWordTableHeader *>(data)),
+	seeds(reinterpret_cast<const uint32_t *>(header + 1)),
+	slots(reinterpret_cast<const FrequentWordSlot *>(seeds + header->bucketCount)),
+	pool(reinterpret_cast<const uint32_t *>(slots + header->slotCount)) {
+}
+
+static void unloadFile(void * data, size_t length) {
+	#ifdef HAVE_MMAP
+		munmap(data, length);
+	#else
+		(void)(length);
+		delete[] static_cast<char *>(data);
+	#endif
+}
+
+FrequentWordTable::~FrequentWordTable() {
+	unloadFile(data, length);
+}
+
+FrequentWordTable * FrequentWordTable::load(const string & fileName) {
+	void * data;
+	size_t length;
+	#ifdef HAVE_MMAP
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd == -1) {
+			return 0;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FrequentWordTableHeader)) {
+			close(fd);
+			return 0;
+		}
+		length = st.st_size;
+		data = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED) {
+			return 0;
+		}
+	#else
+		FILE * file = fopen(fileName.c_str(), "rb");
+		if (!file) {
+			return 0;
+		}
+		fseek(file, 0, SEEK_END);
+		long fileLength = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (fileLength < static_cast<long>(sizeof(FrequentWordTableHeader))) {
+			fclose(file);
+			return 0;
+		}
+		length = fileLength;
+		data = new char[length];
+		size_t readLength = fread(data, 1, length, file);
+		fclose(file);
+		if (readLength != length) {
+			delete[] static_cast<char *>(data);
+			return 0;
+		}
+	#endif
+	const FrequentWordTableHeader * header = static_cast<const FrequentWordTableHeader *>(data);
+	uint64_t expectedLength = sizeof(FrequentWordTableHeader) +
+	                          static_cast<uint64_t>(header->bucketCount) * sizeof(uint32_t) +
+	                          static_cast<uint64_t>(header->slotCount) * sizeof(FrequentWordSlot) +
+	                          static_cast<uint64_t>(header->poolLength) * sizeof(uint32_t);
+	if (header->cookie != COOKIE || header->formatVersion != FORMAT_VERSION ||
+	    header->bucketCount == 0 || header->slotCount == 0 || expectedLength != length) {
+		unloadFile(data, length);
+		return 0;
+	}
+	FrequentWordTable * table = new FrequentWordTable(data, length);
+	if (!table->hasValidSlots()) {
+		delete table;
+		return 0;
+	}
+	return table;
+}
+
+bool FrequentWordTable::hasValidSlots() const {
+	for (uint32_t i = 0; i < header->slotCount; i++) {
+		const FrequentWordSlot & slot = slots[i];
+		if (slot.wordLength != 0 &&
+		    (static_cast<uint64_t>(slot.wordOffset) + slot.wordLength > header->poolLength ||
+		     slot.result > SPELL_CAP_ERROR)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const FrequentWordTable * FrequentWordTable::acquire(const string & directoryName) {
+	string key = registryKey(directoryName);
+	if (key.empty()) {
+		return 0;
+	}
+	MutexLocker locker(registryMutex);
+	map<string, TableEntry>::iterator it = registry.find(key);
+	if (it != registry.end()) {
+		it->second.referenceCount++;
+		return it->second.table;
+	}
+	FrequentWordTable * table = load(directoryName + TABLE_FILE_NAME);
+	if (!table) {
+		return 0;
+	}
+	uint64_t stamp;
+	if (!dictionaryStamp(directoryName, stamp) || stamp != table->header->dictionaryStamp) {
+		// built for another version of the dictionary
+		delete table;
+		return 0;
+	}
+	TableEntry entry;
+	entry.table = table;
+	entry.referenceCount = 1;
+	registry[key] = entry;
+	return table;
+}
+
+void FrequentWordTable::release(const FrequentWordTable * table) {
+	if (!table) {
+		return;
+	}
+	MutexLocker locker(registryMutex);
+	for (map<string, TableEntry>::iterator it = registry.begin(); it != registry.end(); ++it) {
+		if (it->second.table == table) {
+			if (--it->second.referenceCount == 0) {
+				delete it->second.table;
+				registry.erase(it);
+			}
+			return;
+		}
+	}
+}
+
+bool FrequentWordTable::lookup(const wchar_t * word, size_t wlen, wchar_t first, spellresult & result) const {
+	if (wlen == 0 || wlen > 0xFFFF) {
+		return false;
+	}
+	uint32_t seed = seeds[hash(word, wlen, first, 0) % header->bucketCount];
+	const FrequentWordSlot & slot = slots[hash(word, wlen, first, seed) % header->slotCount];
+	if (slot.wordLength != wlen) {
+		return false;
+	}
+	const uint32_t * stored = pool + slot.wordOffset;
+	if (stored[0] != static_cast<uint32_t>(first)) {
+		return false;
+	}
+	for (size_t i = 1; i < wlen; i++) {
+		if (stored[i] != static_cast<uint32_t>(word[i])) {
+			return false;
+		}
+	}
+	result = static_cast<spellresult>(slot.result);
+	return true;
+}
+
+} }
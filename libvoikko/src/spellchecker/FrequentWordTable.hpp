@@ -0,0 +1,169 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef VOIKKO_SPELLCHECKER_FREQUENT_WORD_TABLE
+#define VOIKKO_SPELLCHECKER_FREQUENT_WORD_TABLE
+
+#include "spellchecker/Speller.hpp"
+#include "utils/Checksum.hpp"
+#include "utils/Hash.hpp"
+#include <cstdio>
+#include <string>
+#include <stdint.h>
+
+namespace libvoikko { namespace spellchecker {
+
+/**
+ * Header of a frequent word table file. The file is in native byte order and
+ * the header is followed by bucketCount 32 bit displacement seeds,
+ * slotCount FrequentWordSlot entries and poolLength 32 bit characters that
+ * contain the words.
+ */
+struct FrequentWordTableHeader {
+	uint32_t cookie;
+	uint32_t formatVersion;
+	/** Checksum of the transducer files the table was built from, see FrequentWordTable::dictionaryStamp */
+	uint64_t dictionaryStamp;
+	uint32_t bucketCount;
+	uint32_t slotCount;
+	uint32_t poolLength;
+	uint32_t reserved;
+};
+
+struct FrequentWordSlot {
+	/** Position of the word in the character pool */
+	uint32_t wordOffset;
+	/** Length of the word, 0 for an empty slot */
+	uint16_t wordLength;
+	/** Value of spellresult for the word */
+	uint8_t result;
+	uint8_t reserved;
+};
+
+/**
+ * Read only table of frequent words and the results the speller gives for
+ * them. The table is built by voikkofreqc from a word frequency list and
+ * stored in the dictionary directory. The words are found with a perfect
+ * hash: the word is first hashed to a bucket and then with the
+ * displacement seed of the bucket to its slot, so each lookup compares at
+ * most one word. Only words that consist of lower case letters are stored.
+ */
+class FrequentWordTable {
+	public:
+		static const uint32_t COOKIE = 0x54574656; // "VFWT"
+		static const uint32_t FORMAT_VERSION = 1;
+		
+		/**
+		 * Returns the table in given dictionary directory or null pointer if there
+		 * is no usable table. A table that was built for other transducer files
+		 * than the ones in the directory is not used. Tables are shared between
+		 * all users in the process and must be released with release().
+		 */
+		static const FrequentWordTable * acquire(const std::string & directoryName);
+		
+		/**
+		 * Releases a table returned from acquire.
+		 */
+		static void release(const FrequentWordTable * table);
+		
+		/**
+		 * Finds the speller result for word with its first character replaced by first.
+		 * @return false if the word is not in the table
+		 */
+		bool lookup(const wchar_t * word, size_t wlen, wchar_t first, spellresult & result) const;
+		
+		bool lookup(const wchar_t * word, size_t wlen, spellresult & result) const {
+			return wlen > 0 && lookup(word, wlen, word[0], result);
+		}
+		
+		/**
+		 * Hash of word with its first character replaced by first.
+		 * @param wlen length of word, at least 1
+		 * @param seed 0 for finding the bucket, displacement seed of the bucket for finding the slot
+		 */
+		static uint32_t hash(const wchar_t * word, size_t wlen, wchar_t first, uint32_t seed) {
+			uint32_t h = utils::fnvAdd(utils::FNV_OFFSET_BASIS ^ (seed * 0x9E3779B9u), static_cast<uint32_t>(first));
+			h = utils::fnvHash(word + 1, wlen - 1, h);
+			h ^= h >> 15;
+			h *= 0x85EBCA6Bu;
+			return h ^ (h >> 13);
+		}
+		
+		/**
+		 * Computes the checksum of the transducer files in given dictionary
+		 * directory that the results in a table depend on.
+		 * @return false if there are no transducer files
+		 */
+		static bool dictionaryStamp(const std::string & directoryName, uint64_t & stamp) {
+			static const char * const FILE_NAMES[] = {"/mor.vfst", "/spl.vfst"};
+			bool found = false;
+			stamp = utils::initialChecksum();
+			for (size_t i = 0; i < sizeof(FILE_NAMES) / sizeof(FILE_NAMES[0]); i++) {
+				FILE * file = fopen((directoryName + FILE_NAMES[i]).c_str(), "rb");
+				if (!file) {
+					continue;
+				}
+				// buffer size is a multiple of 8 so that the result matches checking the file at once
+				char buffer[65536];
+				size_t length;
+				while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+					stamp = utils::contentChecksum(buffer, length, stamp);
+				}
+				fclose(file);
+				found = true;
+			}
+			return found;
+		}
+	private:
+		FrequentWordTable(void * data, size_t length);
+		~FrequentWordTable();
+		FrequentWordTable(const FrequentWordTable &);
+		FrequentWordTable & operator=(const FrequentWordTable &);
+		
+		/**
+		 * Loads the table from given file.
+		 * @return null pointer if the file does not exist or is not a valid table
+		 */
+		static FrequentWordTable * load(const std::string & fileName);
+		
+		/**
+		 * Checks that all slots refer to words within the file.
+		 */
+		bool hasValidSlots() const;
+		
+		void * data;
+		size_t length;
+		const FrequentWordTableHeader * header;
+		const uint32_t * seeds;
+		const FrequentWordSlot * slots;
+		const uint32_t * pool;
+};
+
+} }
+
+#endif
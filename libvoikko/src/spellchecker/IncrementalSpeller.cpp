@@ -0,0 +1,117 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "spellchecker/IncrementalSpeller.hpp"
+#include "voikko_defines.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace libvoikko { namespace spellchecker {
+
+const int IncrementalSpeller::UNKNOWN;
+const size_t IncrementalSpeller::OPTION_COUNT;
+
+IncrementalSpeller::IncrementalSpeller(voikko_options_t * voikkoOptions) :
+	voikkoOptions(voikkoOptions),
+	word(),
+	spellResults(1, UNKNOWN),
+	continuable(1, UNKNOWN) {
+	readSpellOptions(spellOptions);
+}
+
+voikko_options_t * IncrementalSpeller::getOptions() const {
+	return voikkoOptions;
+}
+
+bool IncrementalSpeller::append(const wchar_t * chars, size_t len) {
+	if (word.size() + len > LIBVOIKKO_MAX_WORD_CHARS) {
+		return false;
+	}
+	word.append(chars, len);
+	spellResults.resize(word.size() + 1, UNKNOWN);
+	continuable.resize(word.size() + 1, UNKNOWN);
+	return true;
+}
+
+void IncrementalSpeller::remove(size_t count) {
+	word.erase(word.size() - min(count, word.size()));
+	// Results of longer prefixes are no longer valid because different
+	// characters may be appended next.
+	spellResults.resize(word.size() + 1);
+	continuable.resize(word.size() + 1);
+}
+
+const wchar_t * IncrementalSpeller::getWord() const {
+	return word.c_str();
+}
+
+size_t IncrementalSpeller::getLength() const {
+	return word.size();
+}
+
+int IncrementalSpeller::getSpellResult() {
+	discardIfOptionsChanged();
+	return spellResults[word.size()];
+}
+
+void IncrementalSpeller::setSpellResult(int result) {
+	spellResults[word.size()] = result;
+}
+
+int IncrementalSpeller::getContinuable() {
+	discardIfOptionsChanged();
+	return continuable[word.size()];
+}
+
+void IncrementalSpeller::setContinuable(bool isContinuable) {
+	continuable[word.size()] = (isContinuable ? 1 : 0);
+}
+
+void IncrementalSpeller::readSpellOptions(int * values) const {
+	values[0] = voikkoOptions->ignore_dot;
+	values[1] = voikkoOptions->ignore_numbers;
+	values[2] = voikkoOptions->ignore_uppercase;
+	values[3] = voikkoOptions->ignore_nonwords;
+	values[4] = voikkoOptions->accept_first_uppercase;
+	values[5] = voikkoOptions->accept_all_uppercase;
+	values[6] = voikkoOptions->accept_extra_hyphens;
+	values[7] = voikkoOptions->accept_missing_hyphens;
+}
+
+void IncrementalSpeller::discardIfOptionsChanged() {
+	int current[OPTION_COUNT];
+	readSpellOptions(current);
+	if (!equal(current, current + OPTION_COUNT, spellOptions)) {
+		copy(current, current + OPTION_COUNT, spellOptions);
+		fill(spellResults.begin(), spellResults.end(), UNKNOWN);
+		fill(continuable.begin(), continuable.end(), UNKNOWN);
+	}
+}
+
+} }
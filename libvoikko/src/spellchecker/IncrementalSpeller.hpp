@@ -0,0 +1,101 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef VOIKKO_SPELLCHECKER_INCREMENTAL_SPELLER
+#define VOIKKO_SPELLCHECKER_INCREMENTAL_SPELLER
+
+#include "setup/setup.hpp"
+#include <list>
+#include <string>
+#include <vector>
+
+namespace libvoikko { namespace spellchecker {
+
+/**
+ * Word that is being typed in an editor. Characters are appended and removed
+ * at the end of the word and the results for each prefix of the word are
+ * kept, so that a prefix that was already seen while typing is not checked
+ * again when characters are removed. The saved results are discarded if
+ * the spelling options of the handle have changed.
+ */
+class IncrementalSpeller {
+	public:
+		/** Result that has not been determined yet */
+		static const int UNKNOWN = -1;
+		
+		IncrementalSpeller(voikko_options_t * voikkoOptions);
+		
+		voikko_options_t * getOptions() const;
+		
+		/**
+		 * Appends characters to the end of the word.
+		 * @return false if the word would become too long. In that case the
+		 *         word is not changed.
+		 */
+		bool append(const wchar_t * chars, size_t len);
+		
+		/**
+		 * Removes count characters from the end of the word, or all of them if
+		 * the word is shorter than that.
+		 */
+		void remove(size_t count);
+		
+		/** Returns the current word (null terminated) */
+		const wchar_t * getWord() const;
+		
+		size_t getLength() const;
+		
+		/** Returns the saved spelling result of the current word or UNKNOWN */
+		int getSpellResult();
+		
+		void setSpellResult(int result);
+		
+		/**
+		 * Returns 1 if the current word is a prefix of some word, 0 if it is
+		 * not or UNKNOWN if this has not been determined yet.
+		 */
+		int getContinuable();
+		
+		void setContinuable(bool isContinuable);
+	private:
+		static const size_t OPTION_COUNT = 8;
+		voikko_options_t * const voikkoOptions;
+		std::wstring word;
+		/** Spelling result for each prefix length of the word */
+		std::vector<int> spellResults;
+		/** Whether each prefix of the word can be continued to a word */
+		std::vector<int> continuable;
+		/** Values of the options that affect spelling when the results were saved */
+		int spellOptions[OPTION_COUNT];
+		void readSpellOptions(int * values) const;
+		void discardIfOptionsChanged();
+};
+
+} }
+
+#endif
@@ -36,7 +36,7 @@ using namespace libvoikko::morphology;
 namespace libvoikko { namespace spellchecker {
 
 static int getPriorityFromNounInflection(const Analysis * analysis) {
-	const wchar_t * sijamuoto = analysis->getValue("SIJAMUOTO");
+	const wchar_t * sijamuoto = analysis->getValue(Analysis::KEY_SIJAMUOTO);
 	if (!sijamuoto) {
 		// unknown sijamuoto
 		return 4;
@@ -90,7 +90,7 @@ static int getPriorityFromNounInflection(const Analysis * analysis) {
 }
 
 static int getPriorityFromWordClassAndInflection(const Analysis * analysis) {
-	const wchar_t * wordClass = analysis->getValue("CLASS");
+	const wchar_t * wordClass = analysis->getValue(Analysis::KEY_CLASS);
 	if (!wordClass) {
 		// unknown word class
 		return 4;
@@ -141,7 +141,7 @@ static int getPriorityFromSpellResult(spellresult result) {
 static spellresult handleAnalysis(const wchar_t * word, size_t len, int &prio,
                                   const Analysis * analysis) {
 	prio = getPriorityFromWordClassAndInflection(analysis);
-	const wchar_t * structure = analysis->getValue("STRUCTURE");
+	const wchar_t * structure = analysis->getValue(Analysis::KEY_STRUCTURE);
 	prio *= getPriorityFromStructure(structure);
 	spellresult result = SpellUtils::matchWordAndAnalysis(word, len, structure);
 	prio *= getPriorityFromSpellResult(result);
@@ -150,7 +150,9 @@ static spellresult handleAnalysis(const wchar_t * word, size_t len, int &prio,
 
 spellresult SpellWithPriority::spellWithPriority(Analyzer * morAnalyzer,
 	                       const wchar_t * word, size_t len, int * prio) {
-	list<Analysis *> * analyses = morAnalyzer->analyze(word, len, false);
+	list<Analysis *> * analyses = morAnalyzer->analyze(word, len,
+	        Analysis::keyBit(Analysis::KEY_STRUCTURE) | Analysis::keyBit(Analysis::KEY_CLASS) |
+	        Analysis::keyBit(Analysis::KEY_SIJAMUOTO));
 	*prio = 0;
 	
 	if (analyses->empty()) {
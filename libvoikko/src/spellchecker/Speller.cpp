@@ -30,6 +30,14 @@
 
 namespace libvoikko { namespace spellchecker {
 
+bool Speller::complete(const wchar_t *, size_t, size_t, std::list<std::wstring> &) {
+	return false;
+}
+
+bool Speller::spellWithOptionalDot(const wchar_t *, size_t, spellresult &, spellresult &) {
+	return false;
+}
+
 Speller::~Speller() {
 }
 
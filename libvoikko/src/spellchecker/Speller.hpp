@@ -30,6 +30,8 @@
 #define VOIKKO_SPELLCHECKER_SPELLER
 
 #include <cstring>
+#include <list>
+#include <string>
 
 namespace libvoikko { namespace spellchecker {
 
@@ -51,6 +53,28 @@ class Speller {
 		 * with different capitalization).
 		 */
 		virtual spellresult spell(const wchar_t * word, size_t wlen) = 0;
+		
+		/**
+		 * Finds words accepted by this speller that begin with given prefix, most
+		 * likely ones first. The prefix itself is not included. The default
+		 * implementation cannot list any words.
+		 * @param maxCount maximum number of words to append to completions
+		 * @return false if this speller cannot list the words it accepts or gave
+		 *         up before finding any of them
+		 */
+		virtual bool complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+		                      std::list<std::wstring> & completions);
+		
+		/**
+		 * Checks word, which ends in a dot, without the dot and unless the
+		 * result is SPELL_OK, with the dot. This gives the same results as
+		 * calling spell for both but may be faster. The default implementation
+		 * does not check anything.
+		 * @param withDot not set if withoutDot is SPELL_OK
+		 * @return false if the results were not set
+		 */
+		virtual bool spellWithOptionalDot(const wchar_t * word, size_t wlen,
+		                                  spellresult & withDot, spellresult & withoutDot);
 		virtual void terminate() = 0;
 		virtual ~Speller();
 };
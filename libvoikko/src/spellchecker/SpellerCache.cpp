@@ -27,88 +27,225 @@
  *********************************************************************************/
 
 #include "spellchecker/SpellerCache.hpp"
-#include <cwchar>
+#include "utils/Hash.hpp"
+#include "voikko_defines.h"
 
 namespace libvoikko { namespace spellchecker {
 
-/* A small result cache:
- * word_length order elements wchars offset
- * 1           4     16       16     0
- * 2           5     32       64     16
- * 3           6     64       192    80
- * 4           7     128      512    272
- * 5           7     128      640    784
- * 6           7     128      768    1424
- * 7           7     128      896    2192
- * 8           7     128      1024   3088
- * 9           7     128      1152   4112
- * 10          7     128      1280   5264
- * total size      sizeof(wchar_t) * 6544
+/** Maximum word length in UTF-16 code units for each table */
+static const size_t MAX_LENGTHS[] = {8, 16, 32, 64, 2 * LIBVOIKKO_MAX_WORD_CHARS};
+
+/**
+ * Share of the cache memory given to each table in percents. This roughly
+ * follows the distribution of word lengths in Finnish text.
  */
+static const size_t MEMORY_SHARES[] = {30, 40, 22, 6, 2};
 
-static const int VOIKKO_HASH_ORDERS[]   =  {0, 3+0,  5+0,  6+0,   7+0,   7+0,    7+0,    7+0,    7+0,    7+0,    7+0};
-static const int VOIKKO_CACHE_OFFSETS[] =  {0,   0, 1*16, 1*80, 1*272, 1*784, 1*1424, 1*2192, 1*3088, 1*4112, 1*5264};
-static const int VOIKKO_META_OFFSETS[]  =  {0,   0, 1*16, 1*48, 1*112, 1*240,  1*368,  1*496,  1*624,  1*752,  1*880};
+SpellerCache::SpellerCache(size_t sizeInBytes) :
+	sizeInBytes(sizeInBytes),
+	hitCount(0),
+	missCount(0) {
+	for (size_t i = 0; i < TABLE_COUNT; i++) {
+		Table & table = tables[i];
+		table.maxLength = MAX_LENGTHS[i];
+		table.slotCount = sizeInBytes / 100 * MEMORY_SHARES[i] / (sizeof(Slot) + table.maxLength * sizeof(uint16_t));
+		table.slots = new Slot[table.slotCount];
+		table.chars = new uint16_t[table.slotCount * table.maxLength];
+	}
+	clear();
+}
 
-/** 
- * Simple string hashing algorithm
- * @param word string to hash
- * @param len length of the word
- * @param order order of the resulting hash value
- * @return integer from range [0, 2^order - 1]
- */
-static int voikko_hash(const wchar_t * word, size_t len, int order) {
-	int hash = 0;
-	for (size_t counter = 0; counter < len; counter++) {
-		hash = (hash * 37 + word[counter]) % (1 << order);
+SpellerCache::~SpellerCache() {
+	for (size_t i = 0; i < TABLE_COUNT; i++) {
+		delete[] tables[i].chars;
+		delete[] tables[i].slots;
 	}
-	return hash;
 }
 
-SpellerCache::SpellerCache(int sizeParam) : sizeParam(sizeParam) {
-	words = new wchar_t[6544 << sizeParam];
-	memset(words, 0, 6544 * sizeof(wchar_t) << sizeParam);
-	spellResults = new char[1008 * sizeof(char) << sizeParam];
-	memset(spellResults, 0, 1008 * sizeof(char) << sizeParam);
+size_t SpellerCache::getSizeInBytes() const {
+	return sizeInBytes;
 }
 
-SpellerCache::~SpellerCache() {
-	delete[] spellResults;
-	delete[] words;
+size_t SpellerCache::sizeInBytesForSizeParam(int sizeParam) {
+	return (6544 * sizeof(wchar_t) + 1008) << sizeParam;
 }
 
-int SpellerCache::getSizeParam() const {
-	return sizeParam;
+size_t SpellerCache::toUtf16(const wchar_t * word, size_t wlen, uint16_t * units) {
+	if (wlen == 0 || wlen > LIBVOIKKO_MAX_WORD_CHARS) {
+		return 0;
+	}
+	size_t unitCount = 0;
+	for (size_t i = 0; i < wlen; i++) {
+		uint32_t c = static_cast<uint32_t>(word[i]);
+		if (c <= 0xFFFF) {
+			units[unitCount++] = static_cast<uint16_t>(c);
+		}
+		else if (c <= 0x10FFFF) {
+			c -= 0x10000;
+			units[unitCount++] = static_cast<uint16_t>(0xD800 + (c >> 10));
+			units[unitCount++] = static_cast<uint16_t>(0xDC00 + (c & 0x3FF));
+		}
+		else {
+			return 0;
+		}
+	}
+	return unitCount;
 }
 
-bool SpellerCache::isInCache(const wchar_t * word, size_t wlen) const {
-	if (wlen > 10) {
-		return false;
+SpellerCache::Table * SpellerCache::getTable(size_t unitCount) {
+	if (unitCount == 0) {
+		return 0;
+	}
+	for (size_t i = 0; i < TABLE_COUNT; i++) {
+		if (unitCount <= tables[i].maxLength) {
+			return tables[i].slotCount == 0 ? 0 : &tables[i];
+		}
 	}
-	int hashCode = voikko_hash(word, wlen, VOIKKO_HASH_ORDERS[wlen] + sizeParam);
-	int cacheOffset = (VOIKKO_CACHE_OFFSETS[wlen] << sizeParam) + hashCode * static_cast<int>(wlen);
-	return wcsncmp(words + cacheOffset, word, wlen) == 0;
+	return 0;
 }
 
-spellresult SpellerCache::getSpellResult(const wchar_t * word, size_t wlen) const {
-	int hashCode = voikko_hash(word, wlen, VOIKKO_HASH_ORDERS[wlen] + sizeParam);
-	int resultOffset = (VOIKKO_META_OFFSETS[wlen] << sizeParam) + hashCode;
-	if (spellResults[resultOffset] == 'i') {
-		return SPELL_CAP_FIRST;
-	} else {
-		return SPELL_OK;
+bool SpellerCache::getSpellResult(const wchar_t * word, size_t wlen, spellresult & result) {
+	uint16_t units[MAX_UNITS];
+	size_t unitCount = toUtf16(word, wlen, units);
+	Table * table = getTable(unitCount);
+	if (table) {
+		uint32_t hash = utils::fnvHash(units, unitCount);
+		size_t slotIndex = hash % table->slotCount;
+		for (size_t i = 0; i < PROBE_WINDOW && i < table->slotCount; i++) {
+			Slot & slot = table->slots[slotIndex];
+			if (slot.hash == hash && slot.length == unitCount &&
+			    memcmp(table->chars + slotIndex * table->maxLength, units, unitCount * sizeof(uint16_t)) == 0) {
+				slot.referenced = 1;
+				result = static_cast<spellresult>(slot.result);
+				hitCount++;
+				return true;
+			}
+			if (++slotIndex == table->slotCount) {
+				slotIndex = 0;
+			}
+		}
 	}
+	missCount++;
+	return false;
 }
 
 void SpellerCache::setSpellResult(const wchar_t * word, size_t wlen, spellresult result) {
-	if (wlen > 10 || (result != SPELL_OK && result != SPELL_CAP_FIRST)) {
-		return;
+	uint16_t units[MAX_UNITS];
+	size_t unitCount = toUtf16(word, wlen, units);
+	Table * table = getTable(unitCount);
+	if (table) {
+		store(*table, units, unitCount, utils::fnvHash(units, unitCount), result);
+	}
+}
+
+void SpellerCache::store(Table & table, const uint16_t * units, size_t unitCount, uint32_t hash,
+                         spellresult result) {
+	size_t firstIndex = hash % table.slotCount;
+	size_t windowSize = PROBE_WINDOW < table.slotCount ? PROBE_WINDOW : table.slotCount;
+	
+	// Reuse the slot of the same word or the first free one. Otherwise the
+	// first slot without reference bit is replaced, clearing the reference
+	// bits of the slots that are passed.
+	size_t targetIndex = firstIndex;
+	size_t slotIndex = firstIndex;
+	bool found = false;
+	for (size_t i = 0; i < windowSize; i++) {
+		Slot & slot = table.slots[slotIndex];
+		if (slot.length == 0 || (slot.hash == hash && slot.length == unitCount &&
+		    memcmp(table.chars + slotIndex * table.maxLength, units, unitCount * sizeof(uint16_t)) == 0)) {
+			targetIndex = slotIndex;
+			found = true;
+			break;
+		}
+		if (++slotIndex == table.slotCount) {
+			slotIndex = 0;
+		}
+	}
+	slotIndex = firstIndex;
+	for (size_t i = 0; i < windowSize && !found; i++) {
+		Slot & slot = table.slots[slotIndex];
+		if (!slot.referenced) {
+			targetIndex = slotIndex;
+			found = true;
+		}
+		else {
+			slot.referenced = 0;
+		}
+		if (++slotIndex == table.slotCount) {
+			slotIndex = 0;
+		}
+	}
+	
+	Slot & target = table.slots[targetIndex];
+	target.hash = hash;
+	target.length = static_cast<uint16_t>(unitCount);
+	target.result = static_cast<uint8_t>(result);
+	target.referenced = 0;
+	memcpy(table.chars + targetIndex * table.maxLength, units, unitCount * sizeof(uint16_t));
+}
+
+void SpellerCache::clear() {
+	for (size_t i = 0; i < TABLE_COUNT; i++) {
+		memset(tables[i].slots, 0, tables[i].slotCount * sizeof(Slot));
+	}
+}
+
+/*
+ * Each word is saved as its length in UTF-16 code units (16 bits), its
+ * result (8 bits) and then its code units.
+ */
+void SpellerCache::save(std::string & data) const {
+	for (size_t i = 0; i < TABLE_COUNT; i++) {
+		const Table & table = tables[i];
+		for (size_t slotIndex = 0; slotIndex < table.slotCount; slotIndex++) {
+			const Slot & slot = table.slots[slotIndex];
+			if (slot.length == 0) {
+				continue;
+			}
+			data.append(reinterpret_cast<const char *>(&slot.length), sizeof(uint16_t));
+			data.push_back(static_cast<char>(slot.result));
+			data.append(reinterpret_cast<const char *>(table.chars + slotIndex * table.maxLength),
+			            slot.length * sizeof(uint16_t));
+		}
+	}
+}
+
+bool SpellerCache::load(const char * data, size_t length) {
+	const size_t ENTRY_HEADER = sizeof(uint16_t) + 1;
+	for (size_t pos = 0; pos < length; ) {
+		if (pos + ENTRY_HEADER > length) {
+			return false;
+		}
+		uint16_t unitCount;
+		memcpy(&unitCount, data + pos, sizeof(uint16_t));
+		unsigned char result = static_cast<unsigned char>(data[pos + sizeof(uint16_t)]);
+		pos += ENTRY_HEADER + unitCount * sizeof(uint16_t);
+		if (unitCount == 0 || unitCount > MAX_UNITS || result > SPELL_CAP_ERROR || pos > length) {
+			return false;
+		}
 	}
-	int hashCode = voikko_hash(word, wlen, VOIKKO_HASH_ORDERS[wlen] + sizeParam);
-	int cacheOffset = (VOIKKO_CACHE_OFFSETS[wlen] << sizeParam) + hashCode * static_cast<int>(wlen);
-	int resultOffset = (VOIKKO_META_OFFSETS[wlen] << sizeParam) + hashCode;
-	wcsncpy(words + cacheOffset, word, wlen);
-	spellResults[resultOffset] = (result == SPELL_OK) ? 'p' : 'i';
+	uint16_t units[MAX_UNITS];
+	for (size_t pos = 0; pos < length; ) {
+		uint16_t unitCount;
+		memcpy(&unitCount, data + pos, sizeof(uint16_t));
+		spellresult result = static_cast<spellresult>(data[pos + sizeof(uint16_t)]);
+		pos += ENTRY_HEADER;
+		memcpy(units, data + pos, unitCount * sizeof(uint16_t));
+		pos += unitCount * sizeof(uint16_t);
+		Table * table = getTable(unitCount);
+		if (table) {
+			store(*table, units, unitCount, utils::fnvHash(units, unitCount), result);
+		}
+	}
+	return true;
+}
+
+size_t SpellerCache::getHitCount() const {
+	return hitCount;
+}
+
+size_t SpellerCache::getMissCount() const {
+	return missCount;
 }
 
 } }
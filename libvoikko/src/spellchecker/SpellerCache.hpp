@@ -30,46 +30,124 @@
 #define VOIKKO_SPELLCHECKER_SPELLER_CACHE
 
 #include "spellchecker/Speller.hpp"
+#include "voikko_defines.h"
 #include <cstring>
+#include <string>
+#include <stdint.h>
 
 namespace libvoikko { namespace spellchecker {
 
 /**
- * General positive speller cache
+ * Cache for spelling results. Both positive and negative results are stored.
+ * Words are kept in separate tables by length so that short words do not
+ * need the space reserved for long ones. Each table uses open addressing:
+ * a word may be stored in any of the PROBE_WINDOW slots that follow its
+ * hash position, and if all of them are in use, the slot to replace is
+ * selected using the CLOCK (second chance) policy.
+ *
+ * Words are stored as UTF-16, so characters outside the Basic Multilingual
+ * Plane take two code units and the table of a word is selected by its
+ * length in code units. Every word of up to LIBVOIKKO_MAX_WORD_CHARS
+ * characters can be cached.
+ *
+ * The cache is not shared between handles and it is not synchronized. Each
+ * handle, including each session of a shared dictionary, has its own cache.
  */
 class SpellerCache {
 	public:
-		SpellerCache(int sizeParam);
+		/**
+		 * Creates a cache that uses approximately given amount of memory.
+		 */
+		SpellerCache(size_t sizeInBytes);
 		~SpellerCache();
 		
-		int getSizeParam() const;
+		size_t getSizeInBytes() const;
 		
 		/**
-		 * Check whether given word is in cache.
+		 * Returns the cache size in bytes corresponding to given value of
+		 * option VOIKKO_SPELLER_CACHE_SIZE.
 		 */
-		bool isInCache(const wchar_t * word, size_t wlen) const;
+		static size_t sizeInBytesForSizeParam(int sizeParam);
 		
 		/**
-		 * Assuming that the word is in cache, return spelling result for it.
+		 * Looks up given word from the cache.
+		 * @return true if the word was found. In that case its spelling
+		 *         result is stored to result.
 		 */
-		spellresult getSpellResult(const wchar_t * word, size_t wlen) const;
+		bool getSpellResult(const wchar_t * word, size_t wlen, spellresult & result);
 		
 		/**
 		 * Add word to cache
 		 */
 		void setSpellResult(const wchar_t * word, size_t wlen, spellresult result);
+		
+		/**
+		 * Removes all words from the cache. This must be called when options
+		 * affecting spelling results are changed.
+		 */
+		void clear();
+		
+		/**
+		 * Appends the words in the cache and their results to data in native
+		 * byte order.
+		 */
+		void save(std::string & data) const;
+		
+		/**
+		 * Adds words written by save to the cache. Nothing is added if the data
+		 * is not valid.
+		 * @return false if the data was not valid
+		 */
+		bool load(const char * data, size_t length);
+		
+		/** Number of successful lookups since the cache was created */
+		size_t getHitCount() const;
+		
+		/** Number of failed lookups since the cache was created */
+		size_t getMissCount() const;
 	private:
 		SpellerCache(const SpellerCache & other);
 		SpellerCache & operator = (SpellerCache other);
 		
-		const int sizeParam;
-		wchar_t * words;
+		struct Slot {
+			uint32_t hash;
+			/** Length of the word in UTF-16 code units or 0 if the slot is empty */
+			uint16_t length;
+			uint8_t result;
+			/** Reference bit for CLOCK replacement */
+			uint8_t referenced;
+		};
+		
+		struct Table {
+			/** Maximum length of a word in UTF-16 code units */
+			size_t maxLength;
+			size_t slotCount;
+			Slot * slots;
+			/** UTF-16 code units of words, maxLength for each slot */
+			uint16_t * chars;
+		};
+		
+		static const size_t TABLE_COUNT = 5;
+		static const size_t PROBE_WINDOW = 4;
+		/** Maximum length of a word in UTF-16 code units */
+		static const size_t MAX_UNITS = 2 * LIBVOIKKO_MAX_WORD_CHARS;
 		
 		/**
-		 * i = SPELL_CAP_FIRST
-		 * p = SPELL_OK
+		 * Converts a word to UTF-16.
+		 * @param units buffer of at least MAX_UNITS code units
+		 * @return number of code units or 0 if the word cannot be cached
 		 */
-		char * spellResults; 
+		static size_t toUtf16(const wchar_t * word, size_t wlen, uint16_t * units);
+		
+		Table * getTable(size_t unitCount);
+		
+		void store(Table & table, const uint16_t * units, size_t unitCount, uint32_t hash,
+		           spellresult result);
+		
+		const size_t sizeInBytes;
+		Table tables[TABLE_COUNT];
+		size_t hitCount;
+		size_t missCount;
 };
 
 } }
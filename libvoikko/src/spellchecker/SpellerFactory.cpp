@@ -52,9 +52,10 @@ Speller * SpellerFactory::getSpeller(voikko_options_t * voikkoOptions,
 	// Take care of proper memory management (who has to delete what).
 	string spellBackend = dictionary.getSpellBackend().getBackend();
 	if (spellBackend == "AnalyzerToSpellerAdapter(currentAnalyzer)") {
-		return new AnalyzerToSpellerAdapter(currentAnalyzer);
+		return new AnalyzerToSpellerAdapter(currentAnalyzer, voikkoOptions->frequentWords);
 	} else if (spellBackend == "FinnishSpellerTweaksWrapper(AnalyzerToSpellerAdapter(currentAnalyzer),currentAnalyzer)") {
-		return new FinnishSpellerTweaksWrapper(new AnalyzerToSpellerAdapter(currentAnalyzer), currentAnalyzer, voikkoOptions);
+		return new FinnishSpellerTweaksWrapper(new AnalyzerToSpellerAdapter(currentAnalyzer, voikkoOptions->frequentWords),
+		                                       currentAnalyzer, voikkoOptions);
 	} else if (spellBackend == "AllOk") {
 		return new FixedResultSpeller(SPELL_OK);
 	} else if (spellBackend == "AllError") {
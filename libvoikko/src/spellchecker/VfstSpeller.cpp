@@ -27,13 +27,15 @@
  *********************************************************************************/
 
 #include "spellchecker/VfstSpeller.hpp"
-#include "utils/StringUtils.hpp"
+#include "fst/TransducerRegistry.hpp"
 #include "character/SimpleChar.hpp"
+#include "utils/StringUtils.hpp"
 #include "voikko_defines.h"
+#include <cstring>
+#include <cwchar>
 
 using namespace std;
 using namespace libvoikko::character;
-using namespace libvoikko::utils;
 using namespace libvoikko::fst;
 
 namespace libvoikko { namespace spellchecker {
@@ -42,46 +44,100 @@ static const int BUFFER_SIZE = 2000;
 
 VfstSpeller::VfstSpeller(const string & directoryName) throw(setup::DictionaryException) {
 	string splFile = directoryName + "/spl.vfst";
-	transducer = new WeightedTransducer(splFile.c_str());
+	transducer = TransducerRegistry::acquireWeighted(splFile);
 	configuration = new WeightedConfiguration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	completionConfiguration = 0;
+	completionBuffer = 0;
 	outputBuffer = new char[BUFFER_SIZE];
 }
  
-spellresult VfstSpeller::doSpell(const wchar_t * word, size_t wlen) {
-	if (wlen > LIBVOIKKO_MAX_WORD_CHARS) {
-		return SPELL_FAILED;
+void VfstSpeller::spellVariants(const wchar_t * word, size_t wlen, bool lastOptional,
+                                spellresult & withLast, spellresult & withoutLast) {
+	withLast = SPELL_FAILED;
+	withoutLast = SPELL_FAILED;
+	// Support SPELL_CAP_FIRST by accepting the first letter in upper case too
+	wchar_t firstVariant = (wlen > 0 && SimpleChar::isLower(word[0]) ? SimpleChar::upper(word[0]) : 0);
+	if (!transducer->prepareVariants(configuration, word, wlen, firstVariant, lastOptional)) {
+		return;
 	}
-	spellresult result = SPELL_FAILED;
-	char * wordUtf = StringUtils::utf8FromUcs4(word, wlen);
-	if (transducer->prepare(configuration, wordUtf, strlen(wordUtf))) {
-		if (transducer->next(configuration, outputBuffer, BUFFER_SIZE)) {
+	bool firstVariantUsed;
+	bool lastConsumed;
+	while (transducer->nextVariant(configuration, outputBuffer, BUFFER_SIZE, firstVariantUsed, lastConsumed)) {
+		spellresult & result = (lastConsumed ? withLast : withoutLast);
+		if (!firstVariantUsed) {
 			result = SPELL_OK;
 		}
+		else if (result == SPELL_FAILED) {
+			result = SPELL_CAP_FIRST;
+		}
+		if (lastOptional ? withoutLast == SPELL_OK : withLast == SPELL_OK) {
+			return;
+		}
+		// SPELL_OK may still be found for paths without the upper case letter
+		if (firstVariantUsed && withLast != SPELL_FAILED && (!lastOptional || withoutLast != SPELL_FAILED)) {
+			transducer->skipFirstVariant(configuration);
+		}
 	}
-	delete[] wordUtf;
-	return result;
 }
- 
+
 spellresult VfstSpeller::spell(const wchar_t * word, size_t wlen) {
-	spellresult result = doSpell(word, wlen);
-	if (result == SPELL_FAILED && SimpleChar::isLower(word[0])) {
-		// XXX: This slightly inefficient hack allows us to support SPELL_CAP_FIRST
-		wchar_t * modifiedWord = StringUtils::copy(word);
-		modifiedWord[0] = SimpleChar::upper(word[0]);
-		result = doSpell(modifiedWord, wlen);
-		if (result == SPELL_OK) {
-			result = SPELL_CAP_FIRST;
-		}
-		delete[] modifiedWord;
+	if (wlen > LIBVOIKKO_MAX_WORD_CHARS) {
+		return SPELL_FAILED;
 	}
+	spellresult result;
+	spellresult unused;
+	spellVariants(word, wlen, false, result, unused);
 	return result;
 }
 
+bool VfstSpeller::spellWithOptionalDot(const wchar_t * word, size_t wlen,
+                                       spellresult & withDot, spellresult & withoutDot) {
+	if (wlen < 2 || wlen > LIBVOIKKO_MAX_WORD_CHARS || word[wlen - 1] != L'.') {
+		return false;
+	}
+	spellVariants(word, wlen, true, withDot, withoutDot);
+	return true;
+}
+
+bool VfstSpeller::complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+                           list<wstring> & completions) {
+	if (transducer->hasNegativeWeights()) {
+		return false;
+	}
+	if (plen > LIBVOIKKO_MAX_WORD_CHARS) {
+		return true;
+	}
+	if (!completionConfiguration) {
+		completionConfiguration = new BestFirstConfiguration(transducer->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+		completionBuffer = new wchar_t[BUFFER_SIZE + 1];
+	}
+	// The prefix is converted to outputBuffer, which is free again once the
+	// configuration has been prepared.
+	size_t skipped;
+	size_t prefixBytes = utils::StringUtils::utf8FromUcs4(prefix, plen, outputBuffer, BUFFER_SIZE, 0, &skipped);
+	if (prefixBytes > static_cast<size_t>(BUFFER_SIZE) ||
+	    !transducer->prepareCompletions(completionConfiguration, outputBuffer, prefixBytes)) {
+		return true;
+	}
+	size_t found = 0;
+	int16_t weight;
+	while (found < maxCount && transducer->next(completionConfiguration, outputBuffer, BUFFER_SIZE, &weight)) {
+		size_t wlen = utils::StringUtils::ucs4FromUtf8(outputBuffer, strlen(outputBuffer), completionBuffer, BUFFER_SIZE);
+		if (wlen > static_cast<size_t>(BUFFER_SIZE) || (wlen == plen && wmemcmp(completionBuffer, prefix, plen) == 0)) {
+			continue;
+		}
+		completions.push_back(wstring(completionBuffer, wlen));
+		found++;
+	}
+	return true;
+}
+
 void VfstSpeller::terminate() {
+	delete[] completionBuffer;
+	delete completionConfiguration;
 	delete[] outputBuffer;
 	delete configuration;
-	transducer->terminate();
-	delete transducer;
+	TransducerRegistry::release(transducer);
 }
 
 } }
@@ -44,13 +44,26 @@ class VfstSpeller : public Speller {
 	public:
 		VfstSpeller(const std::string & directoryName) throw(setup::DictionaryException);
 		spellresult spell(const wchar_t * word, size_t wlen);
+		bool complete(const wchar_t * prefix, size_t plen, size_t maxCount,
+		              std::list<std::wstring> & completions);
+		bool spellWithOptionalDot(const wchar_t * word, size_t wlen,
+		                          spellresult & withDot, spellresult & withoutDot);
 		void terminate();
 		
-		fst::WeightedTransducer * transducer;
+		const fst::WeightedTransducer * transducer;
 	private:
-		/** Return SPELL_FAILED or SPELL_OK depending on whether given word is correct as is. */
-		spellresult doSpell(const wchar_t * word, size_t wlen);
+		/**
+		 * Checks word, and without its last character if lastOptional is true, in
+		 * one traversal. Lower case first letter may also match in upper case.
+		 * If withoutLast is SPELL_OK, withLast may not be final.
+		 */
+		void spellVariants(const wchar_t * word, size_t wlen, bool lastOptional,
+		                   spellresult & withLast, spellresult & withoutLast);
 		fst::WeightedConfiguration * configuration;
+		/** Configuration for listing completions, created when first needed */
+		fst::BestFirstConfiguration * completionConfiguration;
+		/** Completion converted to UCS4, allocated with completionConfiguration */
+		wchar_t * completionBuffer;
 		char * outputBuffer;
 };
 
@@ -27,6 +27,7 @@
  *********************************************************************************/
 
 #include "spellchecker/VfstSuggestion.hpp"
+#include "fst/TransducerRegistry.hpp"
 #include "utils/StringUtils.hpp"
 #include "setup/setup.hpp"
 #include <map>
@@ -52,9 +53,10 @@ struct WeightedSuggestion {
 VfstSuggestion::VfstSuggestion(const fst::WeightedTransducer * acceptor, const string & directoryName) throw(setup::DictionaryException):
                 acceptor(acceptor) {
 	string errFile = directoryName + "/err.vfst";
-	errorModel = new fst::WeightedTransducer(errFile.c_str());
+	errorModel = fst::TransducerRegistry::acquireWeighted(errFile);
 	acceptorConf = new fst::WeightedConfiguration(acceptor->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
 	errorModelConf = new fst::WeightedConfiguration(errorModel->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
+	composedConf = new fst::BestFirstConfiguration(errorModel->getFlagDiacriticFeatureCount(), BUFFER_SIZE);
 	acceptorBuffer = new char[BUFFER_SIZE];
 	errorModelBuffer = new char[BUFFER_SIZE];
 }
@@ -66,7 +68,22 @@ void VfstSuggestion::generate(SuggestionStatus * s) const {
 	int16_t acceptorWeight;
 	int16_t errorModelWeight;
 	map<string, int> suggestionWeights;
-	if (errorModel->prepare(errorModelConf, wordUtf, wlen)) {
+	if (!errorModel->hasNegativeWeights() && !acceptor->hasNegativeWeights()) {
+		// Error model and acceptor are traversed together so that corrections
+		// that cannot become words are abandoned as soon as possible. Results
+		// come in ascending order of weight, so only the best ones are needed.
+		if (errorModel->prepare(composedConf, wordUtf, wlen, acceptor)) {
+			int16_t weight;
+			while (!s->shouldAbort() && suggestionWeights.size() < s->getMaxSuggestionCount() &&
+			       errorModel->next(composedConf, errorModelBuffer, BUFFER_SIZE, &weight)) {
+				string suggStr(errorModelBuffer);
+				if (suggestionWeights.find(suggStr) == suggestionWeights.end()) {
+					suggestionWeights[suggStr] = weight;
+				}
+			}
+		}
+	}
+	else if (errorModel->prepare(errorModelConf, wordUtf, wlen)) {
 		while (!s->shouldAbort() && errorModel->next(errorModelConf, errorModelBuffer, BUFFER_SIZE, &errorModelWeight)) {
 			if (acceptor->prepare(acceptorConf, errorModelBuffer, strlen(errorModelBuffer))) {
 				int firstNotReachedPosition;
@@ -106,10 +123,10 @@ void VfstSuggestion::generate(SuggestionStatus * s) const {
 void VfstSuggestion::terminate() {
 	delete[] errorModelBuffer;
 	delete[] acceptorBuffer;
+	delete composedConf;
 	delete errorModelConf;
 	delete acceptorConf;
-	errorModel->terminate();
-	delete errorModel;
+	fst::TransducerRegistry::release(errorModel);
 }
 
 } } }
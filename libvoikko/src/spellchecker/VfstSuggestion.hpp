@@ -49,9 +49,10 @@ class VfstSuggestion : public SuggestionGenerator {
 
 	private:
 		const fst::WeightedTransducer * acceptor;
-		fst::WeightedTransducer * errorModel;
+		const fst::WeightedTransducer * errorModel;
 		fst::WeightedConfiguration * acceptorConf;
 		fst::WeightedConfiguration * errorModelConf;
+		fst::BestFirstConfiguration * composedConf;
 		char * acceptorBuffer;
 		char * errorModelBuffer;
 };
@@ -31,11 +31,24 @@
 #include "character/charset.hpp"
 #include "character/SimpleChar.hpp"
 #include "spellchecker/Speller.hpp"
+#include "spellchecker/IncrementalSpeller.hpp"
 #include "setup/setup.hpp"
+#include "tokenizer/Tokenizer.hpp"
+#include "utils/Checksum.hpp"
+#include "utils/Hash.hpp"
+#include "voikko_structs.h"
 #include "porting.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cwchar>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 using namespace libvoikko::spellchecker;
 using namespace libvoikko::character;
@@ -60,7 +73,9 @@ static spellresult hyphenAwareSpell(voikko_options_t * voikkoOptions,
 	// Hyphens were already present, so we cannot do anything more
 	if (len < 2 || (word[0] == L'-' && word[len - 1] == L'-')) return SPELL_FAILED;
 	
-	wchar_t * buffer = new wchar_t[len + 2];
+	// Normalisation may make the word up to three times longer than the original
+	wchar_t buffer[LIBVOIKKO_MAX_WORD_CHARS * 3 + 2];
+	if (len > LIBVOIKKO_MAX_WORD_CHARS * 3) return SPELL_FAILED;
 	size_t newlen = len + 1;
 	if (word[0] == L'-') {
 		wcsncpy(buffer, word, len);
@@ -74,9 +89,7 @@ static spellresult hyphenAwareSpell(voikko_options_t * voikkoOptions,
 			newlen++;
 		}
 	}
-	spres = voikkoOptions->speller->spell(buffer, newlen);
-	delete[] buffer;
-	return spres;
+	return voikkoOptions->speller->spell(buffer, newlen);
 }
 
 
@@ -89,12 +102,13 @@ static spellresult hyphenAwareSpell(voikko_options_t * voikkoOptions,
 static spellresult voikko_cached_spell(voikko_options_t * voikkoOptions, const wchar_t * buffer, size_t len) {
 	SpellerCache * cache = voikkoOptions->spellerCache;
 	if (cache) {
-		if (cache->isInCache(buffer, len)) {
+		spellresult result;
+		if (cache->getSpellResult(buffer, len, result)) {
 			/* is in cache */
-			return cache->getSpellResult(buffer, len);
+			return result;
 		}
 		/* not in cache */
-		spellresult result = hyphenAwareSpell(voikkoOptions, buffer, len);
+		result = hyphenAwareSpell(voikkoOptions, buffer, len);
 		cache->setSpellResult(buffer, len, result);
 		return result;
 	}
@@ -103,7 +117,131 @@ static spellresult voikko_cached_spell(voikko_options_t * voikkoOptions, const w
 }
 
 
-VOIKKOEXPORT int voikkoSpellUcs4(voikko_options_t * voikkoOptions, const wchar_t * word) {
+/**
+ * Checks word, which ends in a dot, without the dot and unless the result is
+ * SPELL_OK, with the dot in one call to the speller (see
+ * Speller::spellWithOptionalDot). The results are saved to cache if it is not null.
+ * @return false if the speller cannot do this or if missing hyphens need to
+ *         be handled, in which case the results are not set
+ */
+static bool spellWithOptionalDot(voikko_options_t * voikkoOptions, const wchar_t * word, size_t len,
+                                 SpellerCache * cache, spellresult & withDot, spellresult & withoutDot) {
+	if (voikkoOptions->accept_missing_hyphens ||
+	    !voikkoOptions->speller->spellWithOptionalDot(word, len, withDot, withoutDot)) {
+		return false;
+	}
+	if (cache) {
+		cache->setSpellResult(word, len - 1, withoutDot);
+		if (withoutDot != SPELL_OK) {
+			cache->setSpellResult(word, len, withDot);
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks word with voikko_cached_spell if cache is not null and with
+ * hyphenAwareSpell otherwise.
+ */
+static spellresult spellPossiblyCached(voikko_options_t * voikkoOptions, SpellerCache * cache,
+                                       const wchar_t * word, size_t len) {
+	return cache ? voikko_cached_spell(voikkoOptions, word, len) : hyphenAwareSpell(voikkoOptions, word, len);
+}
+
+/**
+ * Checks word, which ends in a dot, without the dot and with it. If the
+ * result without the dot is SPELL_OK, withDot is not set. Results that are
+ * not in the cache come from a single traversal when the speller supports
+ * it. Otherwise the variants are checked separately, which is also the way
+ * missing hyphens get accepted.
+ * @param cache cache to use or null pointer
+ */
+static void spellDotVariants(voikko_options_t * voikkoOptions, SpellerCache * cache, wchar_t * word, size_t len,
+                             spellresult & withDot, spellresult & withoutDot) {
+	bool withoutDotKnown = cache && cache->getSpellResult(word, len - 1, withoutDot);
+	if (!withoutDotKnown) {
+		if (spellWithOptionalDot(voikkoOptions, word, len, cache, withDot, withoutDot)) {
+			return;
+		}
+		word[len - 1] = L'\0';
+		withoutDot = spellPossiblyCached(voikkoOptions, cache, word, len - 1);
+		word[len - 1] = L'.';
+	}
+	if (withoutDot != SPELL_OK) {
+		withDot = spellPossiblyCached(voikkoOptions, cache, word, len);
+	}
+}
+
+/**
+ * Returns the result for a word with case type caps when the speller has
+ * given result sres for the word in the case it was checked in.
+ * @param firstChar first character of the original word
+ */
+static int caseAwareResult(voikko_options_t * voikkoOptions, casetype caps, spellresult sres, wchar_t firstChar) {
+	switch (caps) {
+		case CT_COMPLEX:
+		case CT_NO_LETTERS:
+			return (sres == SPELL_OK ||
+			        (sres == SPELL_CAP_FIRST && voikkoOptions->accept_first_uppercase && SimpleChar::isUpper(firstChar))) ?
+			       VOIKKO_SPELL_OK : VOIKKO_SPELL_FAILED;
+		case CT_ALL_LOWER:
+			return (sres == SPELL_OK) ? VOIKKO_SPELL_OK : VOIKKO_SPELL_FAILED;
+		case CT_FIRST_UPPER:
+			return ((sres == SPELL_OK && voikkoOptions->accept_first_uppercase) || sres == SPELL_CAP_FIRST) ?
+			       VOIKKO_SPELL_OK : VOIKKO_SPELL_FAILED;
+		case CT_ALL_UPPER:
+			return (sres == SPELL_FAILED) ? VOIKKO_SPELL_FAILED : VOIKKO_SPELL_OK;
+		default: /* should not happen */
+			return VOIKKO_INTERNAL_ERROR;
+	}
+}
+
+/**
+ * Checks a word that is written in lower case or with only the first letter
+ * in upper case from the table of frequent words. Such words consist of
+ * letters only, so normalisation would not change them.
+ * @return false if the result needs to be found in the normal way
+ */
+static bool spellFrequentWord(voikko_options_t * voikkoOptions, const wchar_t * word, size_t nchars, int & result) {
+	const FrequentWordTable * table = voikkoOptions->frequentWords;
+	casetype caps;
+	if (SimpleChar::isLower(word[0])) {
+		caps = CT_ALL_LOWER;
+	}
+	else if (SimpleChar::isUpper(word[0]) && nchars > 1) {
+		caps = CT_FIRST_UPPER;
+	}
+	else {
+		return false;
+	}
+	for (size_t i = 1; i < nchars; i++) {
+		if (!SimpleChar::isLower(word[i])) {
+			return false;
+		}
+	}
+	spellresult sres;
+	if (!table->lookup(word, nchars, SimpleChar::lower(word[0]), sres)) {
+		return false;
+	}
+	result = caseAwareResult(voikkoOptions, caps, sres, word[0]);
+	// Adding missing hyphens could still make the word correct
+	return result == VOIKKO_SPELL_OK || !voikkoOptions->accept_missing_hyphens;
+}
+
+/**
+ * Scratch buffers for checking a single word. These are sized for the longest
+ * word that will be checked so that they can be reused for any number of words.
+ */
+struct SpellBuffers {
+	wchar_t ucs4Word[LIBVOIKKO_MAX_WORD_CHARS + 1];
+	wchar_t normalised[LIBVOIKKO_MAX_WORD_CHARS * 3 + 1];
+	wchar_t lowered[LIBVOIKKO_MAX_WORD_CHARS * 3 + 1];
+};
+
+/**
+ * Checks the spelling of a word using the given scratch buffers.
+ */
+static int spellUcs4(voikko_options_t * voikkoOptions, const wchar_t * word, SpellBuffers & buffers) {
 	size_t nchars = wcslen(word);
 	int result;
 	spellresult sres;
@@ -113,17 +251,16 @@ VOIKKOEXPORT int voikkoSpellUcs4(voikko_options_t * voikkoOptions, const wchar_t
 	if (nchars > LIBVOIKKO_MAX_WORD_CHARS) {
 		return VOIKKO_SPELL_FAILED;
 	}
-	
-	wchar_t * nword = voikko_normalise(word, nchars);
-	if (nword == 0) {
-		return VOIKKO_INTERNAL_ERROR;
+	if (voikkoOptions->frequentWords && spellFrequentWord(voikkoOptions, word, nchars, result)) {
+		return result;
 	}
-	nchars = wcslen(nword);
+	
+	const wchar_t * nword = buffers.normalised;
+	nchars = voikko_normalise(word, nchars, buffers.normalised);
 	
 	if (voikkoOptions->ignore_numbers) {
 		for (size_t i = 0; i < nchars; i++) {
 			if (SimpleChar::isDigit(nword[i])) {
-				delete[] nword;
 				return VOIKKO_SPELL_OK;
 			}
 		}
@@ -131,7 +268,6 @@ VOIKKOEXPORT int voikkoSpellUcs4(voikko_options_t * voikkoOptions, const wchar_t
 	casetype caps = voikko_casetype(nword, nchars);
 	if ((voikkoOptions->ignore_uppercase && caps == CT_ALL_UPPER) ||
 	    (voikkoOptions->ignore_nonwords && voikko_is_nonword(nword, nchars))) {
-		delete[] nword;
 		return VOIKKO_SPELL_OK;
 	}
 	if (caps == CT_ALL_UPPER && !voikkoOptions->accept_all_uppercase) {
@@ -139,102 +275,45 @@ VOIKKOEXPORT int voikkoSpellUcs4(voikko_options_t * voikkoOptions, const wchar_t
 		caps = CT_COMPLEX;
 	}
 	
-	wchar_t * buffer = new wchar_t[nchars + 1];
+	wchar_t * buffer = buffers.lowered;
 
 	for (size_t i = 0; i < nchars; i++) {
 		buffer[i] = SimpleChar::lower(nword[i]);
 	}
 	buffer[nchars] = L'\0';
 	
-	int dot_index;
-	size_t realChars;
-	if (voikkoOptions->ignore_dot && buffer[nchars - 1] == L'.') {
-		dot_index = static_cast<int>(nchars - 1);
-		buffer[dot_index] = L'\0';
-		realChars = nchars - 1;
-	}
-	else {
-		dot_index = -1;
-		realChars = nchars;
-	}
-	
-	/* Check words that require exact captialisation */
+	SpellerCache * cache = voikkoOptions->spellerCache;
 	if (caps == CT_COMPLEX || caps == CT_NO_LETTERS) {
+		/* Words that require exact capitalisation are checked as such and not cached */
 		wcsncpy(buffer, nword, nchars);
 		buffer[0] = SimpleChar::lower(buffer[0]);
-		sres = hyphenAwareSpell(voikkoOptions, buffer, nchars);
-		if (sres == SPELL_OK ||
-		    (sres == SPELL_CAP_FIRST && voikkoOptions->accept_first_uppercase && SimpleChar::isUpper(nword[0]))) {
-			result = VOIKKO_SPELL_OK;
-		}
-		else {
-			result = VOIKKO_SPELL_FAILED;
-		}
-		if (result == VOIKKO_SPELL_FAILED && dot_index != -1) { /* remove dot */
-			buffer[dot_index] = L'\0';
-			sres = hyphenAwareSpell(voikkoOptions, buffer, realChars);
-			if (sres == SPELL_OK ||
-			    (sres == SPELL_CAP_FIRST && voikkoOptions->accept_first_uppercase && SimpleChar::isUpper(nword[0]))) {
-				result = VOIKKO_SPELL_OK;
-			}
-		}
-		delete[] nword;
-		delete[] buffer;
-		return result;
+		cache = 0;
 	}
 	
-	
-	/* Check without trailing dot */
-	sres = voikko_cached_spell(voikkoOptions, buffer, realChars);
-	switch (caps) {
-		case CT_ALL_LOWER:
-			result = (sres == SPELL_OK) ? VOIKKO_SPELL_OK : VOIKKO_SPELL_FAILED;
-			break;
-		case CT_FIRST_UPPER:
-			if ((sres == SPELL_OK && voikkoOptions->accept_first_uppercase) || sres == SPELL_CAP_FIRST)
-				result = VOIKKO_SPELL_OK;
-			else result = VOIKKO_SPELL_FAILED;
-			break;
-		case CT_ALL_UPPER:
-			result = (sres == SPELL_FAILED) ? VOIKKO_SPELL_FAILED : VOIKKO_SPELL_OK;
-			break;
-		default: /* should not happen */
-			result = VOIKKO_INTERNAL_ERROR;
+	if (!voikkoOptions->ignore_dot || buffer[nchars - 1] != L'.') {
+		sres = spellPossiblyCached(voikkoOptions, cache, buffer, nchars);
+		return caseAwareResult(voikkoOptions, caps, sres, nword[0]);
 	}
+	
+	spellresult withDot;
+	spellresult withoutDot;
+	spellDotVariants(voikkoOptions, cache, buffer, nchars, withDot, withoutDot);
+	result = caseAwareResult(voikkoOptions, caps, withoutDot, nword[0]);
 	if (result == VOIKKO_SPELL_OK) {
-		delete[] nword;
-		delete[] buffer;
-		return VOIKKO_SPELL_OK;
+		return result;
 	}
-	
-	/* Check with trailing dot */
-	if (dot_index != -1) {
-		buffer[dot_index] = L'.';
-		switch (caps) {
-			case CT_ALL_LOWER:
-				sres = voikko_cached_spell(voikkoOptions, buffer, nchars);
-				result = (sres == SPELL_OK) ? VOIKKO_SPELL_OK : VOIKKO_SPELL_FAILED;
-				break;
-			case CT_FIRST_UPPER:
-				sres = voikko_cached_spell(voikkoOptions, buffer, nchars);
-				if ((sres == SPELL_OK && voikkoOptions->accept_first_uppercase) || sres == SPELL_CAP_FIRST)
-					result = VOIKKO_SPELL_OK;
-				else result = VOIKKO_SPELL_FAILED;
-				break;
-			case CT_ALL_UPPER:
-				sres = voikko_cached_spell(voikkoOptions, buffer, nchars);
-				result = (sres == SPELL_FAILED) ? VOIKKO_SPELL_FAILED : VOIKKO_SPELL_OK;
-				break;
-			default: /* should not happen */
-				result = VOIKKO_INTERNAL_ERROR;
-		}
+	if (withoutDot == SPELL_OK) {
+		// Correct word was rejected because of its case (first letter in upper
+		// case when that is not accepted), so the result with the dot is needed.
+		withDot = spellPossiblyCached(voikkoOptions, cache, buffer, nchars);
 	}
-	delete[] nword;
-	delete[] buffer;
-	return result;
+	return caseAwareResult(voikkoOptions, caps, withDot, nword[0]);
 }
 
-VOIKKOEXPORT int voikkoSpellCstr(voikko_options_t * handle, const char * word) {
+/**
+ * Checks the spelling of a null terminated UTF-8 word using the given scratch buffers.
+ */
+static int spellUtf8(voikko_options_t * voikkoOptions, const char * word, SpellBuffers & buffers) {
 	if (word == 0 || word[0] == '\0') {
 		return VOIKKO_SPELL_OK;
 	}
@@ -242,13 +321,440 @@ VOIKKOEXPORT int voikkoSpellCstr(voikko_options_t * handle, const char * word) {
 	if (len > LIBVOIKKO_MAX_WORD_CHARS) {
 		return VOIKKO_SPELL_FAILED;
 	}
-	wchar_t * word_ucs4 = utils::StringUtils::ucs4FromUtf8(word, len);
-	if (word_ucs4 == 0) {
+	if (utils::StringUtils::ucs4FromUtf8(word, len, buffers.ucs4Word, LIBVOIKKO_MAX_WORD_CHARS + 1)
+	    > LIBVOIKKO_MAX_WORD_CHARS + 1) {
 		return VOIKKO_CHARSET_CONVERSION_FAILED;
 	}
-	int result = voikkoSpellUcs4(handle, word_ucs4);
-	delete[] word_ucs4;
+	return spellUcs4(voikkoOptions, buffers.ucs4Word, buffers);
+}
+
+static bool batchWordEquals(const char * a, const char * b) {
+	return strcmp(a, b) == 0;
+}
+
+static bool batchWordEquals(const wchar_t * a, const wchar_t * b) {
+	return wcscmp(a, b) == 0;
+}
+
+/**
+ * Tells whether the word at given index of a batch is equal to a word.
+ */
+template <typename CharT>
+struct BatchWordEquals {
+	const CharT * const * words;
+	const CharT * word;
+	bool operator()(size_t index) const {
+		return batchWordEquals(words[index], word);
+	}
+};
+
+static int spellBatchWord(voikko_options_t * voikkoOptions, const char * word, SpellBuffers & buffers) {
+	return spellUtf8(voikkoOptions, word, buffers);
+}
+
+static int spellBatchWord(voikko_options_t * voikkoOptions, const wchar_t * word, SpellBuffers & buffers) {
+	if (word == 0) {
+		return VOIKKO_SPELL_OK;
+	}
+	return spellUcs4(voikkoOptions, word, buffers);
+}
+
+/**
+ * Checks a batch of words. Each distinct word is checked only once: words are
+ * entered into an open addressing table of indexes to earlier words in the
+ * batch and repeated words get the result of their first occurrence.
+ * Lookups do not continue from the prefix shared with the previous word as
+ * in analysis batches: spellers stop at the first accepting path, so the
+ * saved states would never be complete enough to be reused.
+ */
+template <typename CharT>
+static void spellBatch(voikko_options_t * voikkoOptions, const CharT * const * words,
+                       size_t wordCount, int * results) {
+	if (wordCount == 0) {
+		return;
+	}
+	SpellBuffers buffers;
+	utils::IndexTable seen(wordCount);
+	for (size_t i = 0; i < wordCount; i++) {
+		const CharT * word = words[i];
+		if (word == 0) {
+			results[i] = VOIKKO_SPELL_OK;
+			continue;
+		}
+		BatchWordEquals<CharT> equals = { words, word };
+		size_t first = seen.findOrInsert(utils::fnvHash(word), i, equals);
+		if (first != i) {
+			results[i] = results[first];
+			continue;
+		}
+		results[i] = spellBatchWord(voikkoOptions, word, buffers);
+	}
+}
+
+/**
+ * Distinct word of a text that has been checked. The word is the one at
+ * startpos in the text where it was first seen.
+ */
+struct CheckedWord {
+	size_t startpos;
+	size_t wordlen;
+	int result;
+};
+
+/**
+ * Tells whether the checked word at given index is equal to a word of the text.
+ */
+struct CheckedWordEquals {
+	const vector<CheckedWord> & words;
+	const wchar_t * text;
+	const wchar_t * word;
+	size_t wordlen;
+	bool operator()(size_t index) const {
+		return words[index].wordlen == wordlen &&
+		       wmemcmp(text + words[index].startpos, word, wordlen) == 0;
+	}
+};
+
+static int spellTextWord(voikko_options_t * voikkoOptions, const wchar_t * word, size_t len,
+                         SpellBuffers & buffers) {
+	if (len > LIBVOIKKO_MAX_WORD_CHARS) {
+		return VOIKKO_SPELL_FAILED;
+	}
+	wmemcpy(buffers.ucs4Word, word, len);
+	buffers.ucs4Word[len] = L'\0';
+	return spellUcs4(voikkoOptions, buffers.ucs4Word, buffers);
+}
+
+/**
+ * Checks the words of a text. Like in spellBatch each distinct word is checked
+ * only once, but as the number of words is not known in advance the table of
+ * words seen so far is grown when it becomes half full.
+ */
+static VoikkoSpellingError * checkText(voikko_options_t * voikkoOptions, const wchar_t * text,
+                                       size_t textlen, size_t * errorCount) {
+	SpellBuffers buffers;
+	vector<CheckedWord> words;
+	vector<VoikkoSpellingError> errors;
+	utils::IndexTable seen(32);
+	size_t position = 0;
+	while (position < textlen) {
+		size_t tokenlen;
+		voikko_token_type type = tokenizer::Tokenizer::nextToken(voikkoOptions, text + position,
+		                                                         textlen - position, &tokenlen);
+		if (type == TOKEN_NONE) {
+			break;
+		}
+		if (type == TOKEN_WORD) {
+			const wchar_t * word = text + position;
+			CheckedWordEquals equals = { words, text, word, tokenlen };
+			size_t index = seen.findOrInsert(utils::fnvHash(word, tokenlen), words.size(), equals);
+			int result;
+			if (index < words.size()) {
+				result = words[index].result;
+			}
+			else {
+				result = spellTextWord(voikkoOptions, word, tokenlen, buffers);
+				CheckedWord checked = { position, tokenlen, result };
+				words.push_back(checked);
+			}
+			if (result != VOIKKO_SPELL_OK) {
+				VoikkoSpellingError error = { position, tokenlen, result };
+				errors.push_back(error);
+			}
+		}
+		position += tokenlen;
+	}
+	*errorCount = errors.size();
+	VoikkoSpellingError * result = new VoikkoSpellingError[errors.size()];
+	copy(errors.begin(), errors.end(), result);
+	return result;
+}
+
+/**
+ * Finds words that begin with given word. The case of the first letter of the
+ * word is kept in the completions.
+ * @return false if the speller cannot list words
+ */
+static bool completeWord(voikko_options_t * voikkoOptions, const wchar_t * word, size_t len,
+                         size_t maxCount, list<wstring> & completions) {
+	if (len == 0 || len > LIBVOIKKO_MAX_WORD_CHARS) {
+		return len == 0;
+	}
+	wchar_t normalised[LIBVOIKKO_MAX_WORD_CHARS * 3 + 1];
+	size_t nchars = voikko_normalise(word, len, normalised);
+	bool firstUpper = SimpleChar::isUpper(normalised[0]);
+	wchar_t lowered[LIBVOIKKO_MAX_WORD_CHARS * 3 + 1];
+	for (size_t i = 0; i < nchars; i++) {
+		lowered[i] = SimpleChar::lower(normalised[i]);
+	}
+	list<wstring> found;
+	if (!voikkoOptions->speller->complete(lowered, nchars, maxCount, found)) {
+		return false;
+	}
+	if (firstUpper) {
+		// words that are written with an upper case letter in the dictionary come first
+		list<wstring> lowerFound;
+		lowerFound.swap(found);
+		lowered[0] = normalised[0];
+		voikkoOptions->speller->complete(lowered, nchars, maxCount, found);
+		for (list<wstring>::iterator i = lowerFound.begin(); i != lowerFound.end(); ++i) {
+			(*i)[0] = SimpleChar::upper((*i)[0]);
+			if (find(found.begin(), found.end(), *i) == found.end()) {
+				found.push_back(*i);
+			}
+		}
+	}
+	for (list<wstring>::const_iterator i = found.begin(); i != found.end() && maxCount > 0; ++i, maxCount--) {
+		completions.push_back(*i);
+	}
+	return true;
+}
+
+VOIKKOEXPORT IncrementalSpeller * voikkoCreateIncrementalSpeller(voikko_options_t * voikkoOptions) {
+	return new IncrementalSpeller(voikkoOptions);
+}
+
+VOIKKOEXPORT void voikkoDeleteIncrementalSpeller(IncrementalSpeller * speller) {
+	delete speller;
+}
+
+VOIKKOEXPORT int voikkoIncrementalAppendUcs4(IncrementalSpeller * speller, const wchar_t * chars) {
+	return speller->append(chars, wcslen(chars)) ? 1 : 0;
+}
+
+VOIKKOEXPORT int voikkoIncrementalAppendCstr(IncrementalSpeller * speller, const char * chars) {
+	wchar_t * charsUcs4 = utils::StringUtils::ucs4FromUtf8(chars);
+	if (charsUcs4 == 0) {
+		return 0;
+	}
+	bool appended = speller->append(charsUcs4, wcslen(charsUcs4));
+	delete[] charsUcs4;
+	return appended ? 1 : 0;
+}
+
+VOIKKOEXPORT void voikkoIncrementalRemove(IncrementalSpeller * speller, size_t count) {
+	speller->remove(count);
+}
+
+VOIKKOEXPORT int voikkoIncrementalSpell(IncrementalSpeller * speller) {
+	int result = speller->getSpellResult();
+	if (result == IncrementalSpeller::UNKNOWN) {
+		SpellBuffers buffers;
+		result = spellUcs4(speller->getOptions(), speller->getWord(), buffers);
+		speller->setSpellResult(result);
+	}
 	return result;
 }
 
+VOIKKOEXPORT int voikkoIncrementalCanContinue(IncrementalSpeller * speller) {
+	int continuable = speller->getContinuable();
+	if (continuable == IncrementalSpeller::UNKNOWN) {
+		if (voikkoIncrementalSpell(speller) == VOIKKO_SPELL_OK) {
+			continuable = 1;
+		}
+		else {
+			// Spellers that cannot list words cannot rule out any prefix
+			list<wstring> completions;
+			continuable = (!completeWord(speller->getOptions(), speller->getWord(), speller->getLength(), 1, completions) ||
+			               !completions.empty()) ? 1 : 0;
+		}
+		speller->setContinuable(continuable == 1);
+	}
+	return continuable;
+}
+
+VOIKKOEXPORT wchar_t ** voikkoIncrementalCompletionsUcs4(IncrementalSpeller * speller, size_t maxCount) {
+	list<wstring> completions;
+	completeWord(speller->getOptions(), speller->getWord(), speller->getLength(), maxCount, completions);
+	if (completions.empty()) {
+		return 0;
+	}
+	wchar_t ** result = new wchar_t*[completions.size() + 1];
+	size_t i = 0;
+	for (list<wstring>::const_iterator it = completions.begin(); it != completions.end(); ++it) {
+		result[i++] = utils::StringUtils::copy(it->c_str());
+	}
+	result[i] = 0;
+	return result;
+}
+
+VOIKKOEXPORT char ** voikkoIncrementalCompletionsCstr(IncrementalSpeller * speller, size_t maxCount) {
+	list<wstring> completions;
+	completeWord(speller->getOptions(), speller->getWord(), speller->getLength(), maxCount, completions);
+	if (completions.empty()) {
+		return 0;
+	}
+	char ** result = new char*[completions.size() + 1];
+	size_t i = 0;
+	for (list<wstring>::const_iterator it = completions.begin(); it != completions.end(); ++it) {
+		char * completion = utils::StringUtils::utf8FromUcs4(it->c_str());
+		if (completion) {
+			result[i++] = completion;
+		}
+	}
+	result[i] = 0;
+	return result;
+}
+
+VOIKKOEXPORT int voikkoSpellUcs4(voikko_options_t * voikkoOptions, const wchar_t * word) {
+	SpellBuffers buffers;
+	return spellUcs4(voikkoOptions, word, buffers);
+}
+
+VOIKKOEXPORT void voikkoSpellBatchUcs4(voikko_options_t * voikkoOptions, const wchar_t * const * words,
+                                       size_t wordCount, int * results) {
+	spellBatch(voikkoOptions, words, wordCount, results);
+}
+
+VOIKKOEXPORT VoikkoSpellingError * voikkoCheckTextUcs4(voikko_options_t * voikkoOptions, const wchar_t * text,
+                                                       size_t textlen, size_t * errorCount) {
+	return checkText(voikkoOptions, text, text ? textlen : 0, errorCount);
+}
+
+VOIKKOEXPORT void voikkoFreeSpellingErrors(VoikkoSpellingError * errors) {
+	delete[] errors;
+}
+
+VOIKKOEXPORT void voikkoGetSpellerCacheStatistics(voikko_options_t * voikkoOptions, size_t * hits, size_t * misses) {
+	SpellerCache * cache = voikkoOptions->spellerCache;
+	*hits = cache ? cache->getHitCount() : 0;
+	*misses = cache ? cache->getMissCount() : 0;
+}
+
+/**
+ * Header of a speller cache snapshot file. The header is followed by
+ * dataLength bytes of words saved by SpellerCache::save.
+ */
+struct CacheSnapshotHeader {
+	uint32_t cookie;
+	uint32_t formatVersion;
+	/** Identifies the dictionary the results were produced with, see snapshotStamp */
+	uint64_t dictionaryStamp;
+	uint64_t dataLength;
+	/** Values of the options that affect the results of the speller */
+	uint32_t spellerOptions;
+	uint32_t reserved;
+};
+
+static const uint32_t SNAPSHOT_COOKIE = 0x53534356; // "VCSS"
+static const uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+
+/**
+ * Computes a checksum of the dictionary description and of the transducer
+ * files of the dictionary. As in the keys of fst::TransducerRegistry, the
+ * files are identified by their path, size and modification time, so they
+ * are not read when a snapshot is saved or loaded.
+ * @return false if the dictionary has no transducer files. The results of
+ *         other backends cannot be tied to a version of the dictionary.
+ */
+static bool snapshotStamp(const setup::Dictionary & dictionary, uint64_t & stamp) {
+	static const char * const FILE_NAMES[] = {"/mor.vfst", "/spl.vfst"};
+	const setup::LanguageTag & language = dictionary.getLanguage();
+	ostringstream identity;
+	identity << language.getLanguage() << "\n" << language.getScript() << "\n" <<
+	            language.getPrivateUse() << "\n" << dictionary.getDescription() << "\n" <<
+	            dictionary.getMorBackend().getBackend() << "\n" << dictionary.getSpellBackend().getBackend();
+	bool found = false;
+	for (size_t i = 0; i < sizeof(FILE_NAMES) / sizeof(FILE_NAMES[0]); i++) {
+		string filePath = dictionary.getMorBackend().getPath() + FILE_NAMES[i];
+		struct stat st;
+		if (stat(filePath.c_str(), &st) == 0) {
+			identity << "\n" << filePath << ":" << st.st_size << ":" << st.st_mtime;
+			found = true;
+		}
+	}
+	if (!found) {
+		return false;
+	}
+	string identityString = identity.str();
+	stamp = utils::contentChecksum(identityString.data(), identityString.size());
+	return true;
+}
+
+static uint32_t snapshotSpellerOptions(voikko_options_t * voikkoOptions) {
+	return (voikkoOptions->accept_extra_hyphens ? 1 : 0) | (voikkoOptions->accept_missing_hyphens ? 2 : 0);
+}
+
+VOIKKOEXPORT int voikkoSaveCacheSnapshot(voikko_options_t * voikkoOptions, const char * fileName) {
+	SpellerCache * cache = voikkoOptions->spellerCache;
+	if (!cache || !fileName) {
+		return 0;
+	}
+	CacheSnapshotHeader header;
+	if (!snapshotStamp(voikkoOptions->dictionary, header.dictionaryStamp)) {
+		return 0;
+	}
+	string data;
+	cache->save(data);
+	header.cookie = SNAPSHOT_COOKIE;
+	header.formatVersion = SNAPSHOT_FORMAT_VERSION;
+	header.dataLength = data.size();
+	header.spellerOptions = snapshotSpellerOptions(voikkoOptions);
+	header.reserved = 0;
+	FILE * file = fopen(fileName, "wb");
+	if (!file) {
+		return 0;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+	          fwrite(data.data(), 1, data.size(), file) == data.size();
+	ok = (fclose(file) == 0) && ok;
+	return ok ? 1 : 0;
+}
+
+VOIKKOEXPORT int voikkoLoadCacheSnapshot(voikko_options_t * voikkoOptions, const char * fileName) {
+	SpellerCache * cache = voikkoOptions->spellerCache;
+	uint64_t stamp;
+	if (!cache || !fileName || !snapshotStamp(voikkoOptions->dictionary, stamp)) {
+		return 0;
+	}
+	FILE * file = fopen(fileName, "rb");
+	if (!file) {
+		return 0;
+	}
+	fseek(file, 0, SEEK_END);
+	long fileLength = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	CacheSnapshotHeader header;
+	// A partially written file does not match the length in the header
+	bool ok = fileLength >= static_cast<long>(sizeof(header)) &&
+	          fread(&header, sizeof(header), 1, file) == 1 &&
+	          header.cookie == SNAPSHOT_COOKIE &&
+	          header.formatVersion == SNAPSHOT_FORMAT_VERSION &&
+	          header.dataLength == static_cast<uint64_t>(fileLength) - sizeof(header) &&
+	          header.spellerOptions == snapshotSpellerOptions(voikkoOptions) &&
+	          header.dictionaryStamp == stamp;
+	string data;
+	if (ok && header.dataLength > 0) {
+		data.resize(header.dataLength);
+		ok = fread(&data[0], 1, data.size(), file) == data.size();
+	}
+	fclose(file);
+	return (ok && cache->load(data.data(), data.size())) ? 1 : 0;
+}
+
+VOIKKOEXPORT int voikkoSpellCstr(voikko_options_t * handle, const char * word) {
+	SpellBuffers buffers;
+	return spellUtf8(handle, word, buffers);
+}
+
+VOIKKOEXPORT void voikkoSpellBatchCstr(voikko_options_t * handle, const char * const * words,
+                                       size_t wordCount, int * results) {
+	spellBatch(handle, words, wordCount, results);
+}
+
+VOIKKOEXPORT VoikkoSpellingError * voikkoCheckTextCstr(voikko_options_t * handle, const char * text,
+                                                       size_t textlen, size_t * errorCount) {
+	if (text == 0) {
+		return checkText(handle, 0, 0, errorCount);
+	}
+	wchar_t * textUcs4 = utils::StringUtils::ucs4FromUtf8(text, textlen);
+	if (textUcs4 == 0) {
+		*errorCount = 0;
+		return 0;
+	}
+	VoikkoSpellingError * errors = checkText(handle, textUcs4, wcslen(textUcs4), errorCount);
+	delete[] textUcs4;
+	return errors;
+}
+
 }
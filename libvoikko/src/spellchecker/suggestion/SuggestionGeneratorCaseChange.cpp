@@ -53,8 +53,18 @@ void SuggestionGeneratorCaseChange::suggestForBuffer(Analyzer * morAnalyzer,
 	if (s->shouldAbort()) {
 		return;
 	}
-	spellresult sres = SpellWithPriority::spellWithPriority(morAnalyzer, word, wlen, &prio);
-	s->charge();
+	SuggestionStatus::CheckedWord & checked = s->checkedWord(word, wlen);
+	if (checked.suggested) {
+		return;
+	}
+	checked.suggested = true;
+	if (!checked.checked) {
+		checked.result = SpellWithPriority::spellWithPriority(morAnalyzer, word, wlen, &checked.priority);
+		checked.checked = true;
+		s->charge();
+	}
+	spellresult sres = checked.result;
+	prio = checked.priority;
 	switch (sres) {
 		case SPELL_FAILED:
 			return;
@@ -72,14 +82,15 @@ void SuggestionGeneratorCaseChange::suggestForBuffer(Analyzer * morAnalyzer,
 			s->addSuggestion(newsugg, prio);
 			return;
 		case SPELL_CAP_ERROR:
-			list<Analysis *> * analyses = morAnalyzer->analyze(word, wlen, false);
+			list<Analysis *> * analyses = morAnalyzer->analyze(word, wlen,
+			        Analysis::keyBit(Analysis::KEY_STRUCTURE));
 			s->charge();
 			if (analyses->empty()) {
 				Analyzer::deleteAnalyses(analyses);
 				return;
 			}
 			const wchar_t * structure =
-			    (*analyses->begin())->getValue("STRUCTURE");
+			    (*analyses->begin())->getValue(Analysis::KEY_STRUCTURE);
 			newsugg = new wchar_t[wlen + 1];
 			wcsncpy(newsugg, word, wlen);
 			newsugg[wlen] = L'\0';
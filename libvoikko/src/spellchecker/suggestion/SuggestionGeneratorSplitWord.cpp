@@ -47,8 +47,14 @@ bool SuggestionGeneratorSplitWord::spellOk(SuggestionStatus * s, wchar_t * word,
 	if (firstUpper) {
 		word[0] = SimpleChar::lower(word[0]);
 	}
-	spellresult wordRes = SpellWithPriority::spellWithPriority(morAnalyzer, word, len, &prioTotal);
-	s->charge();
+	SuggestionStatus::CheckedWord & checked = s->checkedWord(word, len);
+	if (!checked.checked) {
+		checked.result = SpellWithPriority::spellWithPriority(morAnalyzer, word, len, &checked.priority);
+		checked.checked = true;
+		s->charge();
+	}
+	spellresult wordRes = checked.result;
+	prioTotal = checked.priority;
 	if (firstUpper || wordRes == SPELL_CAP_FIRST) {
 		word[0] = SimpleChar::upper(word[0]);
 	}
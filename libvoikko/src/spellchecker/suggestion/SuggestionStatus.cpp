@@ -27,16 +27,25 @@
  *********************************************************************************/
 
 #include "spellchecker/suggestion/SuggestionStatus.hpp"
+#include "utils/Hash.hpp"
+#include <cwchar>
+
+using namespace std;
 
 namespace libvoikko { namespace spellchecker { namespace suggestion {
 
+static const size_t MEMO_INITIAL_SIZE = 128;
+
 SuggestionStatus::SuggestionStatus(const wchar_t * word, size_t wlen, size_t maxSuggestions) :
 	word(word),
 	wlen(wlen),
 	maxCost(0),
 	maxSuggestions(maxSuggestions),
 	suggestionCount(0),
-	currentCost(0) {
+	currentCost(0),
+	memo(),
+	memoIndex(MEMO_INITIAL_SIZE),
+	memoText() {
 	suggestions = new Suggestion[maxSuggestions + 1];
 }
 
@@ -70,6 +79,36 @@ void SuggestionStatus::setMaxCost(size_t maxCost) {
 	this->maxCost = maxCost;
 }
 
+/**
+ * Tells whether the memo entry at given index is for given word.
+ */
+struct SuggestionStatus::MemoEquals {
+	const SuggestionStatus & status;
+	const wchar_t * word;
+	size_t len;
+	bool operator()(size_t index) const {
+		const MemoEntry & entry = status.memo[index];
+		return entry.len == len &&
+		       (len == 0 || wmemcmp(&status.memoText[entry.textStart], word, len) == 0);
+	}
+};
+
+SuggestionStatus::CheckedWord & SuggestionStatus::checkedWord(const wchar_t * word, size_t len) {
+	MemoEquals equals = { *this, word, len };
+	size_t index = memoIndex.findOrInsert(utils::fnvHash(word, len), memo.size(), equals);
+	if (index < memo.size()) {
+		return memo[index].word;
+	}
+	MemoEntry entry;
+	entry.textStart = memoText.size();
+	entry.len = len;
+	entry.word.suggested = false;
+	entry.word.checked = false;
+	memo.push_back(entry);
+	memoText.insert(memoText.end(), word, word + len);
+	return memo.back().word;
+}
+
 void SuggestionStatus::addSuggestion(const wchar_t * newSuggestion, int priority) {
 	if (suggestionCount < maxSuggestions) {
 		int finalPriority = priority * (suggestionCount + 5);
@@ -30,7 +30,10 @@
 #define VOIKKO_SPELLCHECKER_SUGGESTION_SUGGESTION_STATUS_H
 
 #include "spellchecker/suggestion/Suggestion.hpp"
+#include "spellchecker/Speller.hpp"
+#include "utils/Hash.hpp"
 #include <cstddef>
+#include <vector>
 
 namespace libvoikko { namespace spellchecker { namespace suggestion {
 
@@ -55,6 +58,26 @@ class SuggestionStatus {
 		/** Set maximum computational cost. */
 		void setMaxCost(size_t maxCost);
 		
+		/**
+		 * Information about a word that has been seen during this suggestion
+		 * request. Different generators often produce the same candidate and
+		 * split word suggestions check the same parts repeatedly.
+		 */
+		struct CheckedWord {
+			/** True if the word has already been considered as a suggestion */
+			bool suggested;
+			/** True if result and priority contain the result of spelling check */
+			bool checked;
+			spellresult result;
+			int priority;
+		};
+		
+		/**
+		 * Returns the memo entry for given word, adding an empty entry if the word
+		 * has not been seen before. The reference is valid until the next call.
+		 */
+		CheckedWord & checkedWord(const wchar_t * word, size_t len);
+		
 		/**
 		 * Adds a new suggestion with given priority. The ownership of suggestion
 		 * string is transferred to this object.
@@ -95,6 +118,16 @@ class SuggestionStatus {
 		SuggestionStatus(SuggestionStatus const & other);
 		SuggestionStatus & operator = (const SuggestionStatus & other);
 		
+		struct MemoEntry {
+			/** Start of the word in memoText */
+			size_t textStart;
+			size_t len;
+			CheckedWord word;
+		};
+		
+		struct MemoEquals;
+		friend struct MemoEquals;
+		
 		/** string to find suggestions for */
 		const wchar_t * const word;
 		
@@ -119,6 +152,15 @@ class SuggestionStatus {
 		
 		/** Array of suggestions */
 		Suggestion * suggestions;
+		
+		/** Words seen during this request in the order they were first seen */
+		std::vector<MemoEntry> memo;
+		
+		/** Hash table of indexes to memo. It is allocated on first use. */
+		utils::IndexTable memoIndex;
+		
+		/** Characters of the words in memo */
+		std::vector<wchar_t> memoText;
 	};
 
 }}}
@@ -112,7 +112,7 @@ static size_t findUrlOrEmail(const wchar_t * text, size_t textlen) {
 	return textlen;
 }
 	
-static size_t word_length(const wchar_t * text, size_t textlen, voikko_options_t * options) {
+static size_t word_length(const wchar_t * text, size_t textlen, bool ignoreDot) {
 	size_t wlen = 0;
 	bool processing_number = false;
 	bool seenLetters = false;
@@ -123,7 +123,7 @@ static size_t word_length(const wchar_t * text, size_t textlen, voikko_options_t
 	}
 	
 	size_t adot;
-	if (options->ignore_dot) {
+	if (ignoreDot) {
 		adot = 1;
 	}
 	else adot = 0;
@@ -208,6 +208,10 @@ static size_t word_length(const wchar_t * text, size_t textlen, voikko_options_t
 }
 
 voikko_token_type Tokenizer::nextToken(voikko_options_t * options, const wchar_t * text, size_t textlen, size_t * tokenlen) {
+	return nextToken(text, textlen, tokenlen, options->ignore_dot != 0);
+}
+
+voikko_token_type Tokenizer::nextToken(const wchar_t * text, size_t textlen, size_t * tokenlen, bool ignoreDot) {
 	if (textlen == 0) {
 		*tokenlen = 0;
 		return TOKEN_NONE;
@@ -215,7 +219,7 @@ voikko_token_type Tokenizer::nextToken(voikko_options_t * options, const wchar_t
 	switch (get_char_type(text[0])) {
 		case CHAR_LETTER:
 		case CHAR_DIGIT:
-			*tokenlen = word_length(text, textlen, options);
+			*tokenlen = word_length(text, textlen, ignoreDot);
 			return TOKEN_WORD;
 		case CHAR_WHITESPACE:
 			for (size_t i = 1; i < textlen; i++) {
@@ -232,7 +236,7 @@ voikko_token_type Tokenizer::nextToken(voikko_options_t * options, const wchar_t
 					*tokenlen = 1;
 					return TOKEN_PUNCTUATION;
 				}
-				size_t wlen = word_length(text + 1, textlen - 1, options);
+				size_t wlen = word_length(text + 1, textlen - 1, ignoreDot);
 				if (wlen == 0) {
 					*tokenlen = 1;
 					return TOKEN_PUNCTUATION;
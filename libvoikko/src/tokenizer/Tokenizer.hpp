@@ -39,6 +39,14 @@ class Tokenizer {
 	public:
 		static voikko_token_type nextToken(voikko_options_t * options, const wchar_t * text,
                                            size_t textlen, size_t * tokenlen);
+		
+		/**
+		 * Same as above but with the value of ignore_dot option given explicitly.
+		 * The handle is not accessed, so this is safe to use for tokenizing with
+		 * options that differ from those of the handle.
+		 */
+		static voikko_token_type nextToken(const wchar_t * text, size_t textlen,
+                                           size_t * tokenlen, bool ignoreDot);
 };
 
 } }
@@ -0,0 +1,308 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#include "../voikko.h"
+#include "spellchecker/FrequentWordTable.hpp"
+#include "character/SimpleChar.hpp"
+#include "utf8/utf8.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iterator>
+
+using namespace libvoikko::spellchecker;
+using namespace libvoikko::character;
+using namespace libvoikko;
+using namespace std;
+
+struct FrequentWord {
+	wstring word;
+	long count;
+	spellresult result;
+};
+
+static bool moreFrequent(const FrequentWord & a, const FrequentWord & b) {
+	return a.count > b.count || (a.count == b.count && a.word < b.word);
+}
+
+/**
+ * Converts a word from the frequency list to the lower case form that is
+ * stored in the table.
+ * @return false if the word cannot be stored in the table
+ */
+static bool tableWord(const string & utf8Word, wstring & word) {
+	if (!utf8::is_valid(utf8Word.begin(), utf8Word.end())) {
+		return false;
+	}
+	vector<uint32_t> chars;
+	utf8::utf8to32(utf8Word.begin(), utf8Word.end(), back_inserter(chars));
+	if (chars.empty() || chars.size() > LIBVOIKKO_MAX_WORD_CHARS) {
+		return false;
+	}
+	word.clear();
+	for (size_t i = 0; i < chars.size(); i++) {
+		wchar_t c = SimpleChar::lower(static_cast<wchar_t>(chars[i]));
+		// ligatures would be changed by normalisation
+		if (!SimpleChar::isLower(c) || (c >= 0xFB00 && c <= 0xFB04)) {
+			return false;
+		}
+		word.push_back(c);
+	}
+	return true;
+}
+
+static bool spellOk(VoikkoHandle * handle, wstring word) {
+	return voikkoSpellUcs4(handle, word.c_str()) == VOIKKO_SPELL_OK;
+}
+
+/**
+ * Finds the result that the speller gives for a lower case word. The public
+ * interface only tells whether a word is correct, so the result is deduced
+ * from checking the word in lower case, capitalized and in upper case.
+ * @return false if the result cannot be determined
+ */
+static bool spellerResult(VoikkoHandle * handle, const wstring & word, spellresult & result) {
+	if (spellOk(handle, word)) {
+		result = SPELL_OK;
+		return true;
+	}
+	// A single upper case letter is all upper case, which does not tell
+	// SPELL_CAP_FIRST and SPELL_CAP_ERROR apart.
+	wstring upper(word);
+	upper[0] = SimpleChar::upper(upper[0]);
+	if (word.size() > 1 && spellOk(handle, upper)) {
+		result = SPELL_CAP_FIRST;
+		return true;
+	}
+	for (size_t i = 1; i < upper.size(); i++) {
+		upper[i] = SimpleChar::upper(upper[i]);
+	}
+	if (spellOk(handle, upper)) {
+		result = SPELL_CAP_ERROR;
+		return word.size() > 1;
+	}
+	result = SPELL_FAILED;
+	return true;
+}
+
+/**
+ * Places the words to slots so that each word is found with its bucket seed.
+ * Large buckets are placed first while there are many free slots.
+ * @param slotWords index of the word in each slot, -1 for an empty slot
+ * @return false if some bucket could not be placed
+ */
+static bool placeWords(const vector<FrequentWord> & words, uint32_t bucketCount, uint32_t slotCount,
+                       vector<uint32_t> & seeds, vector<long> & slotWords) {
+	vector<vector<size_t> > buckets(bucketCount);
+	for (size_t i = 0; i < words.size(); i++) {
+		const wstring & word = words[i].word;
+		buckets[FrequentWordTable::hash(word.data(), word.size(), word[0], 0) % bucketCount].push_back(i);
+	}
+	vector<pair<size_t, uint32_t> > order;
+	for (uint32_t b = 0; b < bucketCount; b++) {
+		if (!buckets[b].empty()) {
+			order.push_back(make_pair(buckets[b].size(), b));
+		}
+	}
+	sort(order.rbegin(), order.rend());
+	seeds.assign(bucketCount, 0);
+	slotWords.assign(slotCount, -1);
+	vector<uint32_t> slots;
+	for (size_t o = 0; o < order.size(); o++) {
+		const vector<size_t> & bucket = buckets[order[o].second];
+		bool placed = false;
+		for (uint32_t seed = 1; seed < 0x100000 && !placed; seed++) {
+			slots.clear();
+			placed = true;
+			for (size_t i = 0; i < bucket.size() && placed; i++) {
+				const wstring & word = words[bucket[i]].word;
+				uint32_t slot = FrequentWordTable::hash(word.data(), word.size(), word[0], seed) % slotCount;
+				placed = slotWords[slot] == -1 && find(slots.begin(), slots.end(), slot) == slots.end();
+				slots.push_back(slot);
+			}
+			if (placed) {
+				for (size_t i = 0; i < bucket.size(); i++) {
+					slotWords[slots[i]] = bucket[i];
+				}
+				seeds[order[o].second] = seed;
+			}
+		}
+		if (!placed) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void writeTable(const string & outputFile, const vector<FrequentWord> & words, uint64_t stamp) {
+	uint32_t bucketCount = words.size() / 4 + 1;
+	uint32_t slotCount = words.size() + words.size() / 4 + 1;
+	vector<uint32_t> seeds;
+	vector<long> slotWords;
+	while (!placeWords(words, bucketCount, slotCount, seeds, slotWords)) {
+		slotCount += slotCount / 10 + 1;
+	}
+	
+	FrequentWordTableHeader header;
+	header.cookie = FrequentWordTable::COOKIE;
+	header.formatVersion = FrequentWordTable::FORMAT_VERSION;
+	header.dictionaryStamp = stamp;
+	header.bucketCount = bucketCount;
+	header.slotCount = slotCount;
+	header.poolLength = 0;
+	header.reserved = 0;
+	vector<FrequentWordSlot> slots(slotCount);
+	vector<uint32_t> pool;
+	for (uint32_t i = 0; i < slotCount; i++) {
+		FrequentWordSlot & slot = slots[i];
+		slot.wordOffset = 0;
+		slot.wordLength = 0;
+		slot.result = 0;
+		slot.reserved = 0;
+		if (slotWords[i] != -1) {
+			const FrequentWord & word = words[slotWords[i]];
+			slot.wordOffset = pool.size();
+			slot.wordLength = word.word.size();
+			slot.result = word.result;
+			pool.insert(pool.end(), word.word.begin(), word.word.end());
+		}
+	}
+	header.poolLength = pool.size();
+	
+	// Processes that have the old table mapped keep using it until they are restarted
+	string tmpFile = outputFile + ".tmp";
+	ofstream out(tmpFile.c_str(), ios::out | ios::binary | ios::trunc);
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char *>(&seeds[0]), seeds.size() * sizeof(uint32_t));
+	out.write(reinterpret_cast<const char *>(&slots[0]), slots.size() * sizeof(FrequentWordSlot));
+	if (!pool.empty()) {
+		out.write(reinterpret_cast<const char *>(&pool[0]), pool.size() * sizeof(uint32_t));
+	}
+	out.close();
+	if (!out || rename(tmpFile.c_str(), outputFile.c_str()) != 0) {
+		cerr << "ERROR: could not write " << outputFile << endl;
+		remove(tmpFile.c_str());
+		exit(1);
+	}
+}
+
+int main(int argc, char ** argv) {
+	string directory;
+	string language;
+	string outputFile;
+	size_t maxCount = 20000;
+	for (int i = 1; i < argc; i++) {
+		string args(argv[i]);
+		if (args == "-d" && i + 1 < argc) {
+			directory = string(argv[++i]);
+		}
+		else if (args == "-l" && i + 1 < argc) {
+			language = string(argv[++i]);
+		}
+		else if (args == "-o" && i + 1 < argc) {
+			outputFile = string(argv[++i]);
+		}
+		else if (args == "-n" && i + 1 < argc) {
+			maxCount = atol(argv[++i]);
+		}
+		else {
+			cerr << "ERROR: unknown option " << args << endl;
+			exit(1);
+		}
+	}
+	if (directory.empty() || language.empty()) {
+		cerr << "ERROR: dictionary directory and language need to be specified" << endl;
+		exit(1);
+	}
+	if (outputFile.empty()) {
+		outputFile = directory + "/frequent.vfw";
+	}
+	
+	uint64_t stamp;
+	if (!FrequentWordTable::dictionaryStamp(directory, stamp)) {
+		cerr << "ERROR: no transducer files in " << directory << endl;
+		exit(1);
+	}
+	// The directory is <path>/<format version>/mor-<variant>
+	string searchPath = directory + "/../..";
+	const char * error;
+	VoikkoHandle * handle = voikkoInit(&error, language.c_str(), searchPath.c_str());
+	if (!handle) {
+		cerr << "ERROR: " << error << endl;
+		exit(1);
+	}
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_IGNORE_DOT, 0);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_IGNORE_NUMBERS, 0);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_IGNORE_UPPERCASE, 0);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_ACCEPT_FIRST_UPPERCASE, 0);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_ACCEPT_ALL_UPPERCASE, 1);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_ACCEPT_EXTRA_HYPHENS, 0);
+	voikkoSetBooleanOption(handle, VOIKKO_OPT_ACCEPT_MISSING_HYPHENS, 0);
+	
+	// Input lines are "count word" as written by "uniq -c"
+	map<wstring, long> counts;
+	string line;
+	while (getline(cin, line)) {
+		istringstream ss(line);
+		long count;
+		string utf8Word;
+		wstring word;
+		if (ss >> count >> utf8Word && tableWord(utf8Word, word)) {
+			counts[word] += count;
+		}
+	}
+	vector<FrequentWord> words;
+	for (map<wstring, long>::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+		FrequentWord word;
+		word.word = it->first;
+		word.count = it->second;
+		word.result = SPELL_FAILED;
+		words.push_back(word);
+	}
+	sort(words.begin(), words.end(), moreFrequent);
+	if (words.size() > maxCount) {
+		words.resize(maxCount);
+	}
+	vector<FrequentWord> tableWords;
+	for (size_t i = 0; i < words.size(); i++) {
+		if (spellerResult(handle, words[i].word, words[i].result)) {
+			tableWords.push_back(words[i]);
+		}
+	}
+	voikkoTerminate(handle);
+	
+	writeTable(outputFile, tableWords, stamp);
+	cerr << tableWords.size() << " words written to " << outputFile << endl;
+	return 0;
+}
@@ -400,10 +400,13 @@ int main(int argc, char ** argv) {
 		return list_capabilities(path);
 	}
 	
+	const char * voikkoError;
+	// Dictionaries that cannot be shared are loaded separately for each thread
+	VoikkoSharedHandle * shared = voikkoInitShared(&voikkoError, variant, path);
 	spellers = new speller_t[threadCount];
 	for (int i = 0; i < threadCount; i++) {
-		const char * voikkoError;
-		VoikkoHandle * handle = voikkoInit(&voikkoError, variant, path);
+		VoikkoHandle * handle = shared ? voikkoCreateSession(shared, &voikkoError) :
+		                                 voikkoInit(&voikkoError, variant, path);
 		if (!handle) {
 			cerr << "E: Initialization of Voikko failed: " << voikkoError << endl;
 			return 1;
@@ -412,6 +415,9 @@ int main(int argc, char ** argv) {
 		spellers[i].handle = handle;
 		spellers[i].words = 0;
 	}
+	if (shared) {
+		voikkoTerminateShared(shared);
+	}
 	
 	for (int i = 1; i < argc; i++) {
 		string args(argv[i]);
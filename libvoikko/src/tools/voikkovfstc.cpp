@@ -56,7 +56,7 @@ static uint16_t swap(uint16_t x) {
 }
 
 static int16_t swap(int16_t x) {
-	return (x>>8) | (x<<8);
+	return static_cast<int16_t>(swap(static_cast<uint16_t>(x)));
 }
 
 static uint16_t swapIf(bool doSwap, uint16_t x) {
@@ -193,6 +193,155 @@ static void setTarget(WeightedTransition & t, vector<uint32_t> & stateOrdinalToO
 	t.targetState = stateOrdinalToOffset[targetStateOrdinal];
 }
 
+static void writeLittleEndian(ofstream & out, uint32_t x, uint32_t bytes) {
+	for (uint32_t i = 0; i < bytes; i++) {
+		out.put((char) ((x >> (8 * i)) & 0xFF));
+	}
+}
+
+static void writePaddingTo8(ofstream & out) {
+	while (out.tellp() % 8 != 0) {
+		out.put(0);
+	}
+}
+
+static uint64_t zigzagDelta(uint32_t from, uint32_t to) {
+	int64_t delta = (int64_t) to - (int64_t) from;
+	return delta >= 0 ? (uint64_t) delta * 2 : (uint64_t) (-delta) * 2 - 1;
+}
+
+/**
+ * Writes the transducer in compact format (see fst/CompactTransducer.hpp).
+ */
+static int writeCompact(const string & outputFile, vector<Symbol> & symVector, vector<AttState> & attStateVector) {
+	if (symVector.size() >= 0xFFFF) {
+		cerr << "ERROR: too many symbols for compact format" << endl;
+		return 1;
+	}
+	// In compact format states are stored without overflow cells, so the state
+	// offset is simply the number of transitions before it.
+	vector<uint32_t> stateOrdinalToOffset;
+	uint64_t recordCount = 0;
+	for (vector<AttState>::iterator it = attStateVector.begin(); it < attStateVector.end(); it++) {
+		stateOrdinalToOffset.push_back(recordCount);
+		if (it->transitions.empty()) {
+			cerr << "ERROR: non-final state without outgoing transitions: " << stateOrdinalToOffset.size() << endl;
+			return 1;
+		}
+		recordCount += it->transitions.size();
+	}
+	if (recordCount >= 0xFFFFFFFF) {
+		cerr << "ERROR: too many transitions for compact format" << endl;
+		return 1;
+	}
+	
+	// Choose the target field width that gives the smallest file
+	uint32_t symbolBytes = symVector.size() < 0xFF ? 1 : 2;
+	uint32_t targetBytes = 0;
+	uint64_t bestSize = 0;
+	for (uint32_t bytes = 2; bytes <= 4; bytes++) {
+		uint64_t farFlag = (uint64_t) 1 << (8 * bytes - 1);
+		uint64_t farCount = 0;
+		uint32_t record = 0;
+		for (vector<AttState>::iterator it = attStateVector.begin(); it < attStateVector.end(); it++) {
+			for (size_t ti = 0; ti < it->transitions.size(); ti++, record++) {
+				if (it->transitions[ti].symIn != 0xFFFFFFFF) {
+					WeightedTransition t = it->transitions[ti];
+					setTarget(t, stateOrdinalToOffset, it->targetStateOrds[ti]);
+					if (zigzagDelta(record, t.targetState) >= farFlag) {
+						farCount++;
+					}
+				}
+			}
+		}
+		uint64_t size = recordCount * bytes + farCount * 4;
+		if (farCount < farFlag && (targetBytes == 0 || size < bestSize)) {
+			targetBytes = bytes;
+			bestSize = size;
+		}
+	}
+	uint32_t farFlag = (uint32_t) 1 << (8 * targetBytes - 1);
+	uint32_t symbolMax = symbolBytes == 1 ? 0xFF : 0xFFFF;
+	
+	vector<uint32_t> farTargets;
+	vector<uint32_t> storedTargets;
+	uint32_t record = 0;
+	for (vector<AttState>::iterator it = attStateVector.begin(); it < attStateVector.end(); it++) {
+		for (size_t ti = 0; ti < it->transitions.size(); ti++, record++) {
+			WeightedTransition & t = it->transitions[ti];
+			if (t.symIn == 0xFFFFFFFF) {
+				storedTargets.push_back(0);
+				continue;
+			}
+			setTarget(t, stateOrdinalToOffset, it->targetStateOrds[ti]);
+			uint64_t delta = zigzagDelta(record, t.targetState);
+			if (delta < farFlag) {
+				storedTargets.push_back(delta);
+			}
+			else {
+				storedTargets.push_back(farFlag | farTargets.size());
+				farTargets.push_back(t.targetState);
+			}
+		}
+	}
+	cout << "Record size: " << (2 * symbolBytes + targetBytes) << " bytes" << endl;
+	cout << "Far targets: " << farTargets.size() << endl;
+	
+	ofstream transducerFile(outputFile.c_str(), ios::out | ios::binary);
+	
+	// Write header. Compact files are always little endian.
+	writeLittleEndian(transducerFile, 0x00013A6E, 4);
+	writeLittleEndian(transducerFile, 0x000351FB, 4);
+	// Weights are not supported in compact format
+	transducerFile.put(0x00);
+	transducerFile.put(symbolBytes);
+	transducerFile.put(targetBytes);
+	// 5 bytes of reserved space. Must be zero for now.
+	for (int i = 0; i < 5; i++) {
+		transducerFile.put(0);
+	}
+	writeLittleEndian(transducerFile, recordCount, 4);
+	writeLittleEndian(transducerFile, farTargets.size(), 4);
+	
+	// Write symbols
+	writeLittleEndian(transducerFile, symVector.size(), 2);
+	for (vector<Symbol>::iterator it = symVector.begin(); it < symVector.end(); it++) {
+		transducerFile.write(it->text.c_str(), it->text.length());
+		transducerFile.put(0);
+	}
+	writePaddingTo8(transducerFile);
+	
+	// Write state start bits, including one for the end of the last state
+	{
+		vector<unsigned char> stateStarts(recordCount / 8 + 1, 0);
+		for (vector<uint32_t>::iterator it = stateOrdinalToOffset.begin(); it < stateOrdinalToOffset.end(); it++) {
+			stateStarts[*it / 8] |= 1 << (*it % 8);
+		}
+		stateStarts[recordCount / 8] |= 1 << (recordCount % 8);
+		transducerFile.write((char *) &stateStarts[0], stateStarts.size());
+		writePaddingTo8(transducerFile);
+	}
+	
+	for (vector<uint32_t>::iterator it = farTargets.begin(); it < farTargets.end(); it++) {
+		writeLittleEndian(transducerFile, *it, 4);
+	}
+	
+	// Write transition records
+	record = 0;
+	for (vector<AttState>::iterator it = attStateVector.begin(); it < attStateVector.end(); it++) {
+		for (size_t ti = 0; ti < it->transitions.size(); ti++, record++) {
+			WeightedTransition & t = it->transitions[ti];
+			bool final = (t.symIn == 0xFFFFFFFF);
+			writeLittleEndian(transducerFile, final ? symbolMax : t.symIn, symbolBytes);
+			writeLittleEndian(transducerFile, final ? 0 : t.symOut, symbolBytes);
+			writeLittleEndian(transducerFile, storedTargets[record], targetBytes);
+		}
+	}
+	
+	transducerFile.close();
+	return 0;
+}
+
 struct compareSymbolsForLookupOrder {
 	bool operator()(Symbol const & a, Symbol const & b) const {
 		if (a.text == b.text) {
@@ -233,6 +382,7 @@ int main(int argc, char ** argv) {
 	string outputFile;
 	string format = "le";
 	bool weights = false;
+	bool compact = false;
 	int16_t(*weightFunc)(double) = 0;
 	for (int i = 1; i < argc; i++) {
 		string args(argv[i]);
@@ -242,6 +392,9 @@ int main(int argc, char ** argv) {
 		else if (args == "-f" && i + 1 < argc) {
 			format = string(argv[++i]);
 		}
+		else if (args == "-c") {
+			compact = true;
+		}
 		else if (args == "-w" && i + 1 < argc) {
 			weights = true;
 			string weightType(argv[++i]);
@@ -262,6 +415,10 @@ int main(int argc, char ** argv) {
 		cerr << "ERROR: output file needs to be specified" << endl;
 		exit(1);
 	}
+	if (compact && weights) {
+		cerr << "ERROR: weighted transducers cannot be written in compact format" << endl;
+		exit(1);
+	}
 
 	bool byteSwap;
 	if (format == "le") {
@@ -400,6 +557,10 @@ int main(int argc, char ** argv) {
 		}
 	}
 	
+	if (compact) {
+		return writeCompact(outputFile, symVector, attStateVector);
+	}
+	
 	// Determine state offsets in binary transition table. Offsets are calculated
 	// in 8 byte cells.
 	vector<uint32_t> stateOrdinalToOffset;
@@ -0,0 +1,66 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef VOIKKO_UTILS_CHECKSUM
+#define VOIKKO_UTILS_CHECKSUM
+
+#include <cstring>
+#include <stdint.h>
+
+namespace libvoikko { namespace utils {
+
+/**
+ * Initial value for contentChecksum.
+ */
+inline uint64_t initialChecksum() {
+	return (static_cast<uint64_t>(0xCBF29CE4) << 32) | 0x84222325;
+}
+
+/**
+ * Computes 64 bit FNV-1a over given data, 8 bytes at a time. Data that is
+ * split to several calls gives the same result as when checked at once if
+ * all parts except the last one have a length that is a multiple of 8.
+ * @param checksum result of checking the preceding data
+ */
+inline uint64_t contentChecksum(const char * data, size_t length, uint64_t checksum = initialChecksum()) {
+	const uint64_t fnvPrime = (static_cast<uint64_t>(1) << 40) | 0x1B3;
+	size_t pos = 0;
+	for (; pos + sizeof(uint64_t) <= length; pos += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + pos, sizeof(uint64_t));
+		checksum = (checksum ^ word) * fnvPrime;
+	}
+	for (; pos < length; pos++) {
+		checksum = (checksum ^ static_cast<unsigned char>(data[pos])) * fnvPrime;
+	}
+	return checksum;
+}
+
+} }
+
+#endif
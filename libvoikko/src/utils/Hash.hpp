@@ -0,0 +1,194 @@
+/* The contents of this file are subject to the Mozilla Public License Version 
+ * 1.1 (the "License"); you may not use this file except in compliance with 
+ * the License. You may obtain a copy of the License at 
+ * http://www.mozilla.org/MPL/
+ * 
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ * 
+ * The Original Code is Libvoikko: Library of natural language processing tools.
+ * The Initial Developer of the Original Code is Harri Pitkänen <hatapitk@iki.fi>.
+ * Portions created by the Initial Developer are Copyright (C) 2026
+ * the Initial Developer. All Rights Reserved.
+ * 
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *********************************************************************************/
+
+#ifndef VOIKKO_UTILS_HASH
+#define VOIKKO_UTILS_HASH
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace libvoikko { namespace utils {
+
+/**
+ * Initial value of 32 bit FNV-1a hash.
+ */
+const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+
+/**
+ * Adds one character or code unit to a 32 bit FNV-1a hash.
+ */
+inline uint32_t fnvAdd(uint32_t hash, uint32_t c) {
+	return (hash ^ c) * 16777619u;
+}
+
+inline uint32_t fnvUnit(char c) {
+	return static_cast<unsigned char>(c);
+}
+
+inline uint32_t fnvUnit(wchar_t c) {
+	return static_cast<uint32_t>(c);
+}
+
+inline uint32_t fnvUnit(uint16_t c) {
+	return c;
+}
+
+/**
+ * Computes 32 bit FNV-1a hash of a string of given length. Characters of
+ * type char are hashed as unsigned bytes.
+ * @param hash hash of the preceding characters
+ */
+template <typename CharT>
+inline uint32_t fnvHash(const CharT * str, size_t len, uint32_t hash = FNV_OFFSET_BASIS) {
+	for (size_t i = 0; i < len; i++) {
+		hash = fnvAdd(hash, fnvUnit(str[i]));
+	}
+	return hash;
+}
+
+/**
+ * Computes 32 bit FNV-1a hash of a null terminated string.
+ */
+template <typename CharT>
+inline uint32_t fnvHash(const CharT * str) {
+	uint32_t hash = FNV_OFFSET_BASIS;
+	for (; *str; str++) {
+		hash = fnvAdd(hash, fnvUnit(*str));
+	}
+	return hash;
+}
+
+/**
+ * Open addressing hash table of indexes to items that are stored elsewhere,
+ * usually in a vector in the order they were added. The table does not know
+ * the items: the caller gives the hash and a function object that tells
+ * whether the item at given index is the one being looked for. The table
+ * is allocated on first insertion and doubled when it becomes half full.
+ */
+class IndexTable {
+	public:
+		/** Returned by find when there is no matching item */
+		static const size_t NOT_FOUND = static_cast<size_t>(-1);
+		
+		/**
+		 * @param expectedCount number of items that can be added without growing the table
+		 */
+		explicit IndexTable(size_t expectedCount = 0) :
+			slots(),
+			count(0),
+			initialSize(16) {
+			while (initialSize < expectedCount * 2) {
+				initialSize <<= 1;
+			}
+		}
+		
+		/**
+		 * Returns the index of the item with given hash for which equals(index)
+		 * returns true, or NOT_FOUND.
+		 */
+		template <typename Equals>
+		size_t find(uint32_t hash, Equals equals) const {
+			if (slots.empty()) {
+				return NOT_FOUND;
+			}
+			const size_t mask = slots.size() - 1;
+			for (size_t slot = hash & mask; slots[slot].index != NOT_FOUND; slot = (slot + 1) & mask) {
+				if (slots[slot].hash == hash && equals(slots[slot].index)) {
+					return slots[slot].index;
+				}
+			}
+			return NOT_FOUND;
+		}
+		
+		/**
+		 * Returns the index of the item with given hash for which equals(index)
+		 * returns true. If there is no such item, newIndex is added to the
+		 * table and returned.
+		 */
+		template <typename Equals>
+		size_t findOrInsert(uint32_t hash, size_t newIndex, Equals equals) {
+			if ((count + 1) * 2 > slots.size()) {
+				grow();
+			}
+			const size_t mask = slots.size() - 1;
+			size_t slot = hash & mask;
+			for (; slots[slot].index != NOT_FOUND; slot = (slot + 1) & mask) {
+				if (slots[slot].hash == hash && equals(slots[slot].index)) {
+					return slots[slot].index;
+				}
+			}
+			slots[slot].hash = hash;
+			slots[slot].index = newIndex;
+			count++;
+			return newIndex;
+		}
+		
+		/** Returns the number of indexes in the table. */
+		size_t size() const {
+			return count;
+		}
+		
+		/** Removes all indexes but keeps the memory allocated for them. */
+		void clear() {
+			Slot empty = { 0, NOT_FOUND };
+			slots.assign(slots.size(), empty);
+			count = 0;
+		}
+	
+	private:
+		struct Slot {
+			uint32_t hash;
+			size_t index;
+		};
+		
+		void grow() {
+			std::vector<Slot> oldSlots;
+			oldSlots.swap(slots);
+			Slot empty = { 0, NOT_FOUND };
+			slots.assign(oldSlots.empty() ? initialSize : oldSlots.size() * 2, empty);
+			const size_t mask = slots.size() - 1;
+			for (size_t i = 0; i < oldSlots.size(); i++) {
+				if (oldSlots[i].index != NOT_FOUND) {
+					size_t slot = oldSlots[i].hash & mask;
+					while (slots[slot].index != NOT_FOUND) {
+						slot = (slot + 1) & mask;
+					}
+					slots[slot] = oldSlots[i];
+				}
+			}
+		}
+		
+		std::vector<Slot> slots;
+		size_t count;
+		size_t initialSize;
+};
+
+} }
+
+#endif
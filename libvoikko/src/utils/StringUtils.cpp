@@ -58,6 +58,25 @@ wchar_t * StringUtils::ucs4FromUtf8(const char * const original, size_t byteCoun
 	}
 }
 
+size_t StringUtils::ucs4FromUtf8(const char * const original, size_t byteCount, wchar_t * target, size_t bufferLength) {
+	try {
+		const char * origPtr = original;
+		const char * const origEnd = original + byteCount;
+		size_t chars = 0;
+		while (origPtr < origEnd) {
+			if (chars + 1 >= bufferLength) {
+				return bufferLength + 1;
+			}
+			target[chars++] = utf8::next(origPtr, origEnd);
+		}
+		target[chars] = L'\0';
+		return chars;
+	} catch (...) {
+		// invalid UTF-8 sequence
+		return bufferLength + 1;
+	}
+}
+
 char * StringUtils::utf8FromUcs4(const wchar_t * const original) {
 	return utf8FromUcs4(original, wcslen(original));
 }
@@ -190,6 +209,32 @@ wchar_t * StringUtils::stripSpecialCharsForMalaga(wchar_t * & original, size_t o
 	return wordBuffer;
 }
 
+bool StringUtils::isSorted(const char * const * strings, size_t count) {
+	const char * previous = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (strings[i]) {
+			if (previous && strcmp(previous, strings[i]) > 0) {
+				return false;
+			}
+			previous = strings[i];
+		}
+	}
+	return true;
+}
+
+bool StringUtils::isSorted(const wchar_t * const * strings, size_t count) {
+	const wchar_t * previous = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (strings[i]) {
+			if (previous && wcscmp(previous, strings[i]) > 0) {
+				return false;
+			}
+			previous = strings[i];
+		}
+	}
+	return true;
+}
+
 bool StringUtils::isInteger(const wchar_t * word) {
 	for (size_t i = 0; word[i] != L'\0'; i++) {
 		if (word[i] < 0x30 || word[i] > 0x39) {
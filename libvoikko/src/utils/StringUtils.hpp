@@ -45,6 +45,14 @@ class StringUtils {
 	static wchar_t * ucs4FromUtf8(const char * const original);
 	static wchar_t * ucs4FromUtf8(const char * const original, size_t byteCount);
 	
+	/**
+	 * Converts UTF-8 string to UCS4, writing results to an existing
+	 * buffer. The result will be null terminated.
+	 * @return number of characters written to target buffer. If buffer was
+	 *         too short or input is not valid UTF-8 returns bufferLength + 1
+	 */
+	static size_t ucs4FromUtf8(const char * const original, size_t byteCount, wchar_t * target, size_t bufferLength);
+	
 	/**
 	 * Creates an UTF-8 string from a null terminated UCS4 string.
 	 * Returns a null pointer if memory allocation fails or input
@@ -94,6 +102,13 @@ class StringUtils {
 	 */
 	static wchar_t * stripSpecialCharsForMalaga(wchar_t * & original, size_t origLength);
 	
+	/**
+	 * Checks if the non-null strings in given array are in ascending order
+	 * of code points.
+	 */
+	static bool isSorted(const char * const * strings, size_t count);
+	static bool isSorted(const wchar_t * const * strings, size_t count);
+	
 	/**
 	 * Checks if given null terminated string is a positive integer.
 	 */
@@ -36,6 +36,23 @@
  * voikkoTerminate(handle);
  *
  * A single handle should not be used simultaneously from multiple threads.
+ * Multithreaded applications that use a dictionary with VFST backends may
+ * load the dictionary once with voikkoInitShared and create a separate
+ * session for each thread:
+ *
+ * VoikkoSharedHandle * shared = voikkoInitShared(&voikko_error, "fi_FI", 0);
+ * // in each thread
+ * VoikkoHandle * session = voikkoCreateSession(shared, &voikko_error);
+ * // set options and use the session as any other handle
+ * voikkoTerminate(session);
+ * // after all sessions have been created
+ * voikkoTerminateShared(shared);
+ *
+ * Sessions share only the read only VFST transducers. Other dictionaries
+ * (Malaga, HFST, lttoolbox or VISL CG-3 backends) cannot be shared and
+ * applications using them from multiple threads must create a handle for
+ * each thread with voikkoInit. Those backends have not been verified to be
+ * safe to use from multiple threads even through separate handles.
  *
  * Currently Finnish is the only supported language.
  *
@@ -76,6 +93,40 @@ struct VoikkoHandle * voikkoInit(const char ** error, const char * langcode,
  */
 void voikkoTerminate(struct VoikkoHandle * handle);
 
+/** Dictionary that may be shared by several sessions */
+struct VoikkoSharedHandle;
+
+/**
+ * Loads a dictionary that can be used from multiple threads through sessions
+ * created with voikkoCreateSession. The parameters are the same as for voikkoInit.
+ * Only dictionaries whose morphology, speller, suggestion, hyphenator and
+ * grammar checker backends are VFST based (or null) can be loaded this way.
+ * @return A handle to the loaded dictionary or null, if initialization failed
+ *         or the dictionary cannot be shared.
+ */
+struct VoikkoSharedHandle * voikkoInitShared(const char ** error, const char * langcode,
+                                             const char * path);
+
+/**
+ * Creates a new session for a shared dictionary. The session is an ordinary
+ * handle with default options that must be terminated with voikkoTerminate.
+ * Sessions share the read only transducer data of the dictionary but have
+ * their own options, caches and working memory, so different sessions may be
+ * used simultaneously from different threads. This function may itself be
+ * called from any thread as long as the shared handle has not been terminated.
+ * @param shared handle returned from voikkoInitShared
+ * @param error Will be set to null if the session was created without error.
+ *        Otherwise will be set to a pointer to a string describing the error.
+ * @return A new session or null, if initialization failed.
+ */
+struct VoikkoHandle * voikkoCreateSession(struct VoikkoSharedHandle * shared, const char ** error);
+
+/**
+ * Releases a dictionary loaded with voikkoInitShared. Sessions that have already
+ * been created remain usable until they are terminated.
+ */
+void voikkoTerminateShared(struct VoikkoSharedHandle * shared);
+
 /**
  * Sets a boolean option.
  * @param handle voikko instance
@@ -110,6 +161,202 @@ int voikkoSpellCstr(struct VoikkoHandle * handle, const char * word);
  */
 int voikkoSpellUcs4(struct VoikkoHandle * handle, const wchar_t * word);
 
+/**
+ * Checks the spelling of an array of UTF-8 character strings. This gives the
+ * same results as calling voikkoSpellCstr for each word but repeated words
+ * within the batch are checked only once.
+ * @param handle voikko instance
+ * @param words words to check
+ * @param wordCount number of words in the array
+ * @param results (out) array of at least wordCount elements where the spell
+ *        checker return code for each word is stored
+ */
+void voikkoSpellBatchCstr(struct VoikkoHandle * handle, const char * const * words,
+                          size_t wordCount, int * results);
+
+/**
+ * Checks the spelling of an array of wide character Unicode strings. This gives
+ * the same results as calling voikkoSpellUcs4 for each word but repeated words
+ * within the batch are checked only once.
+ * @param handle voikko instance
+ * @param words words to check
+ * @param wordCount number of words in the array
+ * @param results (out) array of at least wordCount elements where the spell
+ *        checker return code for each word is stored
+ */
+void voikkoSpellBatchUcs4(struct VoikkoHandle * handle, const wchar_t * const * words,
+                          size_t wordCount, int * results);
+
+/**
+ * Checks the spelling of all words in a wide character Unicode text. The text
+ * is split into tokens like with voikkoNextTokenUcs4 and each word token is
+ * checked like with voikkoSpellUcs4. Repeated words within the text are
+ * checked only once.
+ * @param handle voikko instance
+ * @param text text to check
+ * @param textlen number of characters in the text
+ * @param errorCount (out) number of misspelled words found
+ * @return array of errorCount misspelled words in the order they appear in
+ *         the text. Use voikkoFreeSpellingErrors to free the array after use.
+ */
+struct VoikkoSpellingError * voikkoCheckTextUcs4(struct VoikkoHandle * handle, const wchar_t * text,
+                                                 size_t textlen, size_t * errorCount);
+
+/**
+ * Checks the spelling of all words in a UTF-8 encoded text. The text is
+ * converted only once and checked like with voikkoCheckTextUcs4.
+ * @param handle voikko instance
+ * @param text text to check
+ * @param textlen number of bytes in the text
+ * @param errorCount (out) number of misspelled words found
+ * @return array of errorCount misspelled words in the order they appear in
+ *         the text, or null pointer if the text is not valid UTF-8. Positions
+ *         and lengths of the words are given in characters, not bytes. Use
+ *         voikkoFreeSpellingErrors to free the array after use.
+ */
+struct VoikkoSpellingError * voikkoCheckTextCstr(struct VoikkoHandle * handle, const char * text,
+                                                 size_t textlen, size_t * errorCount);
+
+/**
+ * Frees the memory allocated for misspelled words by voikkoCheckTextUcs4 or
+ * voikkoCheckTextCstr.
+ * @param errors array of misspelled words
+ */
+void voikkoFreeSpellingErrors(struct VoikkoSpellingError * errors);
+
+/**
+ * A word that is being typed in an editor. Results for the word are kept for
+ * each of its prefixes, so checking the word again after characters have been
+ * removed from its end costs nothing.
+ */
+struct VoikkoIncrementalSpeller;
+
+/**
+ * Creates an empty incremental speller. Changes to the spelling options of the
+ * handle are taken into account, but the handle must not be terminated before
+ * the incremental speller is deleted.
+ * @param handle voikko instance
+ * @return new incremental speller that must be deleted with voikkoDeleteIncrementalSpeller
+ */
+struct VoikkoIncrementalSpeller * voikkoCreateIncrementalSpeller(struct VoikkoHandle * handle);
+
+/**
+ * Deletes an incremental speller.
+ */
+void voikkoDeleteIncrementalSpeller(struct VoikkoIncrementalSpeller * speller);
+
+/**
+ * Appends UTF-8 encoded characters to the end of the word.
+ * @return true if the characters were appended, false if the word would
+ *         become too long or the characters could not be decoded
+ */
+int voikkoIncrementalAppendCstr(struct VoikkoIncrementalSpeller * speller, const char * chars);
+
+/**
+ * Appends wide characters to the end of the word.
+ * @return true if the characters were appended, false if the word would
+ *         become too long
+ */
+int voikkoIncrementalAppendUcs4(struct VoikkoIncrementalSpeller * speller, const wchar_t * chars);
+
+/**
+ * Removes characters from the end of the word.
+ * @param count number of characters to remove. If the word is shorter, all
+ *        characters are removed.
+ */
+void voikkoIncrementalRemove(struct VoikkoIncrementalSpeller * speller, size_t count);
+
+/**
+ * Checks the spelling of the current word. The result is the same as that
+ * of voikkoSpellUcs4.
+ * @return one of the spell checker return codes
+ */
+int voikkoIncrementalSpell(struct VoikkoIncrementalSpeller * speller);
+
+/**
+ * Checks whether the current word is a word or could still become one when
+ * more characters are appended. Dictionaries whose speller cannot list words
+ * accept every prefix.
+ * @return true if the word is correct or some correct word begins with it
+ */
+int voikkoIncrementalCanContinue(struct VoikkoIncrementalSpeller * speller);
+
+/**
+ * Finds words that begin with the current word, most likely ones first.
+ * Spellers that use the morphological analyzer list shorter words first.
+ * @param maxCount maximum number of words to return
+ * @return null, if no words were found. Otherwise returns a pointer to a
+ *         null-terminated array of strings in UTF-8 encoding. Use
+ *         voikkoFreeCstrArray to free the array and strings after use.
+ */
+char ** voikkoIncrementalCompletionsCstr(struct VoikkoIncrementalSpeller * speller, size_t maxCount);
+
+/**
+ * Finds words that begin with the current word, most likely ones first.
+ * Spellers that use the morphological analyzer list shorter words first.
+ * @param maxCount maximum number of words to return
+ * @return null, if no words were found. Otherwise returns a pointer to a
+ *         null-terminated array of wide character strings. Use
+ *         voikko_free_suggest_ucs4 to free the array and strings after use.
+ */
+wchar_t ** voikkoIncrementalCompletionsUcs4(struct VoikkoIncrementalSpeller * speller, size_t maxCount);
+
+/**
+ * Returns statistics of the spell checker cache. The counters are reset
+ * when the cache size is changed.
+ * @param handle voikko instance
+ * @param hits (out) number of words whose spelling result was found in the cache
+ * @param misses (out) number of words that had to be checked with the speller
+ */
+void voikkoGetSpellerCacheStatistics(struct VoikkoHandle * handle, size_t * hits, size_t * misses);
+
+/**
+ * Saves the spelling results in the spell checker cache to a file. A process
+ * that uses the same dictionary can load the file with voikkoLoadCacheSnapshot
+ * to start with a warm cache. The file is in the byte order of the host.
+ * @param handle voikko instance
+ * @param fileName name of the file to write
+ * @return true if the snapshot was saved, false if writing failed, the
+ *         cache is disabled or the dictionary does not use VFST transducers
+ */
+int voikkoSaveCacheSnapshot(struct VoikkoHandle * handle, const char * fileName);
+
+/**
+ * Adds the spelling results saved with voikkoSaveCacheSnapshot to the spell
+ * checker cache. The snapshot is rejected if it was saved with a different
+ * dictionary or dictionary version, or with different values of the options
+ * that affect the cached results (VOIKKO_OPT_ACCEPT_EXTRA_HYPHENS and
+ * VOIKKO_OPT_ACCEPT_MISSING_HYPHENS). The version of the dictionary is
+ * identified by the path, size and modification time of its transducer
+ * files, so snapshots cannot be used with dictionaries that do not use VFST
+ * transducers. If the cache is smaller than the one that was saved, some of
+ * the results are not kept.
+ * @param handle voikko instance
+ * @param fileName name of the file to read
+ * @return true if the snapshot was loaded, false if it could not be read or
+ *         was rejected, or if the cache is disabled or the dictionary does
+ *         not use VFST transducers
+ */
+int voikkoLoadCacheSnapshot(struct VoikkoHandle * handle, const char * fileName);
+
+/**
+ * Returns the memory usage of a transducer file loaded in this process. The
+ * transducers are shared by all handles, so the handle does not limit the
+ * transducers that are reported. Iterate the index from 0 until this function
+ * returns false to see all transducers.
+ * @param handle voikko instance
+ * @param index index of the transducer, starting from 0
+ * @param fileName (out) buffer where the path of the transducer file is stored,
+ *        may be null. The path is truncated if it does not fit.
+ * @param fileNameSize size of the fileName buffer
+ * @param mappedBytes (out) size of the transducer in memory
+ * @param residentBytes (out) number of bytes of the transducer that are
+ *        currently resident in memory, 0 if this cannot be determined
+ * @return true if there is a transducer with given index, otherwise false
+ */
+int voikkoGetTransducerMemoryUsage(struct VoikkoHandle * handle, size_t index, char * fileName,
+                                   size_t fileNameSize, size_t * mappedBytes, size_t * residentBytes);
+
 /**
  * Finds suggested correct spellings for given UTF-8 encoded word.
  * @param handle voikko instance
@@ -414,6 +661,60 @@ struct voikko_mor_analysis ** voikkoAnalyzeWordUcs4(
 struct voikko_mor_analysis ** voikkoAnalyzeWordCstr(
                               struct VoikkoHandle * handle, const char * word);
 
+/**
+ * Analyzes the morphology of given word, including only the requested
+ * attributes in the results. Attributes that are not requested are not
+ * computed, which makes the analysis faster when only a few of them are
+ * needed, for example when only the base form is wanted.
+ * @param handle voikko instance
+ * @param word word to be analyzed.
+ * @param attributes combination of VOIKKO_ATTRIBUTE_* flags
+ * @return A pointer to a null terminated array of analysis results.
+ */
+struct voikko_mor_analysis ** voikkoAnalyzeWordMaskUcs4(
+                              struct VoikkoHandle * handle, const wchar_t * word, int attributes);
+
+/**
+ * Analyzes the morphology of given word, including only the requested
+ * attributes in the results. See voikkoAnalyzeWordMaskUcs4.
+ * @param handle voikko instance
+ * @param word word to be analyzed.
+ * @param attributes combination of VOIKKO_ATTRIBUTE_* flags
+ * @return A pointer to a null terminated array of analysis results.
+ */
+struct voikko_mor_analysis ** voikkoAnalyzeWordMaskCstr(
+                              struct VoikkoHandle * handle, const char * word, int attributes);
+
+/**
+ * Analyzes the morphology of an array of wide character Unicode strings. This
+ * gives the same results as calling voikkoAnalyzeWordUcs4 for each word. If
+ * the words are sorted, lookups continue from the prefix shared with the
+ * previous word, which is faster.
+ * @param handle voikko instance
+ * @param words words to analyze
+ * @param wordCount number of words in the array
+ * @param results (out) array of at least wordCount elements where the analysis
+ *        results of each word are stored. Each element must be freed with
+ *        voikko_free_mor_analysis.
+ */
+void voikkoAnalyzeWordBatchUcs4(struct VoikkoHandle * handle, const wchar_t * const * words,
+                                size_t wordCount, struct voikko_mor_analysis *** results);
+
+/**
+ * Analyzes the morphology of an array of UTF-8 character strings. This gives
+ * the same results as calling voikkoAnalyzeWordCstr for each word. If the
+ * words are sorted, lookups continue from the prefix shared with the previous
+ * word, which is faster.
+ * @param handle voikko instance
+ * @param words words to analyze
+ * @param wordCount number of words in the array
+ * @param results (out) array of at least wordCount elements where the analysis
+ *        results of each word are stored. Each element must be freed with
+ *        voikko_free_mor_analysis.
+ */
+void voikkoAnalyzeWordBatchCstr(struct VoikkoHandle * handle, const char * const * words,
+                                size_t wordCount, struct voikko_mor_analysis *** results);
+
 /**
  * Free the memory allocated for morphology analysis results.
  * @param analysis A list of analysis results obtained with voikko_mor_analysis.
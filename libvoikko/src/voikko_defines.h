@@ -142,4 +142,54 @@
  * Default: 0*/
 #define VOIKKO_SPELLER_CACHE_SIZE 17
 
+/* Size of the spell checker cache in bytes. 0 disables the cache. This is an
+ * alternative to VOIKKO_SPELLER_CACHE_SIZE for finer control over memory use.
+ */
+#define VOIKKO_SPELLER_CACHE_BYTES 18
+
+/* Memory residency of the transducer files (VFST dictionaries) loaded in the
+ * process. Value is a combination of the VOIKKO_RESIDENCY_* flags below. Since
+ * the transducers are shared by all handles, this affects every handle and is
+ * also applied to transducers loaded later. The option fails if some of the
+ * operations failed, for example because of the limit of locked memory.
+ * Default: 0 */
+#define VOIKKO_TRANSDUCER_RESIDENCY 19
+
+/* Start reading the transducers into memory in the background */
+#define VOIKKO_RESIDENCY_WILLNEED 1
+/* Read every page of the transducers into memory before returning */
+#define VOIKKO_RESIDENCY_PREFAULT 2
+/* Do not read ahead when a page is missing. Useful when the transducers do not fit in memory. */
+#define VOIKKO_RESIDENCY_RANDOM 4
+/* Ask the operating system to use huge pages if it can */
+#define VOIKKO_RESIDENCY_HUGEPAGE 8
+/* Lock the transducers in memory */
+#define VOIKKO_RESIDENCY_LOCK 16
+
+/* Attributes of morphological analysis (see voikkoAnalyzeWordMaskUcs4). The
+ * value of each flag corresponds to the analysis key of the same name. */
+#define VOIKKO_ATTRIBUTE_BASEFORM 0x1
+#define VOIKKO_ATTRIBUTE_CLASS 0x2
+#define VOIKKO_ATTRIBUTE_COMPARISON 0x4
+#define VOIKKO_ATTRIBUTE_FOCUS 0x8
+#define VOIKKO_ATTRIBUTE_FSTOUTPUT 0x10
+#define VOIKKO_ATTRIBUTE_KYSYMYSLIITE 0x20
+#define VOIKKO_ATTRIBUTE_MALAGA_VAPAA_JALKIOSA 0x40
+#define VOIKKO_ATTRIBUTE_MOOD 0x80
+#define VOIKKO_ATTRIBUTE_NEGATIVE 0x100
+#define VOIKKO_ATTRIBUTE_NUMBER 0x200
+#define VOIKKO_ATTRIBUTE_PARTICIPLE 0x400
+#define VOIKKO_ATTRIBUTE_PERSON 0x800
+#define VOIKKO_ATTRIBUTE_POSSESSIVE 0x1000
+#define VOIKKO_ATTRIBUTE_POSSIBLE_GEOGRAPHICAL_NAME 0x2000
+#define VOIKKO_ATTRIBUTE_REQUIRE_FOLLOWING_VERB 0x4000
+#define VOIKKO_ATTRIBUTE_SIJAMUOTO 0x8000
+#define VOIKKO_ATTRIBUTE_STRUCTURE 0x10000
+#define VOIKKO_ATTRIBUTE_TENSE 0x20000
+#define VOIKKO_ATTRIBUTE_WEIGHT 0x40000
+#define VOIKKO_ATTRIBUTE_WORDBASES 0x80000
+#define VOIKKO_ATTRIBUTE_WORDIDS 0x100000
+/* All attributes. Same as calling voikkoAnalyzeWordUcs4. */
+#define VOIKKO_ATTRIBUTE_ALL 0x1FFFFF
+
 #endif
@@ -56,6 +56,18 @@ typedef struct {
 	char ** suggestions;
 } voikko_grammar_error;
 
+/**
+ * Misspelled word found by voikkoCheckTextUcs4 or voikkoCheckTextCstr.
+ */
+typedef struct VoikkoSpellingError {
+	/** Start position of the word in the text (in characters) */
+	size_t startpos;
+	/** Length of the word (in characters) */
+	size_t wordlen;
+	/** Spell checker return code for the word */
+	int result;
+} VoikkoSpellingError;
+
 END_C_DECLS
 
 #endif
@@ -32,9 +32,10 @@ sys.path.insert(0, PYTHON_MODULE_DIR)
 # Import tests
 from NullComponentTest import NullComponentTest
 from DictionaryInfoTest import DictionaryInfoTest
+from VfstTest import VfstTest
 
 # Run all test suites
-testCaseClasses = [NullComponentTest, DictionaryInfoTest]
+testCaseClasses = [NullComponentTest, DictionaryInfoTest, VfstTest]
 testCases = [unittest.TestLoader().loadTestsFromTestCase(caseClass) for caseClass in testCaseClasses]
 testSuite = unittest.TestSuite(testCases)
 result = unittest.TextTestRunner(verbosity=1).run(testSuite)
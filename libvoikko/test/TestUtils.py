@@ -20,6 +20,8 @@
 import tempfile
 import os
 import codecs
+import shutil
+import subprocess
 from ctypes import CDLL
 from ctypes import POINTER
 from ctypes import c_char_p
@@ -85,6 +87,48 @@ class TestDataDir:
 	def getDirectory(self):
 		return self.tempDir
 
+VFST_COMPILER = os.path.join("..", "src", "tools", "voikkovfstc")
+
+def hasVfstCompiler():
+	"""Returns true if voikkovfstc has been built (it needs --enable-buildtools)."""
+	return os.path.isfile(VFST_COMPILER)
+
+def compileVfst(attLines, outputFile, options = []):
+	"""Compiles transducer given as lines in AT&T text format with voikkovfstc
+	and returns the exit status of the compiler."""
+	process = subprocess.Popen([VFST_COMPILER, "-o", outputFile] + options,
+	          stdin = subprocess.PIPE, stdout = subprocess.PIPE, stderr = subprocess.PIPE)
+	process.communicate((u"\n".join(attLines) + u"\n").encode("UTF-8"))
+	return process.returncode
+
+class VfstDataDir:
+	"""Temporary directory for dictionaries in format 5 (VFST dictionaries)."""
+	def __init__(self):
+		self.tempDir = tempfile.mkdtemp()
+		self.versionedDir = self.tempDir + os.sep + "5"
+		os.mkdir(self.versionedDir)
+	
+	def tearDown(self):
+		shutil.rmtree(self.tempDir)
+	
+	def createDictionary(self, variant, backends):
+		"""Creates dictionary with language tag fi-x-<variant> and given
+		(key, value) pairs in index.txt. Returns the directory where the
+		transducer files of the dictionary should be written."""
+		subdirPath = self.versionedDir + os.sep + "mor-" + variant
+		os.mkdir(subdirPath)
+		fileHandle = codecs.open(subdirPath + os.sep + "index.txt", "w", "UTF-8")
+		fileHandle.write(u"Voikko-Dictionary-Format: 5\n")
+		fileHandle.write(u"Language: fi-x-" + variant + u"\n")
+		fileHandle.write(u"Description: " + variant + u"\n")
+		for key, value in backends:
+			fileHandle.write(key + u": " + value + u"\n")
+		fileHandle.close()
+		return subdirPath
+	
+	def getDirectory(self):
+		return self.tempDir
+
 def getVoikkoCLibrary():
 	library = None
 	if os.name == 'nt':
@@ -0,0 +1,491 @@
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 agent (agent@local)
+# Test suite for VFST transducer lookups. The transducers are compiled
+# from small lexicons with voikkovfstc when the tests are run.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import math
+import os
+import unittest
+import libvoikko
+from TestUtils import VfstDataDir, hasVfstCompiler, compileVfst
+
+LETTERS = u"abdefghijklmnoprstuvyäö"
+
+# 300 words of three letters. Each word has its own path from the state
+# after [Ln], so that state has far more transitions than a state needs to
+# be indexed and many of them have the same input symbol.
+WORDS = [LETTERS[i % 23] + LETTERS[(i // 23) % 23] + LETTERS[(i * 7) % 23] for i in range(300)]
+
+class AttBuilder:
+	def __init__(self):
+		self.transitions = []
+		self.finals = []
+		self.stateCount = 1
+	
+	def newState(self):
+		self.stateCount = self.stateCount + 1
+		return self.stateCount - 1
+	
+	def add(self, source, target, symIn, symOut, weight = None):
+		line = u"%i\t%i\t%s\t%s" % (source, target, symIn, symOut)
+		if weight is not None:
+			line = line + u"\t%s" % weight
+		self.transitions.append((source, line))
+	
+	def addPath(self, source, target, pairs, weight = None):
+		"""Adds a path of (input, output) symbol pairs. The weight is put on the
+		first transition and the rest get weight 0."""
+		for i in range(len(pairs)):
+			nextState = target if i == len(pairs) - 1 else self.newState()
+			self.add(source, nextState, pairs[i][0], pairs[i][1], weight if i == 0 or weight is None else u"0")
+			source = nextState
+	
+	def addFinal(self, state, weight = None):
+		self.finals.append((state, u"%i" % state if weight is None else u"%i\t%s" % (state, weight)))
+	
+	def lines(self):
+		lines = sorted(self.transitions + self.finals, key = lambda t: t[0])
+		return [line for (state, line) in lines]
+
+def identityPairs(word):
+	return [(c, c) for c in word]
+
+def finnishLexicon(weight = None):
+	"""Lexicon in the format used by the finnishVfst morphology. If weight is
+	given, all transitions and final states get that weight."""
+	att = AttBuilder()
+	words = att.newState()
+	final = att.newState()
+	att.add(0, words, u"@0@", u"[Ln]", weight)
+	att.addFinal(final, weight)
+	wordEnd = att.newState()
+	att.addPath(wordEnd, final, [(u"@0@", u"[Sn]"), (u"@0@", u"[Ny]")], weight)
+	for word in WORDS:
+		att.addPath(words, wordEnd, identityPairs(word), weight)
+	# Flag diacritics: "kissa" is accepted but "koira" is not
+	flagEnd = att.newState()
+	att.addPath(words, flagEnd, [(u"@P.X.A@", u"@P.X.A@")] + identityPairs(u"kissa"), weight)
+	att.addPath(words, flagEnd, [(u"@P.X.B@", u"@P.X.B@")] + identityPairs(u"koira"), weight)
+	att.add(flagEnd, wordEnd, u"@R.X.A@", u"@R.X.A@", weight)
+	return att.lines()
+
+def epsilonLexicon(weight = None):
+	"""Lexicon in the format used by the finnishVfst morphology where words are
+	reached through chains of epsilon and flag diacritic transitions. Some of
+	the chains lead to states that come earlier in the transducer."""
+	att = AttBuilder()
+	words = att.newState()
+	final = att.newState()
+	att.add(0, words, u"@0@", u"[Ln]", weight)
+	att.addFinal(final, weight)
+	wordEnd = att.newState()
+	att.addPath(wordEnd, final, [(u"@0@", u"[Sn]"), (u"@0@", u"[Ny]")], weight)
+	talo = att.newState()
+	att.addPath(words, talo, [(u"@0@", u"@0@")] * 3, weight)
+	att.addPath(talo, wordEnd, identityPairs(u"talo"), weight)
+	ruki = att.newState()
+	chainEnd = att.newState()
+	chainStart = att.newState()
+	att.add(words, chainStart, u"@0@", u"@0@", weight)
+	att.add(chainStart, chainEnd, u"@0@", u"@0@", weight)
+	att.add(chainEnd, ruki, u"@0@", u"@0@", weight)
+	att.addPath(ruki, wordEnd, identityPairs(u"ruki"), weight)
+	flagEnd = att.newState()
+	att.addPath(words, flagEnd, [(u"@P.X.A@", u"@P.X.A@"), (u"@0@", u"@0@")] + identityPairs(u"sika"), weight)
+	att.addPath(words, flagEnd, [(u"@P.X.B@", u"@P.X.B@"), (u"@0@", u"@0@")] + identityPairs(u"sotka"), weight)
+	att.add(flagEnd, wordEnd, u"@R.X.A@", u"@R.X.A@", weight)
+	return att.lines()
+
+def weightedLexicon():
+	"""Weighted lexicon for the vfst backends. Weights are given in the log
+	format of voikkovfstc. "kalja" has two paths and the lighter one counts."""
+	att = AttBuilder()
+	final = att.newState()
+	att.addFinal(final, u"0")
+	for word, weight in [(u"kala", u"0.5"), (u"kalat", u"0.25"), (u"kalaa", u"0.75"), (u"kalle", u"0.125"),
+	                     (u"kallo", u"1"), (u"kalja", u"2"), (u"kalja", u"0.375")]:
+		att.addPath(0, final, identityPairs(word), weight)
+	return att.lines()
+
+def prefixTreeLexicon():
+	"""Weighted lexicon where words share prefixes and the weights are on
+	different transitions and final states. The total weights are kalat 0.15,
+	kassi 0.3, karhu 0.7 and kala 1, so the lightest word continues past the
+	heaviest one."""
+	att = AttBuilder()
+	ka = att.newState()
+	att.addPath(0, ka, identityPairs(u"ka"), u"0.1")
+	kala = att.newState()
+	att.addPath(ka, kala, identityPairs(u"la"), u"0")
+	att.addFinal(kala, u"0.9")
+	kalat = att.newState()
+	att.add(kala, kalat, u"t", u"t", u"0.05")
+	att.addFinal(kalat, u"0")
+	kassi = att.newState()
+	att.addPath(ka, kassi, identityPairs(u"ssi"), u"0.2")
+	att.addFinal(kassi, u"0")
+	karhu = att.newState()
+	att.addPath(ka, karhu, identityPairs(u"rhu"), u"0")
+	att.addFinal(karhu, u"0.6")
+	return att.lines()
+
+def errorModel(negativeWeight = False):
+	"""Weighted error model that allows one substitution (weight 1), insertion
+	or deletion (weight 2). With negativeWeight a transition with negative
+	weight is added for a symbol that is not in the lexicons."""
+	att = AttBuilder()
+	edited = att.newState()
+	att.addFinal(0, u"0")
+	att.addFinal(edited, u"0")
+	for c in LETTERS + u"x":
+		att.add(0, 0, c, c, u"0")
+		att.add(edited, edited, c, c, u"0")
+		att.add(0, edited, c, u"@0@", u"2")
+		att.add(0, edited, u"@0@", c, u"2")
+		for d in LETTERS:
+			if d != c:
+				att.add(0, edited, c, d, u"1")
+	if negativeWeight:
+		att.add(0, edited, u"q", u"q", u"-1")
+	return att.lines()
+
+def capitalisationLexicon():
+	"""Weighted lexicon with words that are written with upper case first letter
+	or with a trailing dot."""
+	att = AttBuilder()
+	final = att.newState()
+	att.addFinal(final, u"0")
+	for word in [u"kala", u"Pori", u"esim.", u"ma", u"Ma."]:
+		att.addPath(0, final, identityPairs(word), u"0")
+	return att.lines()
+
+def testWords():
+	"""Words of the lexicon, words that are not in it and words with symbols
+	that the transducers do not have."""
+	words = []
+	for word in WORDS:
+		words = words + [word, word[:2], word + u"a", word[0].upper() + word[1:]]
+	return words + [u"kissa", u"koira", u"kiss", u"xab", u"abx", u"ezö", u"c", u"€"]
+
+class VfstTest(unittest.TestCase):
+	def setUp(self):
+		if not hasVfstCompiler():
+			self.skipTest("voikkovfstc has not been built")
+		self.dataDir = VfstDataDir()
+	
+	def tearDown(self):
+		self.dataDir.tearDown()
+	
+	def __createFinnishDictionary(self, variant, compilerOptions = [], lexicon = None):
+		path = self.dataDir.createDictionary(variant,
+		       [(u"Morphology-Backend", u"finnishVfst"), (u"Grammar-Backend", u"null")])
+		morFile = path + os.sep + "mor.vfst"
+		self.assertEqual(0, compileVfst(finnishLexicon() if lexicon is None else lexicon, morFile, compilerOptions))
+		return morFile
+	
+	def __createWeightedDictionary(self, variant, lexicon, errorModel = None):
+		path = self.dataDir.createDictionary(variant,
+		       [(u"Morphology-Backend", u"vfst"), (u"Speller-Backend", u"vfst"),
+		        (u"Suggestion-Backend", u"null" if errorModel is None else u"vfst"), (u"Grammar-Backend", u"null")])
+		for fileName in ["mor.vfst", "spl.vfst"]:
+			self.assertEqual(0, compileVfst(lexicon, path + os.sep + fileName, ["-w", "log"]))
+		if errorModel is not None:
+			self.assertEqual(0, compileVfst(errorModel, path + os.sep + "err.vfst", ["-w", "log"]))
+		return libvoikko.Voikko(u"fi-x-" + variant, self.dataDir.getDirectory())
+	
+	def __completions(self, voikko, prefix, maxCount):
+		speller = voikko.incrementalSpeller()
+		speller.append(prefix)
+		completions = speller.completions(maxCount)
+		speller.terminate()
+		return completions
+	
+	def testCompletionsAreListedLightestFirst(self):
+		voikko = self.__createWeightedDictionary(u"weighted", weightedLexicon())
+		self.assertEqual([u"kalle", u"kalat", u"kalja", u"kala"], self.__completions(voikko, u"kal", 4))
+		self.assertEqual([u"kalle", u"kalat", u"kalja", u"kala", u"kalaa", u"kallo"],
+		                 self.__completions(voikko, u"kal", 10))
+		self.assertEqual([u"kalle"], self.__completions(voikko, u"kal", 1))
+		# The prefix itself is not a completion
+		self.assertEqual([u"kalat", u"kalaa"], self.__completions(voikko, u"kala", 5))
+		self.assertEqual([], self.__completions(voikko, u"kalx", 5))
+		voikko.terminate()
+	
+	def testAnalyzerBasedSpellerListsCompletions(self):
+		for variant, options in [(u"original", []), (u"compact", ["-c"])]:
+			self.__createFinnishDictionary(variant, options)
+			voikko = libvoikko.Voikko(u"fi-x-" + variant, self.dataDir.getDirectory())
+			# Shorter words come first
+			self.assertEqual([u"kit", u"kissa"], self.__completions(voikko, u"ki", 5))
+			self.assertEqual([u"Kissa"], self.__completions(voikko, u"Kis", 5))
+			# "koira" is in the lexicon but rejected by flag diacritics
+			self.assertEqual([], self.__completions(voikko, u"koi", 5))
+			words = sorted(set(word for word in WORDS if word.startswith(u"l")))
+			self.assertEqual(words, sorted(self.__completions(voikko, u"l", 100)))
+			for continuable, word in [(True, u"kis"), (True, u"kissa"), (False, u"koi"), (False, u"kissat")]:
+				speller = voikko.incrementalSpeller()
+				speller.append(word)
+				self.assertEqual(continuable, speller.canContinue())
+				speller.terminate()
+			voikko.terminate()
+	
+	def testCompletionsFollowPathWeights(self):
+		voikko = self.__createWeightedDictionary(u"tree", prefixTreeLexicon())
+		# Analysis weights are probabilities computed from the total weight of the path
+		for word, weight in [(u"kalat", 0.15), (u"kassi", 0.3), (u"karhu", 0.7), (u"kala", 1.0)]:
+			analyses = voikko.analyze(word)
+			self.assertEqual(1, len(analyses))
+			self.assertAlmostEqual(math.exp(-10.0 * weight), float(analyses[0]["WEIGHT"]), 6)
+		self.assertEqual([u"kalat", u"kassi", u"karhu", u"kala"], self.__completions(voikko, u"k", 10))
+		self.assertEqual([u"kalat", u"kassi"], self.__completions(voikko, u"ka", 2))
+		self.assertEqual([u"kalat", u"kala"], self.__completions(voikko, u"kal", 10))
+		voikko.terminate()
+	
+	def testSuggestionsAreListedLightestFirst(self):
+		composed = self.__createWeightedDictionary(u"composed", weightedLexicon(), errorModel())
+		self.assertEqual([u"kalat", u"kalaa", u"kala"], composed.suggest(u"kalax"))
+		self.assertEqual([u"kala", u"kallo"], composed.suggest(u"kalo"))
+		self.assertEqual([u"kalle"], composed.suggest(u"kalke"))
+		self.assertEqual([], composed.suggest(u"xyz"))
+		# Negative weights prevent composing the transducers. The results must be the same.
+		separate = self.__createWeightedDictionary(u"separate", weightedLexicon(), errorModel(True))
+		for word in [u"kalax", u"kalo", u"kalke", u"kaa", u"alja", u"xyz"]:
+			self.assertEqual(separate.suggest(word), composed.suggest(word))
+		composed.terminate()
+		separate.terminate()
+	
+	def testCapitalisationAndTrailingDotAreCheckedInOneTraversal(self):
+		voikko = self.__createWeightedDictionary(u"capital", capitalisationLexicon())
+		for cacheSize in [0, -1]:
+			voikko.setSpellerCacheSize(cacheSize)
+			voikko.setIgnoreDot(False)
+			voikko.setAcceptFirstUppercase(True)
+			self.assertTrue(voikko.spell(u"kala"))
+			self.assertTrue(voikko.spell(u"Kala"))
+			self.assertTrue(voikko.spell(u"Pori"))
+			self.assertFalse(voikko.spell(u"pori"))
+			self.assertFalse(voikko.spell(u"kala."))
+			self.assertTrue(voikko.spell(u"esim."))
+			self.assertFalse(voikko.spell(u"esim"))
+			voikko.setIgnoreDot(True)
+			self.assertTrue(voikko.spell(u"kala."))
+			self.assertTrue(voikko.spell(u"Pori."))
+			self.assertFalse(voikko.spell(u"pori."))
+			self.assertTrue(voikko.spell(u"esim."))
+			self.assertFalse(voikko.spell(u"kissa."))
+			voikko.setAcceptFirstUppercase(False)
+			# SPELL_OK for a word in lower case is not enough but SPELL_CAP_FIRST is
+			self.assertFalse(voikko.spell(u"Kala"))
+			self.assertFalse(voikko.spell(u"Kala."))
+			self.assertTrue(voikko.spell(u"Pori"))
+			self.assertTrue(voikko.spell(u"Pori."))
+			# "ma" is correct without the dot but only "Ma." accepts the upper case letter
+			self.assertFalse(voikko.spell(u"Ma"))
+			self.assertTrue(voikko.spell(u"Ma."))
+			self.assertTrue(voikko.spell(u"ma."))
+		voikko.terminate()
+	
+	def testCacheSnapshotIsTiedToTransducerFiles(self):
+		voikko = self.__createWeightedDictionary(u"snapshot", weightedLexicon())
+		voikko.setSpellerCacheBytes(10000)
+		self.assertTrue(voikko.spell(u"kala"))
+		self.assertFalse(voikko.spell(u"kalx"))
+		fileName = self.dataDir.getDirectory() + os.sep + "spell.cache"
+		voikko.saveCacheSnapshot(fileName)
+		restarted = libvoikko.Voikko(u"fi-x-snapshot", self.dataDir.getDirectory())
+		restarted.setSpellerCacheBytes(10000)
+		self.assertTrue(restarted.loadCacheSnapshot(fileName))
+		self.assertEqual((0, 0), restarted.getSpellerCacheStatistics())
+		self.assertTrue(restarted.spell(u"kala"))
+		self.assertEqual((1, 0), restarted.getSpellerCacheStatistics())
+		restarted.terminate()
+		# A replaced transducer file is a different version of the dictionary
+		splFile = os.path.join(self.dataDir.getDirectory(), "5", "mor-snapshot", "spl.vfst")
+		modified = os.path.getmtime(splFile) - 3600
+		os.utime(splFile, (modified, modified))
+		replaced = libvoikko.Voikko(u"fi-x-snapshot", self.dataDir.getDirectory())
+		self.assertFalse(replaced.loadCacheSnapshot(fileName))
+		replaced.terminate()
+		voikko.terminate()
+	
+	def testCacheSnapshotIsRefusedWithoutTransducerFiles(self):
+		self.dataDir.createDictionary(u"notransducers",
+		    [(u"Morphology-Backend", u"null"), (u"Speller-Backend", u"AllOk"),
+		     (u"Suggestion-Backend", u"null"), (u"Grammar-Backend", u"null")])
+		voikko = libvoikko.Voikko(u"fi-x-notransducers", self.dataDir.getDirectory())
+		self.assertTrue(voikko.spell(u"kala"))
+		fileName = self.dataDir.getDirectory() + os.sep + "spell.cache"
+		self.assertRaises(libvoikko.VoikkoException, voikko.saveCacheSnapshot, fileName)
+		self.assertFalse(os.path.exists(fileName))
+		open(fileName, "wb").close()
+		self.assertFalse(voikko.loadCacheSnapshot(fileName))
+		voikko.terminate()
+	
+	def testUnknownInputSymbolsAreRejected(self):
+		# None of these can be spelled with the input symbols of the transducers
+		unknownWords = [u"x", u"kalx", u"xkala", u"c", u"€", u"ka\U0001F431", u"[Ln]", u"@0@"]
+		self.__createFinnishDictionary(u"unweighted")
+		unweighted = libvoikko.Voikko(u"fi-x-unweighted", self.dataDir.getDirectory())
+		weighted = self.__createWeightedDictionary(u"weighted", weightedLexicon())
+		for word in unknownWords:
+			self.assertFalse(unweighted.spell(word))
+			self.assertEqual([], unweighted.analyze(word))
+			self.assertFalse(weighted.spell(word))
+			self.assertEqual([], weighted.analyze(word))
+		# Known symbols are still found after words with unknown symbols
+		self.assertTrue(unweighted.spell(WORDS[0]))
+		self.assertTrue(weighted.spell(u"kala"))
+		unweighted.terminate()
+		weighted.terminate()
+	
+	def testStateWithManyTransitionsIsSearchedCompletely(self):
+		# The state after [Ln] has enough transitions to be indexed, and
+		# transitions with the same input symbol lead to different words.
+		self.__createFinnishDictionary(u"unweighted")
+		unweighted = libvoikko.Voikko(u"fi-x-unweighted", self.dataDir.getDirectory())
+		weighted = self.__createWeightedDictionary(u"weighted", finnishLexicon(u"0"))
+		for voikko in [unweighted, weighted]:
+			for word in WORDS:
+				self.assertTrue(voikko.spell(word))
+				self.assertEqual(1, len(voikko.analyze(word)))
+				self.assertFalse(voikko.spell(word[:2]))
+				self.assertFalse(voikko.spell(word + u"a"))
+			self.assertTrue(voikko.spell(u"kissa"))
+			self.assertFalse(voikko.spell(u"koira"))
+		self.assertEqual(u"[Ln]" + WORDS[100] + u"[Sn][Ny]", weighted.analyze(WORDS[100])[0]["FSTOUTPUT"])
+		unweighted.terminate()
+		weighted.terminate()
+	
+	def testWordsAfterEpsilonTransitionsAreFound(self):
+		self.__createFinnishDictionary(u"unweighted", [], epsilonLexicon())
+		unweighted = libvoikko.Voikko(u"fi-x-unweighted", self.dataDir.getDirectory())
+		weighted = self.__createWeightedDictionary(u"weighted", epsilonLexicon(u"0"))
+		for voikko in [unweighted, weighted]:
+			for word in [u"talo", u"ruki", u"sika"]:
+				self.assertTrue(voikko.spell(word))
+				self.assertEqual(1, len(voikko.analyze(word)))
+				self.assertFalse(voikko.spell(word[:3]))
+				self.assertFalse(voikko.spell(word + u"a"))
+			self.assertFalse(voikko.spell(u"sotka"))
+			self.assertFalse(voikko.spell(u"kala"))
+		self.assertEqual(u"[Ln]ruki[Sn][Ny]", weighted.analyze(u"ruki")[0]["FSTOUTPUT"])
+		unweighted.terminate()
+		weighted.terminate()
+	
+	def testSharedDictionaryKeepsTransducersLoadedForSessions(self):
+		self.__createWeightedDictionary(u"shared", weightedLexicon(), errorModel()).terminate()
+		shared = libvoikko.Voikko.initShared(u"fi-x-shared", self.dataDir.getDirectory())
+		session = shared.createSession()
+		loaded = [os.path.basename(fileName) for (fileName, mapped, resident) in session.getTransducerMemoryUsage()]
+		self.assertEqual(1, loaded.count("mor.vfst"))
+		self.assertEqual(1, loaded.count("spl.vfst"))
+		self.assertEqual(1, loaded.count("err.vfst"))
+		shared.terminate()
+		self.assertTrue(session.spell(u"kala"))
+		self.assertEqual([u"kala", u"kallo"], session.suggest(u"kalo"))
+		session.terminate()
+	
+	def testDictionaryWithUnknownAdapterIsNotShared(self):
+		self.dataDir.createDictionary(u"adapter",
+		    [(u"Morphology-Backend", u"null"), (u"Speller-Backend", u"Unknown(currentAnalyzer)"),
+		     (u"Suggestion-Backend", u"null"), (u"Grammar-Backend", u"null")])
+		try:
+			libvoikko.Voikko.initShared(u"fi-x-adapter", self.dataDir.getDirectory())
+			self.fail("Dictionary with unknown backend was shared")
+		except libvoikko.VoikkoException as e:
+			self.assertTrue("only supported for dictionaries that use VFST backends" in str(e))
+	
+	def testCompactTransducerGivesSameResultsAsOriginal(self):
+		originalFile = self.__createFinnishDictionary(u"original")
+		compactFile = self.__createFinnishDictionary(u"compact", ["-c"])
+		self.assertTrue(os.path.getsize(compactFile) < os.path.getsize(originalFile))
+		original = libvoikko.Voikko(u"fi-x-original", self.dataDir.getDirectory())
+		compact = libvoikko.Voikko(u"fi-x-compact", self.dataDir.getDirectory())
+		for word in testWords():
+			self.assertEqual(original.spell(word), compact.spell(word))
+			self.assertEqual(original.analyze(word), compact.analyze(word))
+		for word in WORDS:
+			self.assertTrue(compact.spell(word))
+		self.assertTrue(compact.spell(u"kissa"))
+		self.assertFalse(compact.spell(u"koira"))
+		original.terminate()
+		compact.terminate()
+	
+	def testAllTransducerFormatsGiveSameSpellingResults(self):
+		words = testWords() + [u"talo", u"ruki", u"sika", u"sotka", u"tal", u"rukia"]
+		for name, lexicon in [(u"words", finnishLexicon), (u"epsilons", epsilonLexicon)]:
+			self.__createFinnishDictionary(name + u"unweighted", [], lexicon())
+			self.__createFinnishDictionary(name + u"compact", ["-c"], lexicon())
+			voikkos = [libvoikko.Voikko(u"fi-x-" + name + u"unweighted", self.dataDir.getDirectory()),
+			           libvoikko.Voikko(u"fi-x-" + name + u"compact", self.dataDir.getDirectory()),
+			           self.__createWeightedDictionary(name + u"weighted", lexicon(u"0"))]
+			for word in words:
+				results = [(voikko.spell(word), len(voikko.analyze(word))) for voikko in voikkos]
+				self.assertEqual(results[0], results[1])
+				self.assertEqual(results[0], results[2])
+			for voikko in voikkos:
+				voikko.terminate()
+	
+	def __assertCorruptCompactFileIsRejected(self, variant, corrupt):
+		morFile = self.__createFinnishDictionary(variant, ["-c"])
+		with open(morFile, "rb") as inputFile:
+			data = bytearray(inputFile.read())
+		corrupt(data)
+		with open(morFile, "wb") as outputFile:
+			outputFile.write(data)
+		try:
+			libvoikko.Voikko(u"fi-x-" + variant, self.dataDir.getDirectory())
+			self.fail("Corrupt compact transducer was accepted")
+		except libvoikko.VoikkoException as e:
+			self.assertTrue("Corrupt compact transducer file" in str(e))
+	
+	def testCompactTransducerWithoutStateStartsIsRejected(self):
+		def clearStateStarts(data):
+			position = 26
+			for i in range(data[24] | data[25] << 8):
+				position = data.index(b"\0", position) + 1
+			position = (position + 7) & ~7
+			recordCount = data[16] | data[17] << 8 | data[18] << 16 | data[19] << 24
+			for i in range(recordCount // 8 + 1):
+				data[position + i] = 0
+		self.__assertCorruptCompactFileIsRejected(u"nostates", clearStateStarts)
+	
+	def testCompactTransducerWithTargetsOutsideRecordsIsRejected(self):
+		def moveTargets(data):
+			symbolBytes = data[9]
+			targetBytes = data[10]
+			recordSize = 2 * symbolBytes + targetBytes
+			recordCount = data[16] | data[17] << 8 | data[18] << 16 | data[19] << 24
+			records = len(data) - recordCount * recordSize
+			for record in range(recordCount):
+				target = records + record * recordSize + 2 * symbolBytes
+				for i in range(targetBytes):
+					data[target + i] = 0xFF if i + 1 < targetBytes else 0x7F
+		self.__assertCorruptCompactFileIsRejected(u"badtargets", moveTargets)
+	
+	def testCompactFormatIsNotWrittenForWeightedTransducers(self):
+		# Compact transducers have no weights
+		att = AttBuilder()
+		att.add(0, 1, u"a", u"a", u"0.5")
+		att.addFinal(1, u"0")
+		outputFile = self.dataDir.getDirectory() + os.sep + "spl.vfst"
+		self.assertNotEqual(0, compileVfst(att.lines(), outputFile, ["-c", "-w", "log"]))
+		self.assertEqual(0, compileVfst(att.lines(), outputFile, ["-w", "log"]))
+
+if __name__ == "__main__":
+	unittest.main()
@@ -18,7 +18,10 @@
 # Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 import unittest
+import os
 import re
+import threading
+import tempfile
 from libvoikko import *
 from TestUtils import MorphologyInfo, TestDataDir
 
@@ -127,6 +130,69 @@ class LibvoikkoTest(unittest.TestCase):
 		self.failUnless(self.voikko.spell(u"määrä"))
 		self.failIf(self.voikko.spell(u"määä"))
 	
+	def testSpellBatch(self):
+		self.assertEqual([True, False, True, False, True],
+		                 self.voikko.spellBatch([u"määrä", u"määä", u"Kissa", u"määä", u"määrä"]))
+		self.assertEqual([], self.voikko.spellBatch([]))
+	
+	def testSpellBatchSorted(self):
+		words = [u"kissa", u"kissaa", u"kissoja", u"kissojen", u"kisssa", u"koira", u"koirat"]
+		self.assertEqual([self.voikko.spell(word) for word in words], self.voikko.spellBatch(words))
+
+	def testCheckText(self):
+		text = u"Kissa ja määä, koira ja määä.\0kisssa"
+		self.assertEqual([(9, 4), (24, 4), (30, 6)], self.voikko.checkText(text))
+		self.assertEqual([], self.voikko.checkText(u"Kissa ja koira."))
+		self.assertEqual([], self.voikko.checkText(u""))
+
+	def testAnalyzeBatch(self):
+		words = [u"kissa", u"kissaa", u"kissoja", u"kisssa", u"koira", u"koirat", u"koiratkin"]
+		self.assertEqual([self.voikko.analyze(word) for word in words], self.voikko.analyzeBatch(words))
+		unsorted = [u"koira", u"kissa", u"koira"]
+		self.assertEqual([self.voikko.analyze(word) for word in unsorted], self.voikko.analyzeBatch(unsorted))
+		self.assertEqual([], self.voikko.analyzeBatch([]))
+	
+	def testIncrementalSpeller(self):
+		speller = self.voikko.incrementalSpeller()
+		for c in u"kissat":
+			self.failUnless(speller.append(c))
+		self.failUnless(speller.spell())
+		self.failUnless(speller.canContinue())
+		speller.remove(2)
+		self.assertEqual(self.voikko.spell(u"kiss"), speller.spell())
+		speller.append(u"sa")
+		self.failUnless(speller.spell())
+		speller.remove(10)
+		speller.append(u"koirra")
+		self.failIf(speller.spell())
+		speller.terminate()
+	
+	def testSessionsOfSharedDictionaryWorkConcurrently(self):
+		words = [u"kissa", u"koirra", u"Kissa", u"määä", u"kansaneläkehakemus", u"kuormaauto"]
+		text = u"Kissa ja koira. Kuormaauto on määä!"
+		def results(voikko):
+			return ([voikko.spell(word) for word in words],
+			        [voikko.suggest(word) for word in words],
+			        [(token.tokenText, token.tokenType) for token in voikko.tokens(text)])
+		expected = results(self.voikko)
+		shared = Voikko.initShared(u"fi")
+		sessions = [shared.createSession() for i in range(4)]
+		shared.terminate()
+		actual = [None] * len(sessions)
+		def run(i):
+			for round in range(10):
+				actual[i] = results(sessions[i])
+				if actual[i] != expected:
+					break
+		threads = [threading.Thread(target = run, args = (i,)) for i in range(len(sessions))]
+		for thread in threads:
+			thread.start()
+		for thread in threads:
+			thread.join()
+		for session in sessions:
+			session.terminate()
+		self.assertEqual([expected] * len(sessions), actual)
+	
 	def testSuggest(self):
 		suggs = self.voikko.suggest(u"koirra")
 		self.failUnless(u"koira" in suggs)
@@ -162,6 +228,13 @@ class LibvoikkoTest(unittest.TestCase):
 		analysis = analysisList[0]
 		self.assertEqual(u"=pppppp=ppppp=ppppppp", analysis["STRUCTURE"])
 	
+	def testAnalyzeWithAttributes(self):
+		for word in [u"kansaneläkehakemus", u"kissoja", u"Helsingissä", u"juoksevampi"]:
+			full = self.voikko.analyze(word)
+			for attributes in [["STRUCTURE"], ["BASEFORM"], ["CLASS", "SIJAMUOTO"], ["FSTOUTPUT", "NUMBER"]]:
+				expected = [dict([(key, a[key]) for key in a if key in attributes]) for a in full]
+				self.assertEqual(expected, self.voikko.analyze(word, attributes))
+	
 	def testTokens(self):
 		tokenList = self.voikko.tokens(u"kissa ja koira")
 		self.assertEqual(5, len(tokenList))
@@ -312,6 +385,53 @@ class LibvoikkoTest(unittest.TestCase):
 		self.voikko.setSpellerCacheSize(-1)
 		self.failUnless(self.voikko.spell(u"kissa"))
 	
+	def testSpellerCacheStoresLongAndIncorrectWords(self):
+		self.voikko.setSpellerCacheBytes(100000)
+		self.assertEqual((0, 0), self.voikko.getSpellerCacheStatistics())
+		self.failUnless(self.voikko.spell(u"ryhmäliikuntatuntien"))
+		self.failUnless(self.voikko.spell(u"ryhmäliikuntatuntien"))
+		self.failIf(self.voikko.spell(u"kisssa"))
+		self.failIf(self.voikko.spell(u"kisssa"))
+		self.failIf(self.voikko.spell(u"kissa\U0001F431"))
+		self.failIf(self.voikko.spell(u"kissa\U0001F431"))
+		self.assertEqual((3, 3), self.voikko.getSpellerCacheStatistics())
+	
+	def testSpellerCacheSnapshot(self):
+		fileName = os.path.join(tempfile.mkdtemp(), u"spell.cache")
+		self.voikko.setSpellerCacheBytes(100000)
+		self.failUnless(self.voikko.spell(u"ryhmäliikuntatuntien"))
+		self.failIf(self.voikko.spell(u"kisssa"))
+		self.voikko.saveCacheSnapshot(fileName)
+		restarted = Voikko(u"fi")
+		restarted.setSpellerCacheBytes(100000)
+		self.failUnless(restarted.loadCacheSnapshot(fileName))
+		self.failUnless(restarted.spell(u"ryhmäliikuntatuntien"))
+		self.failIf(restarted.spell(u"kisssa"))
+		self.assertEqual((2, 0), restarted.getSpellerCacheStatistics())
+		restarted.terminate()
+		os.remove(fileName)
+		os.rmdir(os.path.dirname(fileName))
+	
+	def testSpellerCacheSnapshotIsRejectedWithDifferentOptions(self):
+		fileName = os.path.join(tempfile.mkdtemp(), u"spell.cache")
+		self.failIf(self.voikko.spell(u"kisssa"))
+		self.voikko.saveCacheSnapshot(fileName)
+		restarted = Voikko(u"fi")
+		restarted.setAcceptMissingHyphens(True)
+		self.failIf(restarted.loadCacheSnapshot(fileName))
+		restarted.terminate()
+		self.failIf(self.voikko.loadCacheSnapshot(fileName + u".missing"))
+		os.remove(fileName)
+		os.rmdir(os.path.dirname(fileName))
+	
+	def testTransducerResidency(self):
+		self.voikko.setTransducerResidency(TransducerResidency.PREFAULT)
+		self.failUnless(self.voikko.spell(u"kissa"))
+		for fileName, mapped, resident in self.voikko.getTransducerMemoryUsage():
+			self.failUnless(resident <= mapped)
+		self.voikko.setTransducerResidency(0)
+		self.assertRaises(VoikkoException, self.voikko.setTransducerResidency, -1)
+	
 	def testSetSuggestionStrategy(self):
 		self.voikko.setSuggestionStrategy(SuggestionStrategy.OCR)
 		self.failIf(u"koira" in self.voikko.suggest(u"koari"))